@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "backend/track/track.h"
+
+// Compares load time of the same activity as GPX and as FIT - synthetic
+// 10 h, 1 Hz ride with position, elevation, heart rate, cadence, power and
+// temperature, laps every hour - and checks both give the same point fields.
+
+using namespace telemetry;
+
+namespace {
+    constexpr int64_t track_duration_s = 10 * 3600; // 10 h
+    constexpr int64_t lap_duration_s = 3600;
+    constexpr int passes = 3;
+    constexpr int64_t fit_epoch_offset = 631065600; // 1989-12-31T00:00:00Z in unix seconds
+    constexpr double semicircles_per_degree = 2147483648.0 / 180.0;
+
+    const auto start = std::chrono::sys_days(std::chrono::year(2025) / 6 / 1) + std::chrono::hours(8);
+
+    struct sample_t {
+        double lat;
+        double lon;
+        double ele;
+        int hr;
+        int cad;
+        int power;
+        int temp;
+    };
+
+    sample_t sample(int64_t i) {
+        return {46.0 + i * 1e-5, 14.5 + i * 1e-5, 300.0 + (i % 500) * 0.2,
+                static_cast<int>(120 + i % 50), static_cast<int>(80 + i % 20), static_cast<int>(150 + i % 200), 21};
+    }
+
+    // same fields (names, scales) as the decoder maps, a field of a track is compared with tolerance of its text form
+    const std::array<std::pair<const char*, double>, 7> compared_fields = {{
+        {"point_lat", 1e-6}, {"point_lon", 1e-6}, {"point_ele", 1e-9}, {"point_hr", 0.0},
+        {"point_cad", 0.0}, {"point_power", 0.0}, {"point_atemp", 0.0},
+    }};
+}
+
+template<typename F>
+double measure_ms(F&& func) {
+    auto t1 = std::chrono::steady_clock::now();
+    func();
+    auto t2 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t2 - t1).count();
+}
+
+bool write_gpx(const std::string& path) {
+    std::ofstream out(path);
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<gpx creator=\"gst-telemetry benchmark\" version=\"1.1\" xmlns=\"http://www.topografix.com/GPX/1/1\""
+        << " xmlns:gpxtpx=\"http://www.garmin.com/xmlschemas/TrackPointExtension/v1\">\n"
+        << " <trk>\n  <name>benchmark</name>\n  <type>cycling</type>\n  <trkseg>\n";
+
+    char line[512];
+    for (int64_t i = 0; i < track_duration_s; ++i) {
+        auto tp = std::chrono::floor<std::chrono::seconds>(start + std::chrono::seconds(i));
+        auto day = std::chrono::floor<std::chrono::days>(tp);
+        std::chrono::year_month_day ymd(day);
+        std::chrono::hh_mm_ss hms(tp - day);
+        sample_t s = sample(i);
+        std::snprintf(line, sizeof(line),
+            "   <trkpt lat=\"%.7f\" lon=\"%.7f\"><ele>%.1f</ele>"
+            "<time>%04d-%02u-%02uT%02lld:%02lld:%02lld.000Z</time>"
+            "<extensions><power>%d</power><gpxtpx:TrackPointExtension>"
+            "<gpxtpx:atemp>%d</gpxtpx:atemp><gpxtpx:hr>%d</gpxtpx:hr><gpxtpx:cad>%d</gpxtpx:cad>"
+            "</gpxtpx:TrackPointExtension></extensions></trkpt>\n",
+            s.lat, s.lon, s.ele,
+            static_cast<int>(ymd.year()), static_cast<unsigned>(ymd.month()), static_cast<unsigned>(ymd.day()),
+            static_cast<long long>(hms.hours().count()), static_cast<long long>(hms.minutes().count()),
+            static_cast<long long>(hms.seconds().count()),
+            s.power, s.temp, s.hr, s.cad);
+        out << line;
+    }
+    out << "  </trkseg>\n </trk>\n</gpx>\n";
+    return static_cast<bool>(out);
+}
+
+class FitWriter {
+public:
+    void definition(uint8_t local, uint16_t message, std::initializer_list<std::array<uint8_t, 3>> fields) {
+        data_.push_back(0x40 | local);
+        put(0, 1);       // reserved
+        put(0, 1);       // little endian
+        put(message, 2);
+        put(fields.size(), 1);
+        for (const auto& field : fields) {
+            data_.insert(data_.end(), field.begin(), field.end()); // number, size, base type
+        }
+    }
+
+    void message(uint8_t local) {
+        data_.push_back(local);
+    }
+
+    void put(uint64_t value, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            data_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    bool write(const std::string& path) const {
+        std::vector<uint8_t> file = {14, 0x20};
+        auto put_file = [&file](uint64_t value, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                file.push_back(static_cast<uint8_t>(value >> (8 * i)));
+            }
+        };
+        put_file(2132, 2); // profile version
+        put_file(data_.size(), 4);
+        file.insert(file.end(), {'.', 'F', 'I', 'T'});
+        put_file(crc(file), 2);
+        file.insert(file.end(), data_.begin(), data_.end());
+        put_file(crc(file), 2);
+
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+        return static_cast<bool>(out);
+    }
+
+private:
+    static uint16_t crc(const std::vector<uint8_t>& bytes) {
+        static constexpr uint16_t table[16] = {
+            0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+            0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400,
+        };
+        uint16_t crc = 0;
+        for (uint8_t byte : bytes) {
+            uint16_t tmp = table[crc & 0xF];
+            crc = ((crc >> 4) & 0x0FFF) ^ tmp ^ table[byte & 0xF];
+            tmp = table[crc & 0xF];
+            crc = ((crc >> 4) & 0x0FFF) ^ tmp ^ table[(byte >> 4) & 0xF];
+        }
+        return crc;
+    }
+
+    std::vector<uint8_t> data_;
+};
+
+bool write_fit(const std::string& path) {
+    constexpr uint8_t record = 0;
+    constexpr uint8_t lap = 1;
+    constexpr uint8_t session = 2;
+
+    FitWriter fit;
+    // timestamp, lat, lon, altitude, heart rate, cadence, power, temperature
+    fit.definition(record, 20, {{253, 4, 0x86}, {0, 4, 0x85}, {1, 4, 0x85}, {2, 2, 0x84},
+                                {3, 1, 0x02}, {4, 1, 0x02}, {7, 2, 0x84}, {13, 1, 0x01}});
+    // timestamp, start time, total elapsed time, total distance
+    fit.definition(lap, 19, {{253, 4, 0x86}, {2, 4, 0x86}, {7, 4, 0x86}, {9, 4, 0x86}});
+    fit.definition(session, 18, {{5, 1, 0x00}}); // sport
+
+    int64_t start_s = std::chrono::duration_cast<std::chrono::seconds>(start.time_since_epoch()).count() - fit_epoch_offset;
+    for (int64_t i = 0; i < track_duration_s; ++i) {
+        sample_t s = sample(i);
+        fit.message(record);
+        fit.put(static_cast<uint64_t>(start_s + i), 4);
+        fit.put(static_cast<uint32_t>(static_cast<int32_t>(std::lround(s.lat * semicircles_per_degree))), 4);
+        fit.put(static_cast<uint32_t>(static_cast<int32_t>(std::lround(s.lon * semicircles_per_degree))), 4);
+        fit.put(static_cast<uint64_t>(std::lround((s.ele + 500.0) * 5.0)), 2);
+        fit.put(static_cast<uint64_t>(s.hr), 1);
+        fit.put(static_cast<uint64_t>(s.cad), 1);
+        fit.put(static_cast<uint64_t>(s.power), 2);
+        fit.put(static_cast<uint64_t>(s.temp), 1);
+
+        if ((i + 1) % lap_duration_s == 0) {
+            fit.message(lap);
+            fit.put(static_cast<uint64_t>(start_s + i), 4);
+            fit.put(static_cast<uint64_t>(start_s + i + 1 - lap_duration_s), 4);
+            fit.put(static_cast<uint64_t>(lap_duration_s * 1000), 4);
+            fit.put(0, 4);
+        }
+    }
+    fit.message(session);
+    fit.put(2, 1); // cycling
+    return fit.write(path);
+}
+
+bool run(const std::string& label, const std::string& path) {
+    size_t points = 0;
+    bool ok = true;
+    double ms = measure_ms([&]() {
+        for (int pass = 0; pass < passes; ++pass) {
+            track::Track track;
+            ok = (path.ends_with(".fit") ? track.load_fit(path) : track.load_gpx(path, track::Track::Parser::Stream)) && ok;
+            points += track.get_trackpoint_timestamps().size();
+        }
+    });
+    if (!ok) {
+        std::cout << "Error - failed to load " << path << std::endl;
+        return false;
+    }
+
+    std::cout << label << points / passes << " points, " << ms / passes << " ms/load, "
+              << static_cast<uint64_t>(points / (ms / 1000.0)) << " points/s" << std::endl;
+    return true;
+}
+
+bool compare(const std::string& gpx_path, const std::string& fit_path) {
+    track::Track gpx;
+    track::Track fit;
+    if (!gpx.load_gpx(gpx_path, track::Track::Parser::Stream) || !fit.load_fit(fit_path)) {
+        std::cout << "Error - failed to load tracks for comparison" << std::endl;
+        return false;
+    }
+    if (gpx.get_trackpoint_timestamps().size() != fit.get_trackpoint_timestamps().size()) {
+        std::cout << "Error - different trackpoint count" << std::endl;
+        return false;
+    }
+
+    bool ok = true;
+    for (const auto& [name, tolerance] : compared_fields) {
+        double max_difference = 0.0;
+        for (auto timestamp : gpx.get_trackpoint_timestamps()) {
+            track::Value a = gpx.get(name, timestamp);
+            track::Value b = fit.get(name, timestamp);
+            if (!a.is_valid() || !b.is_valid()) {
+                max_difference = INFINITY;
+                break;
+            }
+            max_difference = std::max(max_difference, std::fabs(a.as_double() - b.as_double()));
+        }
+        if (max_difference > tolerance) {
+            std::cout << "Error - " << name << " differs by " << max_difference << std::endl;
+            ok = false;
+        }
+    }
+
+    track::Value laps = fit.get("s_lap_count");
+    if (!laps.is_valid() || laps.as_double() != static_cast<double>(track_duration_s / lap_duration_s)) {
+        std::cout << "Error - unexpected lap count: " << laps.as_string() << std::endl;
+        ok = false;
+    }
+    if (fit.get("meta_type").as_string() != "cycling") {
+        std::cout << "Error - unexpected activity type: " << fit.get("meta_type").as_string() << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+int main() {
+    auto directory = std::filesystem::temp_directory_path();
+    std::string gpx_path = (directory / "gst_telemetry_fit_benchmark.gpx").string();
+    std::string fit_path = (directory / "gst_telemetry_fit_benchmark.fit").string();
+    if (!write_gpx(gpx_path) || !write_fit(fit_path)) {
+        std::cout << "Error - failed to write benchmark tracks" << std::endl;
+        return 1;
+    }
+    std::cout << "gpx: " << std::filesystem::file_size(gpx_path) << " bytes, fit: "
+              << std::filesystem::file_size(fit_path) << " bytes" << std::endl;
+
+    bool ok = run("gpx (stream): ", gpx_path) &&
+              run("fit:          ", fit_path) &&
+              compare(gpx_path, fit_path);
+
+    std::filesystem::remove(gpx_path);
+    std::filesystem::remove(fit_path);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "backend/track/track.h"
+
+// Measures per frame handle queries of all fields of a track from several
+// drawing workers at once (each worker queries every field, as widgets
+// sharing fields do, several times per frame), with and without the per
+// frame query cache.
+
+using namespace telemetry;
+
+namespace {
+    constexpr int64_t track_duration_s = 3600;                          // 1 h, 1 Hz
+    constexpr time::microseconds_t frame_interval = 1'000'000 / 60;     // 60 fps
+    constexpr int frames = 1000;
+    constexpr int widgets_per_field = 16;                              // queries of each field per worker and frame
+}
+
+template<typename F>
+double measure_ms(F&& func) {
+    auto t1 = std::chrono::steady_clock::now();
+    func();
+    auto t2 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t2 - t1).count();
+}
+
+bool write_track(const std::string& path) {
+    std::ofstream out(path);
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<gpx creator=\"gst-telemetry benchmark\" version=\"1.1\" xmlns=\"http://www.topografix.com/GPX/1/1\""
+        << " xmlns:gpxtpx=\"http://www.garmin.com/xmlschemas/TrackPointExtension/v1\">\n"
+        << " <trk>\n  <name>benchmark</name>\n  <type>cycling</type>\n  <trkseg>\n";
+
+    char line[512];
+    for (int64_t i = 0; i < track_duration_s; ++i) {
+        std::snprintf(line, sizeof(line),
+            "   <trkpt lat=\"%.7f\" lon=\"%.7f\"><ele>%.1f</ele>"
+            "<time>2025-06-01T%02lld:%02lld:%02lld.000Z</time>"
+            "<extensions><power>%d</power><gpxtpx:TrackPointExtension>"
+            "<gpxtpx:atemp>21</gpxtpx:atemp><gpxtpx:hr>%d</gpxtpx:hr><gpxtpx:cad>%d</gpxtpx:cad>"
+            "</gpxtpx:TrackPointExtension></extensions></trkpt>\n",
+            46.0 + i * 1e-5, 14.5 + i * 1e-5, 300.0 + (i % 500) * 0.2,
+            static_cast<long long>(8 + i / 3600), static_cast<long long>(i / 60 % 60), static_cast<long long>(i % 60),
+            static_cast<int>(150 + i % 200), static_cast<int>(120 + i % 50), static_cast<int>(80 + i % 20));
+        out << line;
+    }
+    out << "  </trkseg>\n </trk>\n</gpx>\n";
+    return static_cast<bool>(out);
+}
+
+/* ns per query, cache is bypassed unless cached (frame timestamp never matches) */
+double run(track::Track& track, const std::vector<track::FieldHandle>& fields,
+           size_t worker_count, bool cached, double& checksum) {
+    std::vector<double> sums(worker_count, 0.0);
+    std::vector<std::vector<track::TrackCursor>> cursors(worker_count, std::vector<track::TrackCursor>(fields.size()));
+    time::microseconds_t timestamp = 0;
+    std::barrier sync(static_cast<std::ptrdiff_t>(worker_count + 1));
+
+    double ms = measure_ms([&]() {
+        std::vector<std::jthread> workers;
+        for (size_t w = 0; w < worker_count; ++w) {
+            workers.emplace_back([&, w]() {
+                for (int frame = 0; frame < frames; ++frame) {
+                    sync.arrive_and_wait(); // frame started
+                    for (int widget = 0; widget < widgets_per_field; ++widget) {
+                        for (size_t i = 0; i < fields.size(); ++i) {
+                            track::Value value = track.get(fields[i], timestamp, cursors[w][i]);
+                            if (value.is_double()) {
+                                sums[w] += value.as_double();
+                            }
+                        }
+                    }
+                    sync.arrive_and_wait(); // frame drawn
+                }
+            });
+        }
+        for (int frame = 0; frame < frames; ++frame) {
+            timestamp = frame * frame_interval;
+            track.begin_frame(cached ? timestamp : time::INVALID_TIME);
+            sync.arrive_and_wait();
+            sync.arrive_and_wait();
+        }
+    });
+
+    checksum = 0;
+    for (double sum : sums) {
+        checksum += sum;
+    }
+    return ms * 1e6 / (static_cast<double>(frames) * widgets_per_field * worker_count * fields.size());
+}
+
+int main(int argc, char** argv) {
+    // optional argument: real GPX file to load instead of synthetic one
+    std::string path;
+    bool generated = argc < 2;
+    if (generated) {
+        path = (std::filesystem::temp_directory_path() / "gst_telemetry_query_cache_benchmark.gpx").string();
+        if (!write_track(path)) {
+            std::cout << "Error - failed to write " << path << std::endl;
+            return 1;
+        }
+    } else {
+        path = argv[1];
+    }
+
+    track::Track track;
+    bool ok = track.load(path);
+    if (generated) {
+        std::filesystem::remove(path);
+    }
+    if (!ok) {
+        std::cout << "Error - failed to load " << path << std::endl;
+        return 1;
+    }
+
+    std::vector<track::FieldHandle> fields;
+    for (const auto& name : track.get_field_names()) {
+        fields.push_back(track.bind(name));
+    }
+
+    std::cout << "fields: " << fields.size() << ", frames: " << frames << std::endl;
+    size_t max_workers = std::max(2u, std::thread::hardware_concurrency());
+    for (size_t worker_count = 1; worker_count <= max_workers; worker_count *= 2) {
+        double uncached_sum = 0;
+        double cached_sum = 0;
+        double uncached_ns = run(track, fields, worker_count, false, uncached_sum);
+        double cached_ns = run(track, fields, worker_count, true, cached_sum);
+        if (uncached_sum != cached_sum) {
+            std::cout << "Error - cached values differ: " << uncached_sum << " != " << cached_sum << std::endl;
+            return 1;
+        }
+        std::cout << std::format("{:2} workers: uncached {:.1f} ns/query, cached {:.1f} ns/query, speedup {:.2f}x",
+                                 worker_count, uncached_ns, cached_ns, uncached_ns / cached_ns) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+#include "backend/track/trackpoint_store.h"
+
+// Compares trackpoint bracket lookup with plain binary search against
+// TrackCursor assisted lookup for sequential video frame timestamps
+// over a full 10 h, 1 Hz track rendered at 60 fps.
+
+using namespace telemetry;
+
+namespace {
+    constexpr time::microseconds_t track_duration = 10LL * 3600 * 1'000'000; // 10 h
+    constexpr time::microseconds_t trackpoint_interval = 1'000'000;          // 1 Hz
+    constexpr time::microseconds_t frame_interval = 1'000'000 / 60;          // 60 fps
+    constexpr int passes = 5;
+}
+
+template<typename F>
+double measure_ms(F&& func) {
+    auto t1 = std::chrono::steady_clock::now();
+    func();
+    auto t2 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t2 - t1).count();
+}
+
+int main() {
+    track::TrackpointStore store;
+    size_t column = store.add_column(track::TrackpointStore::ColumnType::Double);
+
+    for (time::microseconds_t ts = 0; ts <= track_duration; ts += trackpoint_interval) {
+        store.set(ts, column, static_cast<double>(ts % 7919));
+    }
+    store.build();
+
+    uint64_t frames = 0;
+    double sum_search = 0;
+    double sum_cursor = 0;
+
+    double search_ms = measure_ms([&]() {
+        for (int pass = 0; pass < passes; ++pass) {
+            for (time::microseconds_t ts = 0; ts <= track_duration; ts += frame_interval) {
+                size_t idx = store.floor_index(ts);
+                sum_search += store.value(column, idx);
+                ++frames;
+            }
+        }
+    });
+
+    double cursor_ms = measure_ms([&]() {
+        for (int pass = 0; pass < passes; ++pass) {
+            track::TrackCursor cursor;
+            for (time::microseconds_t ts = 0; ts <= track_duration; ts += frame_interval) {
+                size_t idx = store.floor_index(ts, cursor);
+                sum_cursor += store.value(column, idx);
+            }
+        }
+    });
+
+    if (sum_search != sum_cursor) {
+        std::cout << "Error - lookup results differ: " << sum_search << " != " << sum_cursor << std::endl;
+        return 1;
+    }
+
+    std::cout << "trackpoints:   " << store.size() << std::endl;
+    std::cout << "frames:        " << frames << std::endl;
+    std::cout << "binary search: " << search_ms << " ms (" << search_ms * 1e6 / frames << " ns/lookup)" << std::endl;
+    std::cout << "cursor:        " << cursor_ms << " ms (" << cursor_ms * 1e6 / frames << " ns/lookup)" << std::endl;
+    std::cout << "speedup:       " << search_ms / cursor_ms << "x" << std::endl;
+
+    return 0;
+}
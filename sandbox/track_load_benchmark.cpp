@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "backend/track/track.h"
+
+// Measures GPX load throughput of both track parsers (stream parser also
+// with parallel trackpoint parsing) over a synthetic 10 h, 1 Hz track with
+// the usual Garmin trackpoint extensions.
+
+using namespace telemetry;
+
+namespace {
+    constexpr int64_t track_duration_s = 10 * 3600; // 10 h
+    constexpr int passes = 3;
+}
+
+template<typename F>
+double measure_ms(F&& func) {
+    auto t1 = std::chrono::steady_clock::now();
+    func();
+    auto t2 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t2 - t1).count();
+}
+
+bool write_track(const std::string& path) {
+    std::ofstream out(path);
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<gpx creator=\"gst-telemetry benchmark\" version=\"1.1\" xmlns=\"http://www.topografix.com/GPX/1/1\""
+        << " xmlns:gpxtpx=\"http://www.garmin.com/xmlschemas/TrackPointExtension/v1\">\n"
+        << " <trk>\n  <name>benchmark</name>\n  <type>cycling</type>\n  <trkseg>\n";
+
+    const auto start = std::chrono::sys_days(std::chrono::year(2025) / 6 / 1) + std::chrono::hours(8);
+    char line[512];
+    for (int64_t i = 0; i < track_duration_s; ++i) {
+        auto tp = std::chrono::floor<std::chrono::seconds>(start + std::chrono::seconds(i));
+        auto day = std::chrono::floor<std::chrono::days>(tp);
+        std::chrono::year_month_day ymd(day);
+        std::chrono::hh_mm_ss hms(tp - day);
+        std::snprintf(line, sizeof(line),
+            "   <trkpt lat=\"%.7f\" lon=\"%.7f\"><ele>%.1f</ele>"
+            "<time>%04d-%02u-%02uT%02lld:%02lld:%02lld.000Z</time>"
+            "<extensions><power>%d</power><gpxtpx:TrackPointExtension>"
+            "<gpxtpx:atemp>21</gpxtpx:atemp><gpxtpx:hr>%d</gpxtpx:hr><gpxtpx:cad>%d</gpxtpx:cad>"
+            "</gpxtpx:TrackPointExtension></extensions></trkpt>\n",
+            46.0 + i * 1e-5, 14.5 + i * 1e-5, 300.0 + (i % 500) * 0.2,
+            static_cast<int>(ymd.year()), static_cast<unsigned>(ymd.month()), static_cast<unsigned>(ymd.day()),
+            static_cast<long long>(hms.hours().count()), static_cast<long long>(hms.minutes().count()),
+            static_cast<long long>(hms.seconds().count()),
+            static_cast<int>(150 + i % 200), static_cast<int>(120 + i % 50), static_cast<int>(80 + i % 20));
+        out << line;
+    }
+    out << "  </trkseg>\n </trk>\n</gpx>\n";
+    return static_cast<bool>(out);
+}
+
+bool run(const std::string& label, const std::string& path, track::Track::Parser parser, size_t worker_count = 1) {
+    size_t points = 0;
+    bool ok = true;
+    double ms = measure_ms([&]() {
+        for (int pass = 0; pass < passes; ++pass) {
+            track::Track track;
+            ok = track.load_gpx(path, parser, worker_count) && ok;
+            points += track.get_trackpoint_timestamps().size();
+        }
+    });
+    if (!ok) {
+        std::cout << "Error - failed to load " << path << std::endl;
+        return false;
+    }
+
+    std::cout << label << points / passes << " points, " << ms / passes << " ms/load, "
+              << static_cast<uint64_t>(points / (ms / 1000.0)) << " points/s" << std::endl;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    // optional argument: real GPX file to load instead of synthetic one
+    std::string path;
+    bool generated = argc < 2;
+    if (generated) {
+        path = (std::filesystem::temp_directory_path() / "gst_telemetry_load_benchmark.gpx").string();
+        if (!write_track(path)) {
+            std::cout << "Error - failed to write " << path << std::endl;
+            return 1;
+        }
+    } else {
+        path = argv[1];
+    }
+
+    size_t worker_count = std::max(2u, std::thread::hardware_concurrency());
+    bool ok = run("dom:    ", path, track::Track::Parser::Dom) &&
+              run("stream: ", path, track::Track::Parser::Stream) &&
+              run(std::format("stream ({} workers): ", worker_count), path, track::Track::Parser::Stream, worker_count);
+
+    if (generated) {
+        std::filesystem::remove(path);
+    }
+    return ok ? 0 : 1;
+}
@@ -18,6 +18,7 @@ int manager_deinit(ManagerHandle* handle);
 
 int manager_get_overlay_dimensions(ManagerHandle* handle, size_t* width, size_t* height, size_t* stride);
 int manager_get_overlay_format(ManagerHandle* handle, cairo_format_t* format);
+int manager_set_frame_rate(ManagerHandle* handle, int fps_n, int fps_d);
 
 int manager_draw(ManagerHandle* handle, int64_t timestamp, cairo_surface_t* surface);
 
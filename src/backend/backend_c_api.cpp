@@ -31,6 +31,11 @@ int manager_get_overlay_format(ManagerHandle* handle, cairo_format_t* format) {
     return ok ? 0 : -1;
 }
 
+int manager_set_frame_rate(ManagerHandle* handle, int fps_n, int fps_d) {
+    bool ok = reinterpret_cast<telemetry::Manager*>(handle)->set_frame_rate(fps_n, fps_d);
+    return ok ? 0 : -1;
+}
+
 int manager_draw(ManagerHandle* handle, int64_t timestamp, cairo_surface_t* surface) {
     bool ok =reinterpret_cast<telemetry::Manager*>(handle)->draw(timestamp, surface);
     return ok ? 0 : -1;
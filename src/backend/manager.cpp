@@ -1,6 +1,9 @@
 #include "manager.h"
 
+#include <charconv>
+#include <filesystem>
 #include <iostream>
+#include <string_view>
 
 #include "backend/utils/time.h"
 #include "trace/trace.h"
@@ -10,6 +13,12 @@
 namespace telemetry {
 namespace consts {
     constexpr int default_worker_count = 4;
+    constexpr char source_separator = ';';
+    constexpr char option_separator = ',';
+    constexpr std::string_view offset_option = "offset=";
+    constexpr std::string_view prefix_option = "prefix=";
+    constexpr std::string_view rider_option = "rider";
+    constexpr std::string_view live_option = "live";
 }
 
 struct SurfaceWrapper {
@@ -80,8 +89,24 @@ bool Manager::init(float offset, const char* track_path, const char* custom_data
     log.info("Track path: {}", track_path);
     log.info("Layout path: {}", layout_path);
 
+    if (worker_count <= 0) {
+        log.info("Worker count not configured or incorrect, using auto configuration");
+        worker_count = std::thread::hardware_concurrency() * 3 / 4;
+        if (worker_count <= 0) {
+            log.info("Failed to detect hardware concurrency, using default worker count");
+            worker_count = consts::default_worker_count;
+        }
+    }
+
+    std::vector<track::Track::source_t> sources;
+    if (!parse_track_sources(track_path, sources)) {
+        log.error("Invalid track sources: {}", track_path);
+        TRACE_EVENT_END(EV_MANAGER_INIT);
+        return false;
+    }
+
     track_ = std::make_shared<track::Track>(offset_us);
-    ok = track_->load(track_path);
+    ok = track_->load(sources, static_cast<size_t>(worker_count));
     if (!ok) {
         log.error("Failed to load track from path: {}", track_path);
         TRACE_EVENT_END(EV_MANAGER_INIT);
@@ -108,15 +133,6 @@ bool Manager::init(float offset, const char* track_path, const char* custom_data
     }
     log.info("Layout loaded successfully");
 
-    if (worker_count <= 0) {
-        log.info("Worker count not configured or incorrect, using auto configuration");
-        worker_count = std::thread::hardware_concurrency() * 3 / 4;
-        if (worker_count <= 0) {
-            log.info("Failed to detect hardware concurrency, using default worker count");
-            worker_count = consts::default_worker_count;
-        }
-    }
-
     log.info("Starting {} worker threads for drawing", worker_count);
     for (int i = 0; i < worker_count; ++i) {
         workers.emplace_back([this, i]() {
@@ -134,6 +150,65 @@ bool Manager::init(float offset, const char* track_path, const char* custom_data
     return true;
 }
 
+bool Manager::parse_track_sources(const std::string& spec, std::vector<track::Track::source_t>& sources) const {
+    // existing file whose name contains separators is taken as is, not split into sources/options
+    std::error_code ec;
+    if (spec.find_first_of({consts::source_separator, consts::option_separator}) != std::string::npos &&
+        std::filesystem::is_regular_file(spec, ec)) {
+        track::Track::source_t source;
+        source.path = spec;
+        sources.push_back(std::move(source));
+        return true;
+    }
+
+    std::string_view rest = spec;
+    while (!rest.empty()) {
+        size_t end = rest.find(consts::source_separator);
+        std::string_view source_spec = rest.substr(0, end);
+        rest = (end == std::string_view::npos) ? std::string_view() : rest.substr(end + 1);
+
+        size_t pos = source_spec.find(consts::option_separator);
+        track::Track::source_t source;
+        source.path = source_spec.substr(0, pos);
+        if (source.path.empty()) {
+            log.error("Empty path of track source");
+            return false;
+        }
+
+        while (pos != std::string_view::npos) {
+            source_spec = source_spec.substr(pos + 1);
+            pos = source_spec.find(consts::option_separator);
+            std::string_view option = source_spec.substr(0, pos);
+
+            if (option.starts_with(consts::offset_option)) {
+                std::string_view value = option.substr(consts::offset_option.size());
+                time::seconds_t seconds = 0.0;
+                auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), seconds);
+                if (ec != std::errc() || ptr != value.data() + value.size()) {
+                    log.error("Invalid offset of track source {}: {}", source.path, value);
+                    return false;
+                }
+                source.offset = time::s_to_us(seconds);
+            } else if (option.starts_with(consts::prefix_option)) {
+                source.prefix = option.substr(consts::prefix_option.size());
+            } else if (option == consts::live_option) {
+                source.live = true;
+            } else if (option == consts::rider_option) {
+                source.rider = true;
+            } else if (option.starts_with(consts::rider_option) && option[consts::rider_option.size()] == '=') {
+                source.rider = true;
+                source.name = option.substr(consts::rider_option.size() + 1);
+            } else {
+                log.error("Unknown option of track source {}: {}", source.path, option);
+                return false;
+            }
+        }
+
+        sources.push_back(std::move(source));
+    }
+    return !sources.empty();
+}
+
 bool Manager::deinit() {
     TRACE_EVENT_BEGIN(EV_MANAGER_DEINIT);
 
@@ -148,6 +223,12 @@ bool Manager::deinit() {
     workers.clear();
     log.info("All worker threads stopped");
 
+    if (track_) {
+        auto stats = track_->get_query_cache_stats();
+        log.info("Track query cache hits: {}, misses: {}", stats.hits, stats.misses);
+        log.info("Baked interpolated fields: {} bytes", track_->get_baked_memory_usage());
+    }
+
     log.info("Manager deinitialized");
     TRACE_EVENT_END(EV_MANAGER_DEINIT);
     return true;
@@ -169,6 +250,19 @@ bool Manager::get_overlay_format(cairo_format_t* format) const {
     return true;
 }
 
+bool Manager::set_frame_rate(int fps_n, int fps_d) {
+    if (track_ == nullptr) {
+        log.error("set_frame_rate: track not loaded");
+        return false;
+    }
+    if (fps_n < 0 || fps_d < 0) {
+        log.error("set_frame_rate: invalid frame rate {}/{}", fps_n, fps_d);
+        return false;
+    }
+    track_->set_frame_rate(static_cast<uint32_t>(fps_n), static_cast<uint32_t>(fps_d));
+    return true;
+}
+
 bool Manager::draw(time::microseconds_t timestamp, cairo_surface_t* surface) {
     TRACE_EVENT_BEGIN(EV_MANAGER_DRAW);
 
@@ -190,6 +284,7 @@ bool Manager::draw(time::microseconds_t timestamp, cairo_surface_t* surface) {
     };
 
     log.debug("Drawing overlay at time {} us", timestamp);
+    track_->begin_frame(timestamp);
     layout_->draw(timestamp, schedule_drawing);
 
     cairo_t *cr = cairo_create(surface);
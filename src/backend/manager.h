@@ -26,10 +26,15 @@ public:
 
     bool get_overlay_dimensions(size_t* width, size_t* height, size_t* stride) const;
     bool get_overlay_format(cairo_format_t* format) const;
+    /* negotiated video frame rate, 0/1 if variable */
+    bool set_frame_rate(int fps_n, int fps_d);
 
     bool draw(time::microseconds_t timestamp, cairo_surface_t* surface);
 
 private:
+    /* "PATH[,offset=SECONDS][,prefix=PREFIX][,rider[=NAME]][,live]" sources separated by ';' */
+    bool parse_track_sources(const std::string& spec, std::vector<track::Track::source_t>& sources) const;
+
     mutable utils::logging::Logger log{"manager"};
 
     std::shared_ptr<track::Track> track_;
@@ -1,7 +1,9 @@
 #include "chart_widget.h"
 #include "backend/utils/color.h"
 #include "trace/trace.h"
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <iostream>
 
 extern "C" {
@@ -321,8 +323,20 @@ void ChartWidget::draw_impl(Surface& surface, time::microseconds_t timestamp, do
             x_values = x_value_->get_values(timestamps);
             y_values = y_value_->get_values(timestamps);
         } else {
-            x_values = x_value_->get_values(value_step);
-            y_values = y_value_->get_values(value_step);
+            std::vector<time::microseconds_t> envelope = {};
+            if (value_step == time::INVALID_TIME) {
+                envelope = get_envelope_timestamps(width);
+            }
+
+            if (!envelope.empty()) {
+                // long track - only samples outlining each pixel column are drawn
+                std::vector<std::vector<time::microseconds_t>> timestamps = {envelope};
+                x_values = x_value_->get_values(timestamps);
+                y_values = y_value_->get_values(timestamps);
+            } else {
+                x_values = x_value_->get_values(value_step);
+                y_values = y_value_->get_values(value_step);
+            }
         }
 
         lock_x_minmax_ = false;
@@ -343,8 +357,8 @@ void ChartWidget::draw_impl(Surface& surface, time::microseconds_t timestamp, do
             }
         }
 
-        recalculate_extremes(filter_zoom_x ? x_values : x_value_->get_values(),
-                                filter_zoom_y ? y_values : y_value_->get_values());
+        recalculate_extremes(filter_zoom_x ? x_values : nullptr,
+                             filter_zoom_y ? y_values : nullptr);
 
         if (invalid_) {
             log.error("ChartWidget is in invalid state, aborting drawing");
@@ -671,6 +685,26 @@ void ChartWidget::redraw_point_cache(double width, double height,
     cairo_destroy(cache_cr);
 }
 
+std::vector<time::microseconds_t> ChartWidget::get_envelope_timestamps(double width) {
+    size_t buckets = static_cast<size_t>(std::max(std::ceil(width), 1.0));
+    auto x_envelope = x_value_->get_envelope_timestamps(buckets);
+    if (x_envelope.empty()) {
+        return {};
+    }
+    auto y_envelope = y_value_->get_envelope_timestamps(buckets);
+    if (y_envelope.empty()) {
+        return {};
+    }
+
+    // extent of both x and y values has to be kept
+    std::vector<time::microseconds_t> envelope;
+    envelope.reserve(x_envelope.size() + y_envelope.size());
+    std::set_union(x_envelope.begin(), x_envelope.end(), y_envelope.begin(), y_envelope.end(),
+                   std::back_inserter(envelope));
+    envelope.erase(std::unique(envelope.begin(), envelope.end()), envelope.end());
+    return envelope;
+}
+
 void ChartWidget::recalculate_extremes(std::shared_ptr<NumericParameter::sections_t> x_values,
                                        std::shared_ptr<NumericParameter::sections_t> y_values) {
     invalid_ = false;// reset invalid state
@@ -679,28 +713,44 @@ void ChartWidget::recalculate_extremes(std::shared_ptr<NumericParameter::section
         return;
     }
 
-    if (!x_values || x_values->empty() || !y_values || y_values->empty()) {
-        log.error("Extremes recalculation failure - no x or y values available");
-        invalid_ = true;
-        return;
-    }
+    // without given values extremes are of all track values - from min/max pyramid if available
+    auto calculate = [](std::shared_ptr<NumericParameter> parameter,
+                       std::shared_ptr<NumericParameter::sections_t> values,
+                       double& min, double& max) -> bool {
+        if (!values && parameter->get_extremes(min, max)) {
+            return true;
+        }
+        if (!values) {
+            values = parameter->get_values();
+        }
+        if (!values || values->empty()) {
+            return false;
+        }
 
-    if (!lock_x_minmax_) {  
-        min_x_ = std::numeric_limits<double>::max();
-        max_x_ = std::numeric_limits<double>::min();
-        for (const auto& section: *x_values) {
-            for (const auto& [ts, x_val] : section) {
-                if (std::isnan(x_val)) {
+        min = std::numeric_limits<double>::max();
+        max = std::numeric_limits<double>::min();
+        for (const auto& section: *values) {
+            for (const auto& [ts, value] : section) {
+                if (std::isnan(value)) {
                     continue; // skip NaN values
                 }
-                if (x_val < min_x_) {
-                    min_x_ = x_val;
+                if (value < min) {
+                    min = value;
                 }
-                if (x_val > max_x_) {
-                    max_x_ = x_val;
+                if (value > max) {
+                    max = value;
                 }
             }
         }
+        return true;
+    };
+
+    if (!lock_x_minmax_) {
+        if (!calculate(x_value_, x_values, min_x_, max_x_)) {
+            log.error("Extremes recalculation failure - no x values available");
+            invalid_ = true;
+            return;
+        }
         if (min_x_ >= max_x_) {
             log.error("Extremes recalculation failure - min_x ({}) >= max_x ({})", min_x_, max_x_);
             invalid_ = true;
@@ -708,21 +758,10 @@ void ChartWidget::recalculate_extremes(std::shared_ptr<NumericParameter::section
     }
 
     if (!lock_y_minmax_) {
-        min_y_ = std::numeric_limits<double>::max();
-        max_y_ = std::numeric_limits<double>::min();
-        for (const auto& section: *y_values) {
-            for (const auto& [ts, y_val] : section) {
-                if (std::isnan(y_val)) {
-                    continue; // skip NaN values
-                }
-
-                if (y_val < min_y_) {
-                    min_y_ = y_val;
-                }
-                if (y_val > max_y_) {
-                    max_y_ = y_val;
-                }
-            }
+        if (!calculate(y_value_, y_values, min_y_, max_y_)) {
+            log.error("Extremes recalculation failure - no y values available");
+            invalid_ = true;
+            return;
         }
         if (min_y_ >= max_y_) {
             log.error("Extremes recalculation failure - min_y ({}) >= max_y ({})", min_y_, max_y_);
@@ -69,6 +69,9 @@ private:
                         rgb point_border_color, double point_border_width,
                         double x_value, double y_value);
 
+    /* timestamps outlining x and y values at chart resolution, empty if not available or not needed */
+    std::vector<time::microseconds_t> get_envelope_timestamps(double width);
+    /* null values - extremes of all track values */
     void recalculate_extremes(std::shared_ptr<NumericParameter::sections_t> x_values,
                               std::shared_ptr<NumericParameter::sections_t> y_values);
     std::pair<double, double> translate(double x_value, double y_value, double width, double height) const;
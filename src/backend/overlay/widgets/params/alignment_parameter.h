@@ -32,7 +32,8 @@ private:
 
     //used by TrackKey update strategy
     std::shared_ptr<track::Track> track_ = nullptr;
-    track::field_id_t field_id = track::INVALID_FIELD;
+    track::FieldHandle field;
+    track::TrackCursor cursor_;
 };
 
 } // namespace telemetry
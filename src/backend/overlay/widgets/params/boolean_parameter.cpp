@@ -98,7 +98,7 @@ BooleanParameter::BooleanParameter(const std::string& key, std::shared_ptr<track
         : update_strategy_(if_exists ? UpdateStrategy::TrackKeyExistance : UpdateStrategy::TrackKey),
           negate_(negate),
           track_(track),
-          field_id(track->get_field_id(key)) {
+          field(track->bind(key)) {
 }
 
 BooleanParameter::BooleanParameter(bool static_value)
@@ -113,7 +113,10 @@ bool BooleanParameter::update(time::microseconds_t timestamp) {
             return false; // static value does not change
         case UpdateStrategy::TrackKey:
             if (track_) {
-                track::Value v = track_->get(field_id, timestamp);
+                if (valid_ && validity_.contains(timestamp)) {
+                    return false;
+                }
+                track::Value v = track_->get(field, timestamp, cursor_, validity_);
                 
                 bool new_value = false;
                 if (!v.is_valid()) {
@@ -144,11 +147,15 @@ bool BooleanParameter::update(time::microseconds_t timestamp) {
             return false;
         case UpdateStrategy::TrackKeyExistance:
             if (track_) {
+                if (valid_ && validity_.contains(timestamp)) {
+                    return false;
+                }
                 bool new_value = value_;
-                if (field_id == track::INVALID_FIELD) {
+                if (!field.is_valid()) {
                     new_value = false;
+                    validity_ = {timestamp, track::VALID_FOREVER};
                 } else {
-                    track::Value v = track_->get(field_id, timestamp);
+                    track::Value v = track_->get(field, timestamp, cursor_, validity_);
                     new_value = v.is_valid();
                 }
 
@@ -36,7 +36,9 @@ private:
 
     // used by TrackKey and TrackKeyExistance update strategy
     std::shared_ptr<track::Track> track_ = nullptr;
-    track::field_id_t field_id = track::INVALID_FIELD;
+    track::FieldHandle field;
+    track::TrackCursor cursor_;
+    track::validity_t validity_; // value_ is up to date within
 
     // used by SubParameter update strategy
     std::shared_ptr<NumericParameter> sub_param_ = nullptr;
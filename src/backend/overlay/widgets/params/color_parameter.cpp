@@ -77,7 +77,7 @@ ColorParameter::ColorParameter(std::shared_ptr<NumericParameter> r_param,
 ColorParameter::ColorParameter(const std::string& key, std::shared_ptr<track::Track> track)
         : update_strategy_(UpdateStrategy::TrackKey),
           track_(track) {
-    field_id = track_->get_field_id(key);
+    field = track_->bind(key);
 }
 
 ColorParameter::ColorParameter(rgb static_value)
@@ -93,7 +93,7 @@ bool ColorParameter::update(time::microseconds_t timestamp) {
             return false; // static value does not change
         case UpdateStrategy::TrackKey:
             if (track_) {
-                track::Value v = track_->get(field_id, timestamp);
+                track::Value v = track_->get(field, timestamp, cursor_);
                 rgb new_value = color_from_string(v.as_string());
                 if (new_value != value_) {
                     value_ = new_value;
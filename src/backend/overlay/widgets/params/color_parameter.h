@@ -38,7 +38,8 @@ private:
 
     // used by TrackKey update strategy
     std::shared_ptr<track::Track> track_ = nullptr;
-    track::field_id_t field_id = track::INVALID_FIELD;
+    track::FieldHandle field;
+    track::TrackCursor cursor_;
 
     // used by SubParameter update strategy
     std::shared_ptr<NumericParameter> r_param_ = nullptr;
@@ -1,29 +1,81 @@
 #include "expression.h"
 
+#include <algorithm>
+#include <array>
+#include <regex>
+#include <utility>
+
 namespace telemetry {
 namespace overlay {
+namespace consts {
+    // exprtk reserves avg/min/max/sum for its own variadic functions
+    const std::array<std::pair<std::string, track::WindowIndex::Aggregate>, 4> window_functions = {{
+        {"wavg", track::WindowIndex::Aggregate::Avg},
+        {"wmin", track::WindowIndex::Aggregate::Min},
+        {"wmax", track::WindowIndex::Aggregate::Max},
+        {"wsum", track::WindowIndex::Aggregate::Sum},
+    }};
+
+    // field names given as string literals, e.g. wavg('point_power', 3)
+    const std::regex window_call(R"(\b(wavg|wmin|wmax|wsum)\s*\(\s*'([^']*)')");
+}
+
+/* aggregate of field samples over last N seconds: wavg('point_power', 3) */
+class Expression::WindowFunction : public exprtk::igeneric_function<double> {
+public:
+    WindowFunction(Expression& expression, track::WindowIndex::Aggregate aggregate)
+            : exprtk::igeneric_function<double>("ST"),
+              expression_(expression),
+              aggregate_(aggregate) {
+    }
+
+    double operator()(parameter_list_t parameters) override {
+        generic_type::string_view name(parameters[0]);
+        generic_type::scalar_view seconds(parameters[1]);
+        return expression_.get_window_aggregate(aggregate_, std::string_view(name.begin(), name.size()), seconds());
+    }
+
+private:
+    Expression& expression_;
+    track::WindowIndex::Aggregate aggregate_;
+};
 
 Expression::Expression(const std::string& expression_str,
                        std::shared_ptr<track::Track> track)
             : track_(track) {
+    exprtk::symbol_table<double> symbol_table;
+
+    for (const auto& [name, aggregate] : consts::window_functions) {
+        window_functions_.push_back(std::make_unique<WindowFunction>(*this, aggregate));
+        symbol_table.add_function(name, *window_functions_.back());
+    }
+
+    // window indexes are built now, not while drawing the first frame
+    for (std::sregex_iterator it(expression_str.begin(), expression_str.end(), consts::window_call), end;
+         it != end; ++it) {
+        if (!add_window_field((*it)[2].str())) {
+            valid_expr_ = false;
+            return;
+        }
+    }
+
     std::vector<std::string> variable_list;
-    if (!exprtk::collect_variables(expression_str, variable_list)) {
+    if (!exprtk::collect_variables(expression_str, symbol_table, variable_list)) {
         log.error("Failed to collect variables from expression: {}", expression_str);
         valid_expr_ = false;
         return;
     }
 
-    exprtk::symbol_table<double> symbol_table;
-
+    variables_.reserve(variable_list.size());
     for (const auto& var_name : variable_list) {
-        track::field_id_t field_id = track_->get_field_id(var_name);
-        if (field_id == track::INVALID_FIELD) {
+        track::FieldHandle field = track_->bind(var_name);
+        if (!field.is_valid()) {
             log.warning("Variable '{}' not found in track fields.", var_name);
             valid_expr_ = false;
             return;
         }
-        variables_[field_id] = 0.0;
-        symbol_table.add_variable(var_name, variables_[field_id]);
+        variables_.push_back({field, 0.0});
+        symbol_table.add_variable(var_name, variables_.back().value);
     }
 
     expression_.register_symbol_table(symbol_table);
@@ -43,6 +95,8 @@ Expression::Expression(const std::string& expression_str,
     }
 }
 
+Expression::~Expression() = default;
+
 double Expression::evaluate(time::microseconds_t timestamp) {
     log.debug("Evaluating expression at timestamp {}", timestamp);
 
@@ -51,11 +105,21 @@ double Expression::evaluate(time::microseconds_t timestamp) {
         return 0.0;
     }
 
-    bool needs_evaluation = std::isnan(value_); // needs evaluation if never evaluated
+    if (validity_.contains(timestamp)) {
+        log.debug("Expression value {} valid until {}", result_, validity_.until);
+        return result_;
+    }
+    validity_ = {timestamp, track::VALID_FOREVER};
+    timestamp_ = timestamp;
+
+    // needs evaluation if never evaluated, window aggregates may change with any timestamp
+    bool needs_evaluation = std::isnan(value_) || !window_fields_.empty();
 
     bool invalid = false;
-    for (auto& [field_id, var_ref] : variables_) {
-        double new_value = track_->get(field_id, timestamp).as_double();
+    for (auto& [field, var_ref] : variables_) {
+        track::validity_t variable_validity;
+        double new_value = track_->get(field, timestamp, cursor_, variable_validity).as_double();
+        validity_.until = std::min(validity_.until, variable_validity.until);
         if (var_ref != new_value) {
             var_ref = new_value;
             needs_evaluation = true;
@@ -66,7 +130,8 @@ double Expression::evaluate(time::microseconds_t timestamp) {
     }
     if (invalid) {
         log.warning("One or more variables are NaN at timestamp {}, expression evaluation skipped.", timestamp);
-        return 0.0;
+        result_ = 0.0;
+        return result_;
     }
 
     if (needs_evaluation) {
@@ -76,12 +141,47 @@ double Expression::evaluate(time::microseconds_t timestamp) {
         log.debug("Using cached expression value {}", value_);
     }
 
-    return value_;
+    result_ = value_;
+    return result_;
 }
 
 bool Expression::is_valid() const {
     return valid_expr_;
 }
 
+bool Expression::add_window_field(const std::string& name) {
+    for (const auto& window_field : window_fields_) {
+        if (window_field.name == name) {
+            return true;
+        }
+    }
+
+    const track::WindowIndex* index = track_->get_window_index(track_->bind(name));
+    if (!index) {
+        log.warning("Field '{}' can not be aggregated over time window.", name);
+        return false;
+    }
+    window_fields_.push_back({name, index, {}});
+    return true;
+}
+
+/* called by window functions while expression is evaluated at timestamp_ */
+double Expression::get_window_aggregate(track::WindowIndex::Aggregate aggregate, std::string_view name, double seconds) {
+    auto it = std::find_if(window_fields_.begin(), window_fields_.end(),
+                           [name](const window_field_t& window_field) { return window_field.name == name; });
+    if (it == window_fields_.end()) {
+        // field name not given as literal in the expression string
+        if (!add_window_field(std::string(name))) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        it = window_fields_.end() - 1;
+    }
+
+    time::microseconds_t valid_until = track::VALID_FOREVER;
+    double value = it->index->get(aggregate, timestamp_, time::s_to_us(seconds), it->cursors, valid_until);
+    validity_.until = std::min(validity_.until, valid_until);
+    return value;
+}
+
 } // namespace overlay
 } // namespace telemetry
@@ -4,7 +4,9 @@
 #include "backend/track/track.h"
 #include "backend/utils/time.h"
 #include <string>
+#include <string_view>
 #include <memory>
+#include <vector>
 #include <exprtk.hpp>
 
 namespace telemetry {
@@ -13,21 +15,46 @@ namespace overlay {
 class Expression {
 public:
     Expression(const std::string& expression_str, std::shared_ptr<track::Track> track);
-    ~Expression() = default;
+    ~Expression();
 
     double evaluate(time::microseconds_t timestamp);
 
     bool is_valid() const;
 
 private:
+    // wavg/wmin/wmax/wsum('field', seconds) exprtk functions
+    class WindowFunction;
+
+    struct variable_t {
+        track::FieldHandle field;
+        double value;
+    };
+
+    struct window_field_t {
+        std::string name;
+        const track::WindowIndex* index;
+        track::WindowIndex::cursors_t cursors;
+    };
+
+    bool add_window_field(const std::string& name);
+    double get_window_aggregate(track::WindowIndex::Aggregate aggregate, std::string_view name, double seconds);
+
     mutable utils::logging::Logger log{"Expression"};
 
     bool valid_expr_ = false;
     double value_ = std::numeric_limits<double>::quiet_NaN();
+    double result_ = 0.0;         // last returned value
+    track::validity_t validity_;  // result_ is up to date within, intersection of variable and window validities
+
+    // referenced by expression_ symbol table
+    std::vector<std::unique_ptr<WindowFunction>> window_functions_;
+    std::vector<window_field_t> window_fields_;
+    time::microseconds_t timestamp_ = 0; // being evaluated, read by window functions
 
     exprtk::expression<double> expression_;
-    std::map<track::field_id_t, double> variables_;
+    std::vector<variable_t> variables_; // reserved up front, symbol table references values
     std::shared_ptr<track::Track> track_;
+    track::TrackCursor cursor_;
 
 };
 
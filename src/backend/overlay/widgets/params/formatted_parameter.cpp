@@ -45,7 +45,7 @@ FormattedParameter::FormattedParameter(std::shared_ptr<Expression> expression)
 FormattedParameter::FormattedParameter(const std::string& key, std::shared_ptr<track::Track> track)
         : update_strategy_(UpdateStrategy::TrackKey),
           track_(track),
-          field_id(track->get_field_id(key)) {
+          field(track->bind(key)) {
 }
 
 FormattedParameter::FormattedParameter(const std::string& static_value)
@@ -81,7 +81,7 @@ bool FormattedParameter::update(time::microseconds_t timestamp) {
             return false;
         case UpdateStrategy::TrackKey:
             if (track_) {
-                track::Value v = track_->get(field_id, timestamp);
+                track::Value v = track_->get(field, timestamp, cursor_);
                 std::string new_value = "";
 
                 if (format_) {
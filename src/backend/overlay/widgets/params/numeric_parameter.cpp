@@ -51,7 +51,7 @@ NumericParameter::NumericParameter(std::shared_ptr<Expression> expression, std::
 NumericParameter::NumericParameter(const std::string& key, std::shared_ptr<track::Track> track)
         : update_strategy_(UpdateStrategy::TrackKey),
           track_(track),
-          field_id(track->get_field_id(key)) {
+          field(track->bind(key)) {
 }
 
 NumericParameter::NumericParameter(double static_value)
@@ -74,7 +74,10 @@ bool NumericParameter::update(time::microseconds_t timestamp) {
             return false;
         case UpdateStrategy::TrackKey:
             if (track_) {
-                track::Value v = track_->get(field_id, timestamp);
+                if (validity_.contains(timestamp)) {
+                    return false;
+                }
+                track::Value v = track_->get(field, timestamp, cursor_, validity_);
                 double new_value = v.as_double();
                 if (new_value != value_) {
                     value_ = new_value;
@@ -134,6 +137,7 @@ std::shared_ptr<NumericParameter::sections_t> NumericParameter::get_values(
         }
     }
     value_ = std::numeric_limits<double>::quiet_NaN(); // reset to NaN after values retrieval
+    validity_ = {};
     return sections;
 }
 
@@ -153,6 +157,7 @@ std::shared_ptr<NumericParameter::sections_t> NumericParameter::get_values(
     }
 
     value_ = std::numeric_limits<double>::quiet_NaN(); // reset to NaN after values retrieval
+    validity_ = {};
     return sections;
 }
 
@@ -164,9 +169,45 @@ std::shared_ptr<NumericParameter::value_map_t> NumericParameter::get_all_values(
         (*values)[ts] = value_;
     }
     value_ = std::numeric_limits<double>::quiet_NaN(); // reset to NaN after values retrieval
+    validity_ = {};
     return values;
 }
 
+std::vector<time::microseconds_t> NumericParameter::get_envelope_timestamps(size_t buckets) {
+    std::vector<time::microseconds_t> timestamps;
+    if (update_strategy_ != UpdateStrategy::TrackKey || !track_) {
+        return timestamps;
+    }
+    // samples of the field's own store - custom series are not on trackpoint timestamps
+    const track::MinMaxPyramid* pyramid = track_->get_min_max_pyramid(field);
+    if (!pyramid || pyramid->size() <= 4 * buckets) {
+        return timestamps;
+    }
+
+    for (size_t idx : pyramid->envelope(0, pyramid->size() - 1, buckets)) {
+        timestamps.push_back(pyramid->timestamp(idx));
+    }
+    return timestamps;
+}
+
+bool NumericParameter::get_extremes(double& min_value, double& max_value) {
+    if (update_strategy_ != UpdateStrategy::TrackKey || !track_) {
+        return false;
+    }
+    const track::MinMaxPyramid* pyramid = track_->get_min_max_pyramid(field);
+    if (!pyramid || pyramid->size() == 0) {
+        return false;
+    }
+
+    auto extremes = pyramid->get(size_t{0}, pyramid->size() - 1);
+    if (extremes.min_index == track::MinMaxPyramid::npos) {
+        return false;
+    }
+    min_value = pyramid->value(extremes.min_index);
+    max_value = pyramid->value(extremes.max_index);
+    return true;
+}
+
 bool NumericParameter::is_static() const {
     return update_strategy_ == UpdateStrategy::Static;
 }
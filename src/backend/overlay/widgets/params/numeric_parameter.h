@@ -37,6 +37,13 @@ public:
     
     std::shared_ptr<value_map_t> get_all_values();
 
+    /* timestamps of samples outlining all values split into given number of runs, so drawing them
+     * keeps extent of each run (see track::MinMaxPyramid) - empty unless value is a numeric track key
+     * with more samples than that needs */
+    std::vector<time::microseconds_t> get_envelope_timestamps(size_t buckets);
+    /* extremes of all values in O(log n) - false unless value is a numeric track key */
+    bool get_extremes(double& min_value, double& max_value);
+
     bool is_static() const;
 
 private:
@@ -49,7 +56,9 @@ private:
     std::shared_ptr<track::Track> track_ = nullptr;
 
     //used by TrackKey update strategy
-    track::field_id_t field_id = track::INVALID_FIELD;
+    track::FieldHandle field;
+    track::TrackCursor cursor_;
+    track::validity_t validity_; // value_ is up to date within
 
     //used by Expression update strategy
     std::shared_ptr<Expression> expression_ = nullptr;
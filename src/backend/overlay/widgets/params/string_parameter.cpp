@@ -27,7 +27,7 @@ std::shared_ptr<StringParameter> StringParameter::create(
 StringParameter::StringParameter(const std::string& key, std::shared_ptr<track::Track> track)
         : update_strategy_(UpdateStrategy::TrackKey),
           track_(track),
-          field_id(track->get_field_id(key)) {
+          field(track->bind(key)) {
 }
 
 StringParameter::StringParameter(const std::string& static_value)
@@ -41,7 +41,7 @@ bool StringParameter::update(time::microseconds_t timestamp) {
             return false; // static value does not change
         case UpdateStrategy::TrackKey:
             if (track_) {
-                track::Value v = track_->get(field_id, timestamp);
+                track::Value v = track_->get(field, timestamp, cursor_);
                 std::string new_value = v.as_string();
                 if (new_value != value_) {
                     value_ = new_value;
@@ -51,7 +51,7 @@ std::shared_ptr<TimestampParameter> TimestampParameter::create(
 TimestampParameter::TimestampParameter(const std::string& key, std::shared_ptr<track::Track> track)
         : update_strategy_(UpdateStrategy::TrackKey),
           track_(track),
-          field_id(track->get_field_id(key)) {
+          field(track->bind(key)) {
 }
 
 void TimestampParameter::set_format_subparameter(std::shared_ptr<StringParameter> format) {
@@ -70,9 +70,9 @@ bool TimestampParameter::update(time::microseconds_t timestamp) {
     switch (update_strategy_) {
         case UpdateStrategy::TrackKey:
             if (track_) {
-                track::Value v = track_->get(field_id, timestamp);
+                track::Value v = track_->get(field, timestamp, cursor_);
                 if (!v.is_time_point()) {
-                    log.warning("TimestampParameter: value for field_id {} at timestamp {} is not a time_point", field_id, timestamp);
+                    log.warning("TimestampParameter: value for field_id {} at timestamp {} is not a time_point", field.id(), timestamp);
                     return false;
                 }
 
@@ -0,0 +1,98 @@
+#include "baked_timeline.h"
+
+#include <cmath>
+#include <limits>
+
+namespace telemetry {
+namespace track {
+namespace consts {
+    constexpr int64_t us_per_second = 1'000'000;
+}
+
+namespace {
+    int64_t floor_div(int64_t a, int64_t b) {
+        int64_t q = a / b;
+        return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+    }
+
+    int64_t ceil_div(int64_t a, int64_t b) {
+        return -floor_div(-a, b);
+    }
+}
+
+BakedTimeline::BakedTimeline(uint32_t fps_n, uint32_t fps_d, time::microseconds_t first, time::microseconds_t last,
+                             size_t slot_count, size_t memory_budget)
+        : fps_n_(fps_n),
+          fps_d_(fps_d),
+          slots_(std::make_unique<slot_t[]>(slot_count)),
+          slot_count_(slot_count),
+          memory_budget_(memory_budget) {
+    if (fps_n_ == 0 || fps_d_ == 0 || last < first) {
+        return;
+    }
+    int64_t period_scale = static_cast<int64_t>(fps_d_) * consts::us_per_second;
+    first_frame_ = ceil_div(first * fps_n_, period_scale);
+    int64_t last_frame = floor_div(last * fps_n_, period_scale);
+    if (last_frame >= first_frame_) {
+        sample_count_ = static_cast<size_t>(last_frame - first_frame_ + 1);
+    }
+}
+
+uint32_t BakedTimeline::fps_n() const {
+    return fps_n_;
+}
+
+uint32_t BakedTimeline::fps_d() const {
+    return fps_d_;
+}
+
+size_t BakedTimeline::sample_count() const {
+    return sample_count_;
+}
+
+time::microseconds_t BakedTimeline::sample_time(size_t index) const {
+    return floor_div(frame(index) * fps_d_ * consts::us_per_second, fps_n_);
+}
+
+size_t BakedTimeline::sample_index(time::microseconds_t timestamp) const {
+    if (sample_count_ == 0) {
+        return npos;
+    }
+    // round(timestamp * fps_n / (fps_d * 1e6))
+    int64_t period_scale = static_cast<int64_t>(fps_d_) * consts::us_per_second;
+    int64_t nearest = floor_div(2 * timestamp * fps_n_ + period_scale, 2 * period_scale);
+    if (nearest < first_frame_ || nearest - first_frame_ >= static_cast<int64_t>(sample_count_)) {
+        return npos;
+    }
+    size_t index = static_cast<size_t>(nearest - first_frame_);
+    if (std::abs(sample_time(index) - timestamp) > max_frame_offset) {
+        return npos;
+    }
+    return index;
+}
+
+size_t BakedTimeline::memory_usage() const {
+    return memory_usage_.load();
+}
+
+int64_t BakedTimeline::frame(size_t index) const {
+    return first_frame_ + static_cast<int64_t>(index);
+}
+
+bool BakedTimeline::reserve(size_t slot, slot_t& data) {
+    size_t bytes = sample_count_ * sizeof(double);
+    size_t used = memory_usage_.fetch_add(bytes);
+    if (used + bytes > memory_budget_) {
+        memory_usage_.fetch_sub(bytes);
+        log.warning("Baking slot {} ({} samples) would exceed memory budget of {} bytes, it will be interpolated",
+                    slot, sample_count_, memory_budget_);
+        return false;
+    }
+    data.values.assign(sample_count_, std::numeric_limits<double>::quiet_NaN());
+    log.info("Baking slot {}: {} samples at {}/{} fps, {} bytes in total",
+             slot, sample_count_, fps_n_, fps_d_, used + bytes);
+    return true;
+}
+
+} // namespace track
+} // namespace telemetry
@@ -0,0 +1,105 @@
+#ifndef BAKED_TIMELINE_H
+#define BAKED_TIMELINE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "backend/utils/logging/logger.h"
+#include "backend/utils/time.h"
+#include "track_cursor.h"
+
+namespace telemetry {
+namespace track {
+
+/* Interpolated fields resampled onto the video frame grid.
+ *
+ * Frame k is at floor(k * fps_d / fps_n) seconds, in microseconds - the
+ * same truncation GStreamer timestamps go through - so frame timestamps
+ * map to a sample with a single index computation. Timestamps further than
+ * max_frame_offset from a frame (variable rate, seeks to arbitrary time)
+ * are not on the grid and have to be interpolated as usual.
+ *
+ * Columns (slots) are baked lazily on first lookup, each exactly once even
+ * with concurrent lookups, as long as the memory budget allows. Missing
+ * values are stored as NaN. */
+class BakedTimeline {
+public:
+    static constexpr size_t npos = SIZE_MAX;
+    static constexpr time::microseconds_t max_frame_offset = 1000; // containers often round to ms
+
+    /* grid covers frames within [first, last] */
+    BakedTimeline(uint32_t fps_n, uint32_t fps_d, time::microseconds_t first, time::microseconds_t last,
+                  size_t slot_count, size_t memory_budget);
+    ~BakedTimeline() = default;
+
+    uint32_t fps_n() const;
+    uint32_t fps_d() const;
+
+    size_t sample_count() const;
+    time::microseconds_t sample_time(size_t index) const;
+    /* sample of frame nearest to timestamp, npos if timestamp is not on the grid */
+    size_t sample_index(time::microseconds_t timestamp) const;
+
+    /* sampler(timestamp, cursor) -> double (NaN if missing) is called for all samples on first lookup
+     * false if timestamp is not on the grid or slot did not fit into memory budget */
+    template<typename Sampler>
+    bool get(size_t slot, time::microseconds_t timestamp, double& value, Sampler&& sampler);
+
+    /* bytes held by baked slots */
+    size_t memory_usage() const;
+
+private:
+    mutable utils::logging::Logger log{"baked_timeline"};
+
+    struct slot_t {
+        std::once_flag baked;
+        std::vector<double> values; // empty if not baked
+    };
+
+    int64_t frame(size_t index) const;
+    bool reserve(size_t slot, slot_t& data);
+
+    uint32_t fps_n_;
+    uint32_t fps_d_;
+    int64_t first_frame_ = 0;
+    size_t sample_count_ = 0;
+
+    std::unique_ptr<slot_t[]> slots_;
+    size_t slot_count_;
+    size_t memory_budget_;
+    std::atomic<size_t> memory_usage_{0};
+};
+
+template<typename Sampler>
+bool BakedTimeline::get(size_t slot, time::microseconds_t timestamp, double& value, Sampler&& sampler) {
+    size_t index = sample_index(timestamp);
+    if (index == npos || slot >= slot_count_) {
+        return false;
+    }
+
+    slot_t& data = slots_[slot];
+    std::call_once(data.baked, [&]() {
+        if (!reserve(slot, data)) {
+            return;
+        }
+        TrackCursor cursor;
+        for (size_t i = 0; i < sample_count_; ++i) {
+            data.values[i] = sampler(sample_time(i), cursor);
+        }
+    });
+
+    if (data.values.empty()) {
+        return false;
+    }
+    value = data.values[index];
+    return true;
+}
+
+} // namespace track
+} // namespace telemetry
+
+#endif // BAKED_TIMELINE_H
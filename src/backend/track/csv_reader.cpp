@@ -0,0 +1,309 @@
+#include "csv_reader.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+
+namespace telemetry {
+namespace track {
+namespace consts {
+    constexpr std::string_view delimiters = ",;\t";
+    constexpr std::string_view utf8_bom = "\xEF\xBB\xBF";
+    constexpr double powers_of_ten[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+    };
+}
+
+namespace {
+    /* cell without surrounding spaces and quotes */
+    std::string_view trim_cell(std::string_view cell) {
+        while (!cell.empty() && (cell.front() == ' ' || cell.front() == '\t')) {
+            cell.remove_prefix(1);
+        }
+        while (!cell.empty() && (cell.back() == ' ' || cell.back() == '\t')) {
+            cell.remove_suffix(1);
+        }
+        if (cell.size() >= 2 && cell.front() == '"' && cell.back() == '"') {
+            cell = cell.substr(1, cell.size() - 2);
+        }
+        return cell;
+    }
+
+    /* plain decimal ([-]digits[.digits]) with up to 15 significant digits at p, p stops at first
+     * other character - mantissa and power of ten are both exact doubles, so the division is
+     * correctly rounded (same result as from_chars) */
+    bool scan_decimal(const char*& p, const char* end, double& value) {
+        bool negative = (p != end && *p == '-');
+        p += negative ? 1 : 0;
+
+        uint64_t mantissa = 0;
+        size_t digits = 0;
+        size_t fraction_digits = 0;
+        bool fraction = false;
+        for (; p != end; ++p) {
+            unsigned digit = static_cast<unsigned>(*p - '0');
+            if (digit <= 9) {
+                mantissa = mantissa * 10 + digit;
+                ++digits;
+                fraction_digits += fraction ? 1 : 0;
+            } else if (*p == '.' && !fraction) {
+                fraction = true;
+            } else {
+                break;
+            }
+        }
+        if (digits == 0 || digits > 15) {
+            return false;
+        }
+        value = static_cast<double>(mantissa) / consts::powers_of_ten[fraction_digits];
+        value = negative ? -value : value;
+        return true;
+    }
+
+    /* whole cell has to be a number */
+    bool parse_double(std::string_view cell, double& value) {
+        if (!cell.empty() && cell.front() == '+') {
+            cell.remove_prefix(1);
+        }
+        const char* p = cell.data();
+        if (scan_decimal(p, cell.data() + cell.size(), value) && p == cell.data() + cell.size()) {
+            return true;
+        }
+        auto [ptr, ec] = std::from_chars(cell.data(), cell.data() + cell.size(), value);
+        return ec == std::errc() && ptr == cell.data() + cell.size();
+    }
+
+    /* rounded, seconds with fraction are rarely exact doubles */
+    time::microseconds_t to_microseconds(double seconds) {
+        return static_cast<time::microseconds_t>(std::llround(seconds * 1'000'000.0));
+    }
+
+    enum class Cell {
+        Number,
+        Empty,
+        Unparsable,
+    };
+
+    /* value cell at p, p moves past its delimiter (nullptr after last cell) - plain decimals are
+     * parsed in the same pass that finds the delimiter, anything else is trimmed first */
+    Cell parse_cell(const char*& p, const char* end, char delimiter, double& value) {
+        const char* begin = p;
+        if (scan_decimal(p, end, value) && (p == end || *p == delimiter)) {
+            p = (p == end) ? nullptr : p + 1;
+            return Cell::Number;
+        }
+
+        const void* found = std::memchr(begin, delimiter, static_cast<size_t>(end - begin));
+        const char* cell_end = found ? static_cast<const char*>(found) : end;
+        p = found ? cell_end + 1 : nullptr;
+
+        std::string_view cell = trim_cell(std::string_view(begin, static_cast<size_t>(cell_end - begin)));
+        if (cell.empty()) {
+            return Cell::Empty;
+        }
+        return parse_double(cell, value) ? Cell::Number : Cell::Unparsable;
+    }
+
+    /* next cell of line starting at pos, pos moves past its delimiter (npos after last cell) */
+    std::string_view next_cell(std::string_view line, size_t& pos, char delimiter) {
+        const char* begin = line.data() + pos;
+        size_t left = line.size() - pos;
+        const void* found = std::memchr(begin, delimiter, left);
+        if (!found) {
+            pos = std::string_view::npos;
+            return std::string_view(begin, left);
+        }
+        size_t length = static_cast<size_t>(static_cast<const char*>(found) - begin);
+        pos += length + 1;
+        return std::string_view(begin, length);
+    }
+}
+
+CsvReader::CsvReader(size_t chunk_size) : chunk_size_(chunk_size) {
+}
+
+bool CsvReader::read(const std::string& path, series_t& series) {
+    FileTail input(path);
+    if (!input.open()) {
+        return false;
+    }
+    return read(input, series);
+}
+
+bool CsvReader::read(FileTail& input, series_t& series) {
+    const std::string& path = input.path();
+    std::error_code ec;
+    file_size_ = static_cast<size_t>(std::filesystem::file_size(path, ec));
+    file_size_ = ec ? 0 : file_size_;
+
+    series = series_t{};
+    line_number_ = 0;
+    unparsable_cells_ = 0;
+    bool header = true;
+
+    std::string buffer;
+    size_t pos = 0;
+    bool eof = false;
+    while (!eof || pos < buffer.size()) {
+        const char* begin = buffer.data() + pos;
+        const void* newline = std::memchr(begin, '\n', buffer.size() - pos);
+        if (!newline && !eof) {
+            // keep incomplete line, append next chunk
+            buffer.erase(0, pos);
+            pos = 0;
+            size_t old_size = buffer.size();
+            buffer.resize(old_size + chunk_size_);
+            size_t read = input.read(buffer.data() + old_size, chunk_size_);
+            buffer.resize(old_size + read);
+            eof = (read == 0);
+            if (eof && input.stopped()) {
+                return false; // last line may be incomplete
+            }
+            continue;
+        }
+
+        size_t length = newline ? static_cast<size_t>(static_cast<const char*>(newline) - begin) : buffer.size() - pos;
+        std::string_view line(begin, length);
+        pos += length + (newline ? 1 : 0);
+        ++line_number_;
+
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.find_first_not_of(" \t") == std::string_view::npos) {
+            continue; // empty line
+        }
+
+        if (header) {
+            if (line.starts_with(consts::utf8_bom)) {
+                line.remove_prefix(consts::utf8_bom.size());
+            }
+            if (!parse_header(line, series)) {
+                log.error("Invalid header in file: {}", path);
+                return false;
+            }
+            header = false;
+        } else if (!parse_row(line, series)) {
+            log.error("Invalid row at line {} in file: {}", line_number_, path);
+            return false;
+        }
+    }
+
+    if (header) {
+        log.error("Missing header in file: {}", path);
+        return false;
+    }
+    if (unparsable_cells_ > 0) {
+        log.warning("{} unparsable cells treated as missing samples in file: {}", unparsable_cells_, path);
+    }
+    return true;
+}
+
+bool CsvReader::parse_header(std::string_view line, series_t& series) {
+    // most frequent delimiter candidate wins, comma on tie
+    size_t best_count = 0;
+    delimiter_ = consts::delimiters.front();
+    for (char delimiter : consts::delimiters) {
+        size_t count = static_cast<size_t>(std::count(line.begin(), line.end(), delimiter));
+        if (count > best_count) {
+            best_count = count;
+            delimiter_ = delimiter;
+        }
+    }
+    if (best_count == 0) {
+        log.error("Header has to contain time and at least one value column: {}", line);
+        return false;
+    }
+
+    size_t pos = 0;
+    next_cell(line, pos, delimiter_); // time column
+    while (pos != std::string_view::npos) {
+        std::string_view name = trim_cell(next_cell(line, pos, delimiter_));
+        if (name.empty()) {
+            log.error("Empty name of column {} in header", series.names.size() + 2);
+            return false;
+        }
+        series.names.emplace_back(name);
+    }
+    series.columns.resize(series.names.size());
+    return true;
+}
+
+bool CsvReader::parse_row(std::string_view line, series_t& series) {
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+    if (series.timestamps.empty() && !line.empty()) {
+        // rows of the rest of file are expected to be about as long as the first one
+        size_t rows = file_size_ / (line.size() + 1) + 1;
+        series.timestamps.reserve(rows);
+        for (auto& column : series.columns) {
+            column.reserve(rows);
+        }
+    }
+
+    const char* p = line.data();
+    const char* end = line.data() + line.size();
+    double seconds = 0.0;
+    if (!series.absolute_time && parse_cell(p, end, delimiter_, seconds) == Cell::Number) {
+        series.timestamps.push_back(to_microseconds(seconds));
+    } else {
+        size_t pos = 0;
+        if (!parse_time(trim_cell(next_cell(line, pos, delimiter_)), series)) {
+            return false;
+        }
+        p = (pos == std::string_view::npos) ? nullptr : line.data() + pos;
+    }
+
+    size_t column = 0;
+    for (; p && column < series.columns.size(); ++column) {
+        double value = nan;
+        Cell cell = parse_cell(p, end, delimiter_, value);
+        if (cell == Cell::Unparsable) {
+            value = nan;
+            ++unparsable_cells_;
+        }
+        series.columns[column].push_back(value);
+    }
+    if (p) {
+        log.error("More cells than header columns ({})", series.columns.size() + 1);
+        return false;
+    }
+    // missing trailing cells
+    for (; column < series.columns.size(); ++column) {
+        series.columns[column].push_back(nan);
+    }
+    return true;
+}
+
+bool CsvReader::parse_time(std::string_view cell, series_t& series) {
+    double seconds = 0.0;
+    bool relative = parse_double(cell, seconds);
+    if (series.timestamps.empty()) {
+        series.absolute_time = !relative;
+    }
+
+    if (!series.absolute_time) {
+        if (!relative) {
+            log.error("Time '{}' is not in seconds like in previous rows", cell);
+            return false;
+        }
+        series.timestamps.push_back(to_microseconds(seconds));
+        return true;
+    }
+
+    time::time_point_t timestamp = time::parse_iso8601(cell);
+    if (timestamp == time::INVALID_TIME_POINT) {
+        log.error("Time '{}' is neither seconds nor ISO 8601 timestamp", cell);
+        return false;
+    }
+    series.timestamps.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+        timestamp.time_since_epoch()).count());
+    return true;
+}
+
+} // namespace track
+} // namespace telemetry
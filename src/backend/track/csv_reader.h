@@ -0,0 +1,63 @@
+#ifndef CSV_READER_H
+#define CSV_READER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "backend/utils/logging/logger.h"
+#include "backend/utils/time.h"
+#include "file_tail.h"
+
+namespace telemetry {
+namespace track {
+
+/* Streaming reader of time series in delimited text (CSV).
+ *
+ * First line is a header with column names, first column holds time - either
+ * seconds (relative) or ISO 8601 timestamps (absolute), same form in all rows.
+ * Other columns are numeric, empty or unparsable cells are missing samples.
+ * Delimiter (',', ';' or tab) is detected from the header, cells may be
+ * double quoted but can not contain the delimiter.
+ *
+ * File is read in fixed size chunks, lines are located with memchr and cells
+ * parsed with std::from_chars straight into the columns - no per cell
+ * allocations, memory use is the parsed columns plus one chunk.
+ *
+ * Input may also be a followed file (see FileTail) that is still being
+ * written - rows are then parsed as their lines are completed. */
+class CsvReader {
+public:
+    struct series_t {
+        bool absolute_time = false;               // microseconds since epoch, since track start otherwise
+        std::vector<time::microseconds_t> timestamps;
+        std::vector<std::string> names;           // of value columns
+        std::vector<std::vector<double>> columns; // value per timestamp, NaN where missing
+    };
+
+    CsvReader(size_t chunk_size = 1 << 20);
+    ~CsvReader() = default;
+
+    bool read(const std::string& path, series_t& series);
+    /* input has to be open, false without error if its stop was requested */
+    bool read(FileTail& input, series_t& series);
+
+private:
+    bool parse_header(std::string_view line, series_t& series);
+    bool parse_row(std::string_view line, series_t& series);
+    bool parse_time(std::string_view cell, series_t& series);
+
+    mutable utils::logging::Logger log{"csv_reader"};
+
+    size_t chunk_size_;
+    char delimiter_ = ',';
+    size_t file_size_ = 0;
+    size_t line_number_ = 0;
+    size_t unparsable_cells_ = 0;
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // CSV_READER_H
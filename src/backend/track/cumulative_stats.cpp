@@ -0,0 +1,88 @@
+#include "cumulative_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace telemetry {
+namespace track {
+
+CumulativeStats::CumulativeStats(const TrackpointStore& store, size_t column) : store_(store), column_(column) {
+    extend();
+}
+
+void CumulativeStats::extend() {
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+    size_t first = series_[0].size();
+    size_t count = store_.size();
+    auto timestamps = store_.timestamps();
+    for (auto& series : series_) {
+        series.resize(count, nan);
+    }
+    auto& max = series_[static_cast<size_t>(CumulativeStat::Max)];
+    auto& min = series_[static_cast<size_t>(CumulativeStat::Min)];
+    auto& avg = series_[static_cast<size_t>(CumulativeStat::Avg)];
+    auto& gain = series_[static_cast<size_t>(CumulativeStat::Gain)];
+    auto& np = series_[static_cast<size_t>(CumulativeStat::Np)];
+
+    for (size_t i = first; i < count; ++i) {
+        if (i > 0) {
+            max[i] = max[i - 1];
+            min[i] = min[i - 1];
+            avg[i] = avg[i - 1];
+            gain[i] = gain[i - 1];
+            np[i] = np[i - 1];
+        }
+        if (!store_.is_sample(column_, i)) {
+            continue;
+        }
+
+        double value = store_.value(column_, i);
+        if (samples_ == 0) {
+            first_time_ = timestamps[i];
+            max[i] = value;
+            min[i] = value;
+            gain[i] = 0.0;
+        } else {
+            max[i] = std::max(max[i], value);
+            min[i] = std::min(min[i], value);
+            gain[i] += std::max(value - previous_, 0.0);
+        }
+        ++samples_;
+        sum_ += value;
+        avg[i] = sum_ / static_cast<double>(samples_);
+        previous_ = value;
+
+        window_sum_ += value;
+        ++window_samples_;
+        for (; timestamps[window_begin_] <= timestamps[i] - np_window; ++window_begin_) {
+            if (store_.is_sample(column_, window_begin_)) {
+                window_sum_ -= store_.value(column_, window_begin_);
+                --window_samples_;
+            }
+        }
+        if (timestamps[i] - np_window >= first_time_) {
+            rolling_sum_ += std::pow(window_sum_ / static_cast<double>(window_samples_), 4);
+            ++rolling_samples_;
+            np[i] = std::pow(rolling_sum_ / static_cast<double>(rolling_samples_), 0.25);
+        }
+    }
+}
+
+const std::vector<double>* CumulativeStats::series(CumulativeStat stat) const {
+    if (stat >= CumulativeStat::Count) {
+        return nullptr;
+    }
+    return &series_[static_cast<size_t>(stat)];
+}
+
+size_t CumulativeStats::memory_usage() const {
+    size_t bytes = 0;
+    for (const auto& series : series_) {
+        bytes += series.size() * sizeof(double);
+    }
+    return bytes;
+}
+
+} // namespace track
+} // namespace telemetry
@@ -0,0 +1,81 @@
+#ifndef CUMULATIVE_STATS_H
+#define CUMULATIVE_STATS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "backend/utils/time.h"
+#include "trackpoint_store.h"
+
+namespace telemetry {
+namespace track {
+
+/* Statistics of a trackpoint field from the first trackpoint up to the
+ * current one - exposed as "<name>_point_FIELD" fields. The enumerator is
+ * encoded in the field id, so append only (before Count). */
+enum class CumulativeStat : uint8_t {
+    Max,
+    Min,
+    Avg,  // mean of samples (not time weighted)
+    Gain, // sum of rises between consecutive samples (e.g. total ascent)
+    Np,   // normalized power - 4th root of mean of 4th powers of 30s rolling average
+    Count,
+};
+
+inline constexpr std::array<std::string_view, static_cast<size_t>(CumulativeStat::Count)> cumulative_stat_names = {
+    "max",
+    "min",
+    "avg",
+    "gain",
+    "np",
+};
+
+/* Prefix arrays of all cumulative statistics of one double column.
+ *
+ * Computed in a single pass over the column, after that a statistic at
+ * a trackpoint is one array access. Rows where the column is missing or
+ * joined carry the statistic of the previous sample over, NaN until the first
+ * sample (Np until a full rolling window has elapsed). State of the pass is
+ * kept, so rows appended to the store later (live track) are added without
+ * a new pass. */
+class CumulativeStats {
+public:
+    static constexpr time::microseconds_t np_window = 30'000'000;
+
+    CumulativeStats(const TrackpointStore& store, size_t column);
+    ~CumulativeStats() = default;
+
+    /* value for each trackpoint index - the vector itself stays valid when extended, its data does not */
+    const std::vector<double>* series(CumulativeStat stat) const;
+
+    /* adds trackpoints appended to the store since construction or previous call */
+    void extend();
+
+    size_t memory_usage() const;
+
+private:
+    const TrackpointStore& store_;
+    size_t column_;
+
+    std::array<std::vector<double>, static_cast<size_t>(CumulativeStat::Count)> series_;
+
+    size_t samples_ = 0;
+    double sum_ = 0.0;
+    double previous_ = 0.0;
+    time::microseconds_t first_time_ = 0;
+
+    // rolling window (window_begin_, i] of valid samples for normalized power
+    size_t window_begin_ = 0;
+    size_t window_samples_ = 0;
+    double window_sum_ = 0.0;
+    size_t rolling_samples_ = 0;
+    double rolling_sum_ = 0.0; // of 4th powers
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // CUMULATIVE_STATS_H
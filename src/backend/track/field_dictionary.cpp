@@ -0,0 +1,94 @@
+#include "field_dictionary.h"
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+namespace telemetry {
+namespace track {
+namespace consts {
+    constexpr size_t min_slot_count = 64;
+}
+
+namespace {
+    uint64_t hash_name(std::string_view name) {
+        return std::hash<std::string_view>{}(name);
+    }
+}
+
+field_id_t FieldDictionary::find(std::string_view name) const {
+    if (slots_.empty()) {
+        return INVALID_FIELD;
+    }
+    size_t slot = find_slot(name, hash_name(name));
+    if (slots_[slot] == empty_slot) {
+        return INVALID_FIELD;
+    }
+    return entries_[slots_[slot]].id;
+}
+
+bool FieldDictionary::contains(std::string_view name) const {
+    return find(name) != INVALID_FIELD;
+}
+
+void FieldDictionary::assign(std::string_view name, field_id_t id) {
+    // keep load factor at most 1/2
+    if ((entries_.size() + 1) * 2 > slots_.size()) {
+        rehash(std::max(consts::min_slot_count, slots_.size() * 2));
+    }
+
+    uint64_t hash = hash_name(name);
+    size_t slot = find_slot(name, hash);
+    if (slots_[slot] != empty_slot) {
+        entries_[slots_[slot]].id = id;
+        return;
+    }
+    slots_[slot] = static_cast<uint32_t>(entries_.size());
+    entries_.push_back({std::string(name), id, hash});
+}
+
+void FieldDictionary::reserve(size_t count) {
+    entries_.reserve(count);
+    size_t slot_count = std::bit_ceil(std::max(consts::min_slot_count, count * 2));
+    if (slot_count > slots_.size()) {
+        rehash(slot_count);
+    }
+}
+
+size_t FieldDictionary::size() const {
+    return entries_.size();
+}
+
+std::span<const FieldDictionary::entry_t> FieldDictionary::entries() const {
+    return entries_;
+}
+
+/* slot holding name, or first empty slot of its probe sequence */
+size_t FieldDictionary::find_slot(std::string_view name, uint64_t hash) const {
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        uint32_t index = slots_[slot];
+        if (index == empty_slot) {
+            return slot;
+        }
+        const auto& entry = entries_[index];
+        if (entry.hash == hash && entry.name == name) {
+            return slot;
+        }
+    }
+}
+
+void FieldDictionary::rehash(size_t slot_count) {
+    slots_.assign(slot_count, empty_slot);
+    size_t mask = slot_count - 1;
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        size_t slot = entries_[i].hash & mask;
+        while (slots_[slot] != empty_slot) {
+            slot = (slot + 1) & mask;
+        }
+        slots_[slot] = static_cast<uint32_t>(i);
+    }
+}
+
+} // namespace track
+} // namespace telemetry
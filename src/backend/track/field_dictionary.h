@@ -0,0 +1,57 @@
+#ifndef FIELD_DICTIONARY_H
+#define FIELD_DICTIONARY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "field_handle.h"
+
+namespace telemetry {
+namespace track {
+
+/* Field name to field id map.
+ *
+ * Open addressing hash table with linear probing. Entries are kept in
+ * insertion order in a separate array, slots only hold entry indexes, so
+ * growing the table never moves names. Lookups take string_view and do not
+ * allocate. */
+class FieldDictionary {
+public:
+    struct entry_t {
+        std::string name;
+        field_id_t id;
+        uint64_t hash;
+    };
+
+    FieldDictionary() = default;
+    ~FieldDictionary() = default;
+
+    /* INVALID_FIELD if name is not present */
+    field_id_t find(std::string_view name) const;
+    bool contains(std::string_view name) const;
+    /* inserts name or overwrites its id */
+    void assign(std::string_view name, field_id_t id);
+    void reserve(size_t count);
+
+    size_t size() const;
+    /* insertion order */
+    std::span<const entry_t> entries() const;
+
+private:
+    static constexpr uint32_t empty_slot = UINT32_MAX;
+
+    size_t find_slot(std::string_view name, uint64_t hash) const;
+    void rehash(size_t slot_count);
+
+    std::vector<entry_t> entries_;
+    std::vector<uint32_t> slots_; // entry index or empty_slot, size is power of two
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // FIELD_DICTIONARY_H
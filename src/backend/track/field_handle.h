@@ -0,0 +1,77 @@
+#ifndef FIELD_HANDLE_H
+#define FIELD_HANDLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "backend/utils/time.h"
+#include "field_id.h"
+#include "trackpoint_store.h"
+#include "value.h"
+#include "virtual_field.h"
+
+namespace telemetry {
+namespace track {
+
+static constexpr time::microseconds_t VALID_FOREVER = INT64_MAX;
+
+/* time range [from, until) in which a queried value is known not to change */
+struct validity_t {
+    time::microseconds_t from = 0;
+    time::microseconds_t until = 0; // empty until first query
+
+    bool contains(time::microseconds_t timestamp) const {
+        return from <= timestamp && timestamp < until;
+    }
+};
+
+/* Field resolved once by Track::bind.
+ *
+ * Holds everything needed to answer Track::get without name or id lookups:
+ * trackpoint column, virtual field, cumulative statistic series or constant
+ * metadata value.
+ * Only valid for the track it was bound on, and only after that track has
+ * been loaded. */
+class FieldHandle {
+public:
+    FieldHandle() = default;
+    ~FieldHandle() = default;
+
+    field_id_t id() const {
+        return id_;
+    }
+
+    bool is_valid() const {
+        return kind_ != Kind::Invalid;
+    }
+
+private:
+    friend class Track;
+
+    enum class Kind : uint8_t {
+        Invalid,
+        Virtual,
+        Cumulative,
+        SegmentVirtual,
+        Rider,
+        Segment,
+        Trackpoint,
+        Lerp,
+        Pchip,
+        Metadata,
+    };
+
+    field_id_t id_ = INVALID_FIELD;
+    Kind kind_ = Kind::Invalid;
+    VirtualField virtual_ = VirtualField::Count;  // Virtual
+    const TrackpointStore* store_ = nullptr;      // Trackpoint, Lerp, Pchip - track or custom series samples
+    size_t column_ = SIZE_MAX;                    // Trackpoint, Lerp, Pchip
+    const std::vector<double>* series_ = nullptr; // Cumulative, value per trackpoint (grows with live track)
+    Value value_;                                 // Metadata
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // FIELD_HANDLE_H
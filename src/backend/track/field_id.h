@@ -0,0 +1,90 @@
+#ifndef FIELD_ID_H
+#define FIELD_ID_H
+
+#include <bit>
+#include <cstdint>
+
+namespace telemetry {
+namespace track {
+
+using field_id_t = uint64_t;
+static constexpr field_id_t INVALID_FIELD = UINT64_MAX;
+
+/* Field id layout.
+ *
+ *   FFFF FFFF  |------------------------- 56 bits -------------------------|
+ *
+ * Flags (top byte) select how the rest is interpreted:
+ *  - plain virtual/metadata/trackpoint fields - sequential id in low 32 bits
+ *  - segment fields - segment_field_id (type, list, instance, field)
+ *  - cumulative (virtual + trackpoint) - statistic and trackpoint field id
+ *  - rider (virtual + rider) - standings field and rider number or rank */
+namespace consts {
+    namespace mask {
+        constexpr field_id_t flags            = 0xFF00000000000000;
+
+        constexpr field_id_t virtual_flag     = 0x8000000000000000;
+        constexpr field_id_t metadata_flag    = 0x4000000000000000;
+        constexpr field_id_t trackpoint_flag  = 0x2000000000000000;
+        constexpr field_id_t segment_flag     = 0x1000000000000000;
+        constexpr field_id_t rider_flag       = 0x0800000000000000;
+      /*   unused 0x04 flag                     0x0400000000000000 */
+        constexpr field_id_t lerp_flag        = 0x0200000000000000;
+        constexpr field_id_t pchip_flag       = 0x0100000000000000;
+
+        namespace segment {
+            constexpr field_id_t type         = 0x00FFFF0000000000; // up to 65536 segment types
+            constexpr field_id_t list         = 0x000000FF00000000; // up to 256 segment lists
+            constexpr field_id_t segment      = 0x00000000FFFF0000; // up to 65536 segment instances (within type-list context)
+            constexpr field_id_t field        = 0x000000000000FFFF; // up to 65536 fields (within segment point/segment metadata)
+        }
+
+        namespace cumulative {
+            constexpr field_id_t stat         = 0x000000FF00000000; // statistic, of trackpoint field in low 32 bits
+        }
+
+        namespace rider {
+            constexpr field_id_t ranked       = 0x0000000100000000; // index is rank, not rider
+            constexpr field_id_t field        = 0x00000000FFFF0000;
+            constexpr field_id_t index        = 0x000000000000FFFF; // 0 based rider or rank
+        }
+    }
+} // namespace consts
+
+/* segment field id without flags - each part is a masked shift both ways */
+struct segment_field_id {
+    field_id_t type;
+    field_id_t list;
+    field_id_t segment;
+    field_id_t field;
+
+    segment_field_id(field_id_t type, field_id_t list, field_id_t segment, field_id_t field)
+        : type(type), list(list), segment(segment), field(field) {}
+
+    segment_field_id(field_id_t fid) {
+        type = unpack(fid, consts::mask::segment::type);
+        list = unpack(fid, consts::mask::segment::list);
+        segment = unpack(fid, consts::mask::segment::segment);
+        field = unpack(fid, consts::mask::segment::field);
+    }
+
+    explicit operator field_id_t() const {
+        return pack(type, consts::mask::segment::type) |
+               pack(list, consts::mask::segment::list) |
+               pack(segment, consts::mask::segment::segment) |
+               pack(field, consts::mask::segment::field);
+    }
+
+    static constexpr field_id_t pack(field_id_t value, field_id_t mask) {
+        return (value << std::countr_zero(mask)) & mask;
+    }
+
+    static constexpr field_id_t unpack(field_id_t fid, field_id_t mask) {
+        return (fid & mask) >> std::countr_zero(mask);
+    }
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // FIELD_ID_H
@@ -0,0 +1,85 @@
+#include "file_tail.h"
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace telemetry {
+namespace track {
+
+FileTail::FileTail(std::string path, bool follow, std::stop_token stop, std::chrono::milliseconds poll_interval)
+    : path_(std::move(path)), follow_(follow), stop_(std::move(stop)), poll_interval_(poll_interval) {
+}
+
+FileTail::~FileTail() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+/* followed named pipe is opened non-blocking - open would otherwise wait for a writer, and a read for data */
+bool FileTail::open() {
+    fd_ = ::open(path_.c_str(), O_RDONLY | (follow_ ? O_NONBLOCK : 0));
+    if (fd_ < 0) {
+        log.error("Failed to open file: {} ({})", path_, std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+size_t FileTail::read(char* data, size_t size) {
+    if (fd_ < 0 || size == 0) {
+        return 0;
+    }
+    while (true) {
+        ssize_t count = ::read(fd_, data, size);
+        if (count > 0) {
+            return static_cast<size_t>(count);
+        }
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            log.error("Failed to read file: {} ({})", path_, std::strerror(errno));
+            return 0;
+        }
+        // end of data for now (pipe without writer reads as end of file too)
+        if (!follow_ || !wait()) {
+            return 0;
+        }
+    }
+}
+
+void FileTail::set_idle_callback(std::function<void()> callback) {
+    idle_callback_ = std::move(callback);
+}
+
+bool FileTail::stopped() const {
+    return stop_.stop_requested();
+}
+
+const std::string& FileTail::path() const {
+    return path_;
+}
+
+bool FileTail::wait() {
+    if (stop_.stop_requested()) {
+        return false;
+    }
+    if (idle_callback_) {
+        idle_callback_();
+    }
+
+    std::mutex mutex;
+    std::condition_variable_any cv;
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait_for(lock, stop_, poll_interval_, []() { return false; });
+    return !stop_.stop_requested();
+}
+
+} // namespace track
+} // namespace telemetry
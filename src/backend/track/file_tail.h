@@ -0,0 +1,61 @@
+#ifndef FILE_TAIL_H
+#define FILE_TAIL_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <stop_token>
+#include <string>
+
+#include "backend/utils/logging/logger.h"
+
+namespace telemetry {
+namespace track {
+
+/* Sequential reader of a file with plain POSIX reads.
+ *
+ * Optionally follows the file past its current end - a file another process
+ * is appending to, or a named pipe (FIFO) - then read() waits for more data
+ * (polling, interruptible by the stop token) instead of reporting end of file.
+ * Reports end of file only once stop is requested. */
+class FileTail {
+public:
+    static constexpr std::chrono::milliseconds default_poll_interval{100};
+
+    FileTail(std::string path, bool follow = false, std::stop_token stop = {},
+             std::chrono::milliseconds poll_interval = default_poll_interval);
+    ~FileTail();
+
+    bool open();
+
+    /* fills up to size bytes, waits for data when following; 0 at end of file, once stopped or on error */
+    size_t read(char* data, size_t size);
+
+    /* called (on the reading thread) when following and no data is available, before waiting for more */
+    void set_idle_callback(std::function<void()> callback);
+
+    /* stop was requested - input ends before end of document, which is not an error */
+    bool stopped() const;
+    const std::string& path() const;
+
+private:
+    /* false if stopped while waiting */
+    bool wait();
+
+    mutable utils::logging::Logger log{"file_tail"};
+
+    std::string path_;
+    bool follow_;
+    std::stop_token stop_;
+    std::chrono::milliseconds poll_interval_;
+    std::function<void()> idle_callback_;
+    int fd_ = -1;
+
+    FileTail(const FileTail&) = delete;
+    FileTail& operator=(const FileTail&) = delete;
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // FILE_TAIL_H
@@ -0,0 +1,318 @@
+#include "fit_reader.h"
+
+#include <bit>
+#include <cstring>
+
+namespace telemetry {
+namespace track {
+namespace consts {
+    constexpr std::string_view signature = ".FIT";
+    constexpr size_t min_header_size = 12;
+    constexpr size_t header_size_with_crc = 14;
+    constexpr size_t crc_size = 2;
+
+    namespace header {
+        constexpr uint8_t compressed_timestamp = 0x80;
+        constexpr uint8_t definition = 0x40;
+        constexpr uint8_t developer_data = 0x20;
+        constexpr uint8_t local_type = 0x0F;
+        constexpr uint8_t compressed_local_type = 0x60;
+        constexpr uint8_t compressed_time_offset = 0x1F;
+    }
+
+    // CRC-16 of FIT SDK, per nibble
+    constexpr uint16_t crc_table[16] = {
+        0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+        0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400,
+    };
+}
+
+namespace {
+    enum class Kind : uint8_t {
+        Unsigned,
+        Signed,
+        Float,
+        Skip, // string
+    };
+
+    struct base_type_t {
+        uint8_t size;
+        Kind kind;
+        uint64_t invalid; // raw value
+    };
+
+    // by base type number (low 5 bits of base type)
+    constexpr base_type_t base_types[] = {
+        {1, Kind::Unsigned, 0xFF},                  // enum
+        {1, Kind::Signed, 0x7F},                    // sint8
+        {1, Kind::Unsigned, 0xFF},                  // uint8
+        {2, Kind::Signed, 0x7FFF},                  // sint16
+        {2, Kind::Unsigned, 0xFFFF},                // uint16
+        {4, Kind::Signed, 0x7FFFFFFF},              // sint32
+        {4, Kind::Unsigned, 0xFFFFFFFF},            // uint32
+        {1, Kind::Skip, 0},                         // string
+        {4, Kind::Float, 0xFFFFFFFF},               // float32
+        {8, Kind::Float, 0xFFFFFFFFFFFFFFFF},       // float64
+        {1, Kind::Unsigned, 0},                     // uint8z
+        {2, Kind::Unsigned, 0},                     // uint16z
+        {4, Kind::Unsigned, 0},                     // uint32z
+        {1, Kind::Unsigned, 0xFF},                  // byte
+        {8, Kind::Signed, 0x7FFFFFFFFFFFFFFF},      // sint64
+        {8, Kind::Unsigned, 0xFFFFFFFFFFFFFFFF},    // uint64
+        {8, Kind::Unsigned, 0},                     // uint64z
+    };
+
+    uint16_t crc_update(uint16_t crc, std::span<const uint8_t> bytes) {
+        for (uint8_t byte : bytes) {
+            uint16_t tmp = consts::crc_table[crc & 0xF];
+            crc = ((crc >> 4) & 0x0FFF) ^ tmp ^ consts::crc_table[byte & 0xF];
+            tmp = consts::crc_table[crc & 0xF];
+            crc = ((crc >> 4) & 0x0FFF) ^ tmp ^ consts::crc_table[(byte >> 4) & 0xF];
+        }
+        return crc;
+    }
+
+    uint64_t read_raw(const uint8_t* data, size_t size, bool big_endian) {
+        uint64_t raw = 0;
+        for (size_t i = 0; i < size; ++i) {
+            size_t byte = big_endian ? i : size - 1 - i;
+            raw = (raw << 8) | data[byte];
+        }
+        return raw;
+    }
+
+    /* false for invalid value */
+    bool decode(const uint8_t* data, const base_type_t& type, bool big_endian, double& value) {
+        uint64_t raw = read_raw(data, type.size, big_endian);
+        if (raw == type.invalid) {
+            return false;
+        }
+        switch (type.kind) {
+            case Kind::Unsigned:
+                value = static_cast<double>(raw);
+                return true;
+            case Kind::Signed:
+                {
+                    unsigned shift = 64 - 8 * type.size;
+                    value = static_cast<double>(static_cast<int64_t>(raw << shift) >> shift);
+                    return true;
+                }
+            case Kind::Float:
+                value = (type.size == 4) ? static_cast<double>(std::bit_cast<float>(static_cast<uint32_t>(raw)))
+                                         : std::bit_cast<double>(raw);
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
+FitReader::FitReader(size_t chunk_size) : chunk_size_(chunk_size) {
+}
+
+bool FitReader::read(const std::string& path, Handler& handler) {
+    in_ = std::ifstream(path, std::ios::binary);
+    if (!in_) {
+        log.error("Failed to open file: {}", path);
+        return false;
+    }
+    buffer_.clear();
+    pos_ = 0;
+    eof_ = false;
+
+    size_t files = 0;
+    while (ensure(1)) {
+        if (!read_file(handler)) {
+            log.error("Failed to decode FIT file: {}", path);
+            return false;
+        }
+        ++files;
+    }
+    if (files == 0) {
+        log.error("Empty FIT file: {}", path);
+        return false;
+    }
+    return true;
+}
+
+/* header, records and CRC of one (of possibly chained) file */
+bool FitReader::read_file(Handler& handler) {
+    if (!ensure(1) || !ensure(static_cast<uint8_t>(buffer_[pos_]))) {
+        log.error("Truncated file header");
+        return false;
+    }
+    size_t header_size = static_cast<uint8_t>(buffer_[pos_]);
+    if (header_size < consts::min_header_size) {
+        log.error("Invalid file header size: {}", header_size);
+        return false;
+    }
+    crc_ = 0;
+    const uint8_t* header = take(header_size);
+    if (std::memcmp(header + 8, consts::signature.data(), consts::signature.size()) != 0) {
+        log.error("Missing .FIT signature");
+        return false;
+    }
+    uint32_t data_size = static_cast<uint32_t>(read_raw(header + 4, 4, false));
+    if (header_size >= consts::header_size_with_crc) {
+        uint16_t header_crc = static_cast<uint16_t>(read_raw(header + 12, 2, false));
+        if (header_crc != 0 && header_crc != crc_update(0, {header, 12})) {
+            log.error("File header CRC mismatch");
+            return false;
+        }
+    }
+
+    definitions_ = {};
+    last_timestamp_ = 0;
+
+    size_t records_start = taken_;
+    while (taken_ - records_start < data_size) {
+        if (!ensure(1)) {
+            log.error("Truncated file, {} of {} bytes of records", taken_ - records_start, data_size);
+            return false;
+        }
+        uint8_t record_header = *take(1);
+
+        bool ok = true;
+        if (record_header & consts::header::compressed_timestamp) {
+            uint32_t offset = record_header & consts::header::compressed_time_offset;
+            uint32_t timestamp = (last_timestamp_ & ~uint32_t{consts::header::compressed_time_offset}) + offset;
+            if (offset < (last_timestamp_ & consts::header::compressed_time_offset)) {
+                timestamp += consts::header::compressed_time_offset + 1; // rolled over
+            }
+            last_timestamp_ = timestamp;
+            const auto& definition = definitions_[(record_header & consts::header::compressed_local_type) >> 5];
+            ok = read_data(definition, true, timestamp, handler);
+        } else if (record_header & consts::header::definition) {
+            ok = read_definition(record_header, handler);
+        } else {
+            ok = read_data(definitions_[record_header & consts::header::local_type], false, 0, handler);
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+
+    if (!ensure(consts::crc_size)) {
+        log.error("Missing file CRC");
+        return false;
+    }
+    uint16_t expected_crc = crc_;
+    const uint8_t* crc = take(consts::crc_size);
+    if (static_cast<uint16_t>(read_raw(crc, consts::crc_size, false)) != expected_crc) {
+        log.warning("File CRC mismatch, file may be corrupted");
+    }
+    return true;
+}
+
+bool FitReader::read_definition(uint8_t header, Handler& handler) {
+    if (!ensure(5)) {
+        log.error("Truncated definition message");
+        return false;
+    }
+    const uint8_t* fixed = take(5); // reserved, architecture, global message number, field count
+    definition_t& definition = definitions_[header & consts::header::local_type];
+    definition = definition_t{};
+    definition.defined = true;
+    definition.big_endian = fixed[1] == 1;
+    definition.message = static_cast<uint16_t>(read_raw(fixed + 2, 2, definition.big_endian));
+    definition.accepted = handler.accept(definition.message);
+
+    size_t field_count = fixed[4];
+    if (!ensure(field_count * 3)) {
+        log.error("Truncated definition message");
+        return false;
+    }
+    const uint8_t* fields = take(field_count * 3);
+    for (size_t i = 0; i < field_count; ++i) {
+        field_definition_t field{fields[3 * i], fields[3 * i + 1], fields[3 * i + 2]};
+        if (field.number == timestamp_field && field.size == 4) {
+            definition.timestamp_offset = definition.size;
+        }
+        definition.size += field.size;
+        definition.fields.push_back(field);
+    }
+
+    if (header & consts::header::developer_data) {
+        if (!ensure(1)) {
+            log.error("Truncated definition message");
+            return false;
+        }
+        size_t developer_count = static_cast<uint8_t>(*take(1));
+        if (!ensure(developer_count * 3)) {
+            log.error("Truncated definition message");
+            return false;
+        }
+        const uint8_t* developer_fields = take(developer_count * 3);
+        for (size_t i = 0; i < developer_count; ++i) {
+            definition.size += developer_fields[3 * i + 1]; // skipped, only size matters
+        }
+    }
+    return true;
+}
+
+/* compressed - timestamp comes from compressed timestamp record header */
+bool FitReader::read_data(const definition_t& definition, bool compressed, uint32_t timestamp, Handler& handler) {
+    if (!definition.defined) {
+        log.error("Data message without definition");
+        return false;
+    }
+    if (!ensure(definition.size)) {
+        log.error("Truncated data message");
+        return false;
+    }
+    const uint8_t* data = take(definition.size);
+
+    if (definition.timestamp_offset != SIZE_MAX) {
+        uint32_t field = static_cast<uint32_t>(read_raw(data + definition.timestamp_offset, 4, definition.big_endian));
+        if (field != 0xFFFFFFFF) {
+            last_timestamp_ = field;
+        }
+    }
+    if (!definition.accepted) {
+        return true;
+    }
+
+    fields_.clear();
+    size_t offset = 0;
+    for (const auto& field : definition.fields) {
+        uint8_t base = field.base_type & 0x1F;
+        if (base < std::size(base_types) && field.size == base_types[base].size) {
+            double value = 0.0;
+            if (decode(data + offset, base_types[base], definition.big_endian, value)) {
+                fields_.push_back({field.number, value});
+            }
+        }
+        offset += field.size;
+    }
+    if (compressed && definition.timestamp_offset == SIZE_MAX) {
+        fields_.push_back({timestamp_field, static_cast<double>(timestamp)});
+    }
+
+    handler.on_message(definition.message, fields_);
+    return true;
+}
+
+bool FitReader::ensure(size_t size) {
+    while (buffer_.size() - pos_ < size && !eof_) {
+        buffer_.erase(0, pos_);
+        pos_ = 0;
+        size_t old_size = buffer_.size();
+        buffer_.resize(old_size + chunk_size_);
+        in_.read(buffer_.data() + old_size, static_cast<std::streamsize>(chunk_size_));
+        size_t read = static_cast<size_t>(in_.gcount());
+        buffer_.resize(old_size + read);
+        eof_ = (read < chunk_size_);
+    }
+    return buffer_.size() - pos_ >= size;
+}
+
+const uint8_t* FitReader::take(size_t size) {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer_.data()) + pos_;
+    pos_ += size;
+    taken_ += size;
+    crc_ = crc_update(crc_, {data, size});
+    return data;
+}
+
+} // namespace track
+} // namespace telemetry
@@ -0,0 +1,97 @@
+#ifndef FIT_READER_H
+#define FIT_READER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "backend/utils/logging/logger.h"
+
+namespace telemetry {
+namespace track {
+
+/* Streaming decoder of FIT (Garmin Flexible and Interoperable data Transfer) files.
+ *
+ * Knows only the protocol, not the profile - every data message of a type
+ * accepted by the handler is reported with its numeric fields as raw values
+ * (before scale and offset of the profile). Compressed timestamp headers are
+ * expanded into the timestamp field. Strings, arrays, invalid values and
+ * developer fields never reach the handler - their bytes are stepped over
+ * using the definition.
+ *
+ * File is read in fixed size chunks, memory use is one chunk plus message
+ * definitions. Header and file CRCs are verified, chained files (several FIT
+ * files concatenated) are read one after another. */
+class FitReader {
+public:
+    static constexpr uint8_t timestamp_field = 253; // seconds since FIT epoch, in any message
+    static constexpr int64_t epoch_offset = 631065600; // FIT epoch (1989-12-31T00:00:00Z) in unix seconds
+
+    struct field_t {
+        uint8_t number;
+        double value;
+    };
+
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+
+        /* whether messages with given global number are reported, asked once per definition */
+        virtual bool accept(uint16_t message) = 0;
+        virtual void on_message(uint16_t message, std::span<const field_t> fields) = 0;
+    };
+
+    FitReader(size_t chunk_size = 1 << 20);
+    ~FitReader() = default;
+
+    bool read(const std::string& path, Handler& handler);
+
+private:
+    struct field_definition_t {
+        uint8_t number;
+        uint8_t size;
+        uint8_t base_type;
+    };
+
+    struct definition_t {
+        bool defined = false;
+        bool big_endian = false;
+        bool accepted = false;
+        uint16_t message = 0;
+        size_t size = 0;                 // of data message content
+        size_t timestamp_offset = SIZE_MAX; // of timestamp field within content, SIZE_MAX if none
+        std::vector<field_definition_t> fields;
+    };
+
+    bool read_file(Handler& handler);
+    bool read_definition(uint8_t header, Handler& handler);
+    bool read_data(const definition_t& definition, bool compressed, uint32_t timestamp, Handler& handler);
+
+    /* at least size unconsumed bytes in buffer, false at end of file */
+    bool ensure(size_t size);
+    /* consumes bytes (and adds them to CRC), valid until next ensure() */
+    const uint8_t* take(size_t size);
+
+    mutable utils::logging::Logger log{"fit_reader"};
+
+    size_t chunk_size_;
+    std::ifstream in_;
+    std::string buffer_;
+    size_t pos_ = 0;
+    bool eof_ = false;
+
+    uint16_t crc_ = 0;
+    size_t taken_ = 0;
+    uint32_t last_timestamp_ = 0;
+    std::array<definition_t, 16> definitions_; // by local message type
+    std::vector<field_t> fields_;
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // FIT_READER_H
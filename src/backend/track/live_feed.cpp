@@ -0,0 +1,190 @@
+#include "live_feed.h"
+
+#include <cmath>
+
+#include "csv_reader.h"
+#include "xml_stream_reader.h"
+
+namespace telemetry {
+namespace track {
+namespace consts {
+    namespace live {
+        constexpr size_t chunk_size = 64 * 1024;       // appended data is small, read as it comes
+        constexpr size_t max_batch_values = 1 << 20;   // published even if input does not pause (catching up)
+    }
+}
+
+LiveFeed::LiveFeed(std::string path, Format format, trkpt_parser_t trkpt_parser)
+    : path_(std::move(path)), format_(format), trkpt_parser_(std::move(trkpt_parser)),
+      batch_(std::make_unique<batch_t>()) {
+}
+
+LiveFeed::~LiveFeed() {
+    stop_.request_stop();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    delete published_.exchange(nullptr);
+}
+
+bool LiveFeed::start() {
+    input_ = std::make_unique<FileTail>(path_, true, stop_.get_token());
+    if (!input_->open()) {
+        return false;
+    }
+    input_->set_idle_callback([this]() { publish(); });
+
+    thread_ = std::jthread([this]() {
+        log.info("Following live track: {}", path_);
+        bool ok = (format_ == Format::Csv) ? run_csv() : run_gpx();
+        if (!ok) {
+            log.error("Live track feed failed, no more trackpoints will be added: {}", path_);
+            publish(); // trackpoints parsed before the failure
+        }
+        ended_ = true;
+        { std::lock_guard<std::mutex> lock(wait_mutex_); }
+        wait_cv_.notify_all();
+    });
+    return true;
+}
+
+std::unique_ptr<LiveFeed::batch_t> LiveFeed::take() {
+    return std::unique_ptr<batch_t>(published_.exchange(nullptr));
+}
+
+std::unique_ptr<LiveFeed::batch_t> LiveFeed::wait(std::chrono::milliseconds timeout) {
+    {
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        wait_cv_.wait_for(lock, timeout, [this]() { return published_.load() != nullptr || ended_; });
+    }
+    return take();
+}
+
+/* trackpoints of trkseg elements as they are completed, metadata and track name/src/type as raw elements */
+bool LiveFeed::run_gpx() {
+    class GpxHandler : public XmlStreamReader::Handler {
+    public:
+        GpxHandler(LiveFeed& feed) : feed_(feed) {}
+
+        bool on_start(std::string_view name, size_t depth) override {
+            if (depth == 0) {
+                root_ok_ = (name == "gpx");
+                return false;
+            }
+            if (!root_ok_) {
+                return false;
+            }
+
+            if (depth == 1) {
+                in_trk_ = (name == "trk");
+                return name == "metadata";
+            }
+            if (depth == 2 && in_trk_) {
+                in_trkseg_ = (name == "trkseg");
+                return name == "name" || name == "src" || name == "type";
+            }
+            return depth == 3 && in_trkseg_ && name == "trkpt";
+        }
+
+        void on_fragment(std::string_view name, std::string_view fragment, size_t depth) override {
+            auto& batch = *feed_.batch_;
+            if (depth != 3) {
+                batch.elements.emplace_back(name, fragment);
+                return;
+            }
+
+            pugi::xml_parse_result result = doc_.load_buffer(fragment.data(), fragment.size());
+            if (!result) {
+                feed_.log.error("Failed to parse <trkpt> element: {}", result.description());
+                return;
+            }
+            feed_.trkpt_parser_(doc_.first_child(), batch.chunk);
+            if (batch.chunk.size() >= consts::live::max_batch_values) {
+                feed_.publish();
+            }
+        }
+
+        void on_end(std::string_view name, size_t depth) override {
+            if (depth == 1 && name == "trk") {
+                in_trk_ = false;
+            } else if (depth == 2 && name == "trkseg") {
+                in_trkseg_ = false;
+            }
+        }
+
+    private:
+        LiveFeed& feed_;
+        pugi::xml_document doc_;
+        bool root_ok_ = false;
+        bool in_trk_ = false;
+        bool in_trkseg_ = false;
+    };
+
+    GpxHandler handler(*this);
+    XmlStreamReader reader(consts::live::chunk_size);
+    return reader.read(*input_, handler) || input_->stopped();
+}
+
+/* rows of the series are moved into the batch whenever input pauses */
+bool LiveFeed::run_csv() {
+    CsvReader::series_t series;
+    input_->set_idle_callback([this, &series]() {
+        auto& chunk = batch_->chunk;
+        std::vector<uint32_t> keys;
+        for (const auto& name : series.names) {
+            keys.push_back(chunk.key_index(name, TrackpointStore::ColumnType::Double));
+        }
+        batch_->absolute_time = series.absolute_time;
+
+        for (size_t row = 0; row < series.timestamps.size(); ++row) {
+            time::microseconds_t timestamp = series.timestamps[row];
+            for (size_t column = 0; column < series.columns.size(); ++column) {
+                double value = series.columns[column][row];
+                if (!std::isnan(value)) {
+                    chunk.add(timestamp, keys[column], value);
+                }
+            }
+            time::time_point_t row_time{std::chrono::microseconds(timestamp)};
+            if (series.absolute_time && (chunk.start_time == time::INVALID_TIME_POINT || row_time < chunk.start_time)) {
+                chunk.start_time = row_time;
+            }
+        }
+
+        // capacity is kept for the next rows
+        series.timestamps.clear();
+        for (auto& column : series.columns) {
+            column.clear();
+        }
+        publish();
+    });
+
+    CsvReader reader(consts::live::chunk_size);
+    return reader.read(*input_, series) || input_->stopped();
+}
+
+void LiveFeed::publish() {
+    if (batch_->chunk.size() == 0) {
+        return; // elements wait for the first trackpoints
+    }
+
+    std::unique_ptr<batch_t> batch(published_.exchange(nullptr));
+    if (batch) {
+        // not taken yet - reader never sees it again until it is published once more
+        batch->chunk.append(batch_->chunk);
+        batch->elements.insert(batch->elements.end(), batch_->elements.begin(), batch_->elements.end());
+        batch->absolute_time = batch_->absolute_time;
+        batch_->chunk.clear();
+        batch_->elements.clear();
+    } else {
+        batch = std::move(batch_);
+        batch_ = std::make_unique<batch_t>();
+        batch_->absolute_time = batch->absolute_time;
+    }
+    published_.store(batch.release());
+
+    { std::lock_guard<std::mutex> lock(wait_mutex_); }
+    wait_cv_.notify_all();
+}
+
+} // namespace track
+} // namespace telemetry
@@ -0,0 +1,96 @@
+#ifndef LIVE_FEED_H
+#define LIVE_FEED_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <pugixml.hpp>
+
+#include "backend/utils/logging/logger.h"
+#include "file_tail.h"
+#include "trackpoint_chunk.h"
+
+namespace telemetry {
+namespace track {
+
+/* Follows a track file that is still being written (e.g. by a logger on the
+ * same machine) - growing file or named pipe, GPX or CSV time series (.csv,
+ * time in first column as in custom series).
+ *
+ * Content is read and parsed on a background thread, parsed trackpoints are
+ * published in batches whenever the input has no more data for the moment.
+ * Publishing is a single atomic pointer swap of a complete batch, the reader
+ * takes it with another swap - neither side ever waits for the other, and a
+ * batch is never touched by the feed once published. A batch the reader has
+ * not taken yet is extended by the feed (taken back with a swap too). */
+class LiveFeed {
+public:
+    enum class Format {
+        Gpx,
+        Csv, // value columns become trackpoint fields
+    };
+
+    struct batch_t {
+        // trackpoints in document order - microseconds since epoch, or since track start if absolute_time is false
+        TrackpointChunk chunk;
+        bool absolute_time = true;
+        // raw text of GPX <metadata> and track name/src/type elements, by element name, in document order
+        std::vector<std::pair<std::string, std::string>> elements;
+    };
+
+    /* parses trkpt into chunk with timestamps in microseconds since epoch, called on the feed thread */
+    using trkpt_parser_t = std::function<bool(pugi::xml_node node, TrackpointChunk& chunk)>;
+
+    LiveFeed(std::string path, Format format, trkpt_parser_t trkpt_parser);
+    /* stops and joins the feed thread */
+    ~LiveFeed();
+
+    /* opens input and starts the feed thread */
+    bool start();
+
+    /* batch published since previous call, nullptr if there is none - never blocks */
+    std::unique_ptr<batch_t> take();
+    /* waits until a batch is published, nullptr on timeout or if the feed ended without one */
+    std::unique_ptr<batch_t> wait(std::chrono::milliseconds timeout);
+
+private:
+    bool run_gpx();
+    bool run_csv();
+    /* hands pending trackpoints over to the reader, merged into batch not taken yet */
+    void publish();
+
+    mutable utils::logging::Logger log{"live_feed"};
+
+    std::string path_;
+    Format format_;
+    trkpt_parser_t trkpt_parser_;
+    std::unique_ptr<FileTail> input_;
+
+    std::unique_ptr<batch_t> batch_; // being filled by the feed thread
+    std::atomic<batch_t*> published_{nullptr};
+
+    // only for wait()
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+    std::atomic<bool> ended_{false};
+
+    std::stop_source stop_;
+    std::jthread thread_;
+
+    LiveFeed(const LiveFeed&) = delete;
+    LiveFeed& operator=(const LiveFeed&) = delete;
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // LIVE_FEED_H
@@ -0,0 +1,164 @@
+#include "min_max_pyramid.h"
+
+#include <algorithm>
+#include <array>
+
+namespace telemetry {
+namespace track {
+
+MinMaxPyramid::MinMaxPyramid(const TrackpointStore& store, size_t column) : store_(store), column_(column) {
+    min_levels_.emplace_back();
+    max_levels_.emplace_back();
+    extend();
+}
+
+void MinMaxPyramid::extend() {
+    size_t first = min_levels_[0].size(); // first changed run of current level
+    size_t count = store_.size();
+
+    min_levels_[0].resize(count, none);
+    max_levels_[0].resize(count, none);
+    for (size_t i = first; i < count; ++i) {
+        if (store_.is_valid(column_, i)) {
+            min_levels_[0][i] = static_cast<uint32_t>(i);
+            max_levels_[0][i] = static_cast<uint32_t>(i);
+        }
+    }
+
+    // last run of a level may be shorter
+    for (size_t level = 1; min_levels_[level - 1].size() > 1; ++level) {
+        if (level == min_levels_.size()) {
+            min_levels_.emplace_back();
+            max_levels_.emplace_back();
+        }
+        const auto& prev_min = min_levels_[level - 1];
+        const auto& prev_max = max_levels_[level - 1];
+        auto& level_min = min_levels_[level];
+        auto& level_max = max_levels_[level];
+        size_t size = (prev_min.size() + 1) / 2;
+        level_min.resize(size, none);
+        level_max.resize(size, none);
+        first /= 2;
+        for (size_t j = first; j < size; ++j) {
+            uint32_t left_min = prev_min[2 * j];
+            uint32_t left_max = prev_max[2 * j];
+            uint32_t right_min = (2 * j + 1 < prev_min.size()) ? prev_min[2 * j + 1] : none;
+            uint32_t right_max = (2 * j + 1 < prev_max.size()) ? prev_max[2 * j + 1] : none;
+
+            if (left_min == none || (right_min != none && value(right_min) < value(left_min))) {
+                level_min[j] = right_min;
+            } else {
+                level_min[j] = left_min;
+            }
+            if (left_max == none || (right_max != none && value(right_max) > value(left_max))) {
+                level_max[j] = right_max;
+            } else {
+                level_max[j] = left_max;
+            }
+        }
+    }
+}
+
+MinMaxPyramid::extremes_t MinMaxPyramid::get(size_t first, size_t last) const {
+    extremes_t extremes;
+    size_t count = min_levels_[0].size();
+    if (count == 0 || first > last || first >= count) {
+        return extremes;
+    }
+    last = std::min(last, count - 1);
+
+    // runs [begin, end) of current level still to be covered, whole runs at the edges are taken
+    size_t begin = first;
+    size_t end = last + 1;
+    for (size_t level = 0; begin < end; ++level) {
+        if (begin & 1) {
+            merge(extremes, level, begin++);
+        }
+        if (end & 1) {
+            merge(extremes, level, --end);
+        }
+        begin >>= 1;
+        end >>= 1;
+    }
+    return extremes;
+}
+
+MinMaxPyramid::extremes_t MinMaxPyramid::get(time::microseconds_t from, time::microseconds_t to) const {
+    if (from > to) {
+        return {};
+    }
+    size_t before_first = store_.floor_index(from - 1);
+    size_t last = store_.floor_index(to);
+    if (last == TrackpointStore::npos) {
+        return {};
+    }
+    return get(before_first == TrackpointStore::npos ? 0 : before_first + 1, last);
+}
+
+std::vector<size_t> MinMaxPyramid::envelope(size_t first, size_t last, size_t buckets) const {
+    std::vector<size_t> indexes;
+    size_t count = min_levels_[0].size();
+    if (count == 0 || first > last || first >= count) {
+        return indexes;
+    }
+    last = std::min(last, count - 1);
+
+    size_t samples = last - first + 1;
+    if (buckets == 0 || samples <= 4 * buckets) {
+        // nothing to decimate
+        for (size_t i = first; i <= last; ++i) {
+            indexes.push_back(i);
+        }
+        return indexes;
+    }
+
+    indexes.reserve(4 * buckets);
+    for (size_t b = 0; b < buckets; ++b) {
+        size_t begin = first + b * samples / buckets;
+        size_t end = first + (b + 1) * samples / buckets - 1;
+        extremes_t extremes = get(begin, end);
+
+        std::array<size_t, 4> outline = {begin, extremes.min_index, extremes.max_index, end};
+        std::sort(outline.begin(), outline.end()); // npos (no valid sample) sorts last
+        for (size_t index : outline) {
+            if (index != npos && (indexes.empty() || indexes.back() != index)) {
+                indexes.push_back(index);
+            }
+        }
+    }
+    return indexes;
+}
+
+double MinMaxPyramid::value(size_t index) const {
+    return store_.value(column_, index);
+}
+
+size_t MinMaxPyramid::size() const {
+    return min_levels_[0].size();
+}
+
+time::microseconds_t MinMaxPyramid::timestamp(size_t index) const {
+    return store_.timestamps()[index];
+}
+
+size_t MinMaxPyramid::memory_usage() const {
+    size_t bytes = 0;
+    for (size_t k = 0; k < min_levels_.size(); ++k) {
+        bytes += (min_levels_[k].size() + max_levels_[k].size()) * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+void MinMaxPyramid::merge(extremes_t& extremes, size_t level, size_t run) const {
+    uint32_t min_index = min_levels_[level][run];
+    uint32_t max_index = max_levels_[level][run];
+    if (min_index != none && (extremes.min_index == npos || value(min_index) < value(extremes.min_index))) {
+        extremes.min_index = min_index;
+    }
+    if (max_index != none && (extremes.max_index == npos || value(max_index) > value(extremes.max_index))) {
+        extremes.max_index = max_index;
+    }
+}
+
+} // namespace track
+} // namespace telemetry
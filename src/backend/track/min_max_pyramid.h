@@ -0,0 +1,70 @@
+#ifndef MIN_MAX_PYRAMID_H
+#define MIN_MAX_PYRAMID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "backend/utils/time.h"
+#include "trackpoint_store.h"
+
+namespace telemetry {
+namespace track {
+
+/* Min/max decimation pyramid over samples of one trackpoint column.
+ *
+ * Level k holds the index of the minimal and maximal valid sample of every
+ * aligned run [j * 2^k, (j + 1) * 2^k) of samples, so about 2n indexes per
+ * extreme in total. Extremes of any sample range are combined from at most
+ * two runs per level - O(log n). Rows without a valid value are never an
+ * extreme. Rows appended to the store later (live track) only update runs
+ * containing them - the last run of each level - O(log n) per appended row. */
+class MinMaxPyramid {
+public:
+    static constexpr size_t npos = TrackpointStore::npos;
+
+    struct extremes_t {
+        size_t min_index = npos; // npos if there is no valid sample
+        size_t max_index = npos;
+    };
+
+    MinMaxPyramid(const TrackpointStore& store, size_t column);
+    ~MinMaxPyramid() = default;
+
+    /* extremes of valid samples with index in [first, last] */
+    extremes_t get(size_t first, size_t last) const;
+    /* extremes of valid samples with timestamp in [from, to] */
+    extremes_t get(time::microseconds_t from, time::microseconds_t to) const;
+
+    /* indexes (ascending, unique) of samples outlining [first, last] split into
+     * `buckets` equal runs - first, min, max and last sample of each run, so a
+     * line through them keeps every run's extent; O(buckets * log n) */
+    std::vector<size_t> envelope(size_t first, size_t last, size_t buckets) const;
+
+    double value(size_t index) const;
+    /* indexes are of samples of the store the pyramid was built from (own store of a custom series,
+     * not track trackpoints) - count of samples and their timestamps */
+    size_t size() const;
+    time::microseconds_t timestamp(size_t index) const;
+
+    /* adds trackpoints appended to the store since construction or previous call */
+    void extend();
+
+    size_t memory_usage() const;
+
+private:
+    static constexpr uint32_t none = UINT32_MAX;
+
+    void merge(extremes_t& extremes, size_t level, size_t run) const;
+
+    const TrackpointStore& store_;
+    size_t column_;
+
+    std::vector<std::vector<uint32_t>> min_levels_; // none for runs without valid sample
+    std::vector<std::vector<uint32_t>> max_levels_;
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // MIN_MAX_PYRAMID_H
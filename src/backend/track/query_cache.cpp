@@ -0,0 +1,113 @@
+#include "query_cache.h"
+
+#include <bit>
+
+namespace telemetry {
+namespace track {
+namespace consts {
+    constexpr size_t min_cache_slot_count = 64;
+    constexpr uint32_t max_generation = UINT32_MAX >> 1;
+}
+
+namespace {
+    uint32_t claimed(uint32_t generation) {
+        return generation << 1;
+    }
+
+    uint32_t published(uint32_t generation) {
+        return (generation << 1) | 1;
+    }
+}
+
+QueryCache::QueryCache()
+        : entries_(std::make_unique<entry_t[]>(consts::min_cache_slot_count)), size_(consts::min_cache_slot_count) {
+}
+
+/* queries of previous frame finished, table is only touched by this thread */
+void QueryCache::begin_frame(time::microseconds_t timestamp) {
+    timestamp_ = timestamp;
+    // stores were skipped when more than half was used - keep load factor at most 1/2
+    if (used_.load(std::memory_order_relaxed) * 2 >= size_) {
+        size_ *= 2;
+        entries_ = std::make_unique<entry_t[]>(size_);
+    }
+    used_.store(0, std::memory_order_relaxed);
+
+    if (++generation_ > consts::max_generation) { // wrapped around, old generations could look current again
+        for (size_t i = 0; i < size_; ++i) {
+            entries_[i].state.store(0, std::memory_order_relaxed);
+        }
+        generation_ = 1;
+    }
+}
+
+bool QueryCache::find(field_id_t field_id, time::microseconds_t timestamp, Value& value,
+                      time::microseconds_t& valid_until) const {
+    if (timestamp != timestamp_ || timestamp == time::INVALID_TIME) {
+        return false;
+    }
+    size_t mask = size_ - 1;
+    size_t slot = first_slot(field_id);
+    for (size_t probe = 0; probe < size_; ++probe, slot = (slot + 1) & mask) {
+        const entry_t& entry = entries_[slot];
+        uint32_t state = entry.state.load(std::memory_order_acquire);
+        if (state == published(generation_)) {
+            if (entry.field_id.load(std::memory_order_relaxed) != field_id) {
+                continue;
+            }
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            value = entry.value;
+            valid_until = entry.valid_until;
+            return true;
+        }
+        if (state != claimed(generation_)) {
+            break; // empty - end of probe sequence
+        }
+        // being filled, field not known yet - a miss if it is this field
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void QueryCache::store(field_id_t field_id, time::microseconds_t timestamp, const Value& value,
+                       time::microseconds_t valid_until) {
+    if (timestamp != timestamp_ || timestamp == time::INVALID_TIME) {
+        return;
+    }
+    size_t mask = size_ - 1;
+    size_t slot = first_slot(field_id);
+    for (size_t probe = 0; probe < size_; ++probe, slot = (slot + 1) & mask) {
+        entry_t& entry = entries_[slot];
+        uint32_t state = entry.state.load(std::memory_order_acquire);
+        while (state != claimed(generation_) && state != published(generation_)) {
+            if (used_.fetch_add(1, std::memory_order_relaxed) * 2 >= size_) {
+                return; // full for this frame, grown by next begin_frame
+            }
+            if (entry.state.compare_exchange_strong(state, claimed(generation_), std::memory_order_acquire)) {
+                entry.field_id.store(field_id, std::memory_order_relaxed);
+                entry.value = value;
+                entry.valid_until = valid_until;
+                entry.state.store(published(generation_), std::memory_order_release);
+                return;
+            }
+            used_.fetch_sub(1, std::memory_order_relaxed); // claimed by another thread meanwhile
+        }
+        if (state == published(generation_) && entry.field_id.load(std::memory_order_relaxed) == field_id) {
+            return; // stored by another thread
+        }
+        // claimed slot may hold this field too, a duplicate further on is only found after it
+    }
+}
+
+QueryCache::stats_t QueryCache::stats() const {
+    return {hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed)};
+}
+
+/* start of probe sequence of field_id */
+size_t QueryCache::first_slot(field_id_t field_id) const {
+    // fibonacci hashing - ids differ mostly in low bits and in segment bits, take top bits of the product
+    return static_cast<size_t>((field_id * 0x9E3779B97F4A7C15u) >> (64 - std::countr_zero(size_)));
+}
+
+} // namespace track
+} // namespace telemetry
@@ -0,0 +1,72 @@
+#ifndef QUERY_CACHE_H
+#define QUERY_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "backend/utils/time.h"
+#include "field_handle.h"
+#include "value.h"
+
+namespace telemetry {
+namespace track {
+
+/* Memo of field values queried at the current frame timestamp.
+ *
+ * All parameters of a layout are updated for the same frame timestamp,
+ * partly from the layout traversal and partly from drawing workers, so
+ * each field only has to be resolved once per frame. Queries at other
+ * timestamps (e.g. chart value sweeps) bypass the cache.
+ *
+ * Open addressing keyed by field id, lock free - an entry is claimed with
+ * a compare-and-swap of its state, filled and then published, and is not
+ * changed again during the frame. Readers only take published entries.
+ * Entries of previous frames are dropped in O(1) by bumping the frame
+ * generation. Table size is fixed within a frame (stores are skipped
+ * once it is half full) and doubled at the next begin_frame. */
+class QueryCache {
+public:
+    struct stats_t {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    QueryCache();
+    ~QueryCache() = default;
+
+    /* invalidates all entries, only queries at timestamp are cached until next call - no query may run meanwhile */
+    void begin_frame(time::microseconds_t timestamp);
+
+    /* false on miss or if timestamp is not the frame timestamp */
+    bool find(field_id_t field_id, time::microseconds_t timestamp, Value& value, time::microseconds_t& valid_until) const;
+    void store(field_id_t field_id, time::microseconds_t timestamp, const Value& value, time::microseconds_t valid_until);
+
+    /* counted since construction, bypassed queries are not counted */
+    stats_t stats() const;
+
+private:
+    struct entry_t {
+        std::atomic<uint32_t> state{0}; // generation << 1, | 1 once published - empty unless of current generation
+        std::atomic<field_id_t> field_id{INVALID_FIELD};
+        Value value;
+        time::microseconds_t valid_until = 0;
+    };
+
+    size_t first_slot(field_id_t field_id) const;
+
+    std::unique_ptr<entry_t[]> entries_;
+    size_t size_; // power of two
+    std::atomic<size_t> used_{0};
+    uint32_t generation_ = 1;
+    time::microseconds_t timestamp_ = time::INVALID_TIME; // changed only between frames
+
+    mutable std::atomic<uint64_t> hits_{0};
+    mutable std::atomic<uint64_t> misses_{0};
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // QUERY_CACHE_H
@@ -0,0 +1,229 @@
+#include "race_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+namespace telemetry {
+namespace track {
+namespace consts {
+    constexpr double earth_radius_m = 6371008.8; // mean
+}
+
+namespace {
+    /* great circle distance in meters */
+    double haversine(double lat1, double lon1, double lat2, double lon2) {
+        constexpr double rad = std::numbers::pi / 180.0;
+        double dlat = (lat2 - lat1) * rad;
+        double dlon = (lon2 - lon1) * rad;
+        double a = std::sin(dlat / 2) * std::sin(dlat / 2) +
+                   std::cos(lat1 * rad) * std::cos(lat2 * rad) * std::sin(dlon / 2) * std::sin(dlon / 2);
+        return 2.0 * consts::earth_radius_m * std::asin(std::sqrt(std::min(a, 1.0)));
+    }
+}
+
+RaceIndex::RaceIndex(const TrackpointStore& store, const std::vector<rider_columns_t>& riders) : store_(store) {
+    size_t count = riders.size();
+    for (const auto& columns : riders) {
+        distances_.push_back(resample_distance(columns));
+        const auto& distances = distances_.back();
+        auto first = std::find_if(distances.begin(), distances.end(), [](double d) { return !std::isnan(d); });
+        first_rows_.push_back(first == distances.end() ? TrackpointStore::npos
+                                                       : static_cast<size_t>(std::distance(distances.begin(), first)));
+    }
+
+    order_.resize(count);
+    ranks_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        order_[i] = i;
+        ranks_[i] = i;
+    }
+    current_.assign(count, std::numeric_limits<double>::quiet_NaN());
+    gaps_.assign(count, std::numeric_limits<double>::quiet_NaN());
+    gap_hints_.assign(count, 0);
+}
+
+size_t RaceIndex::rider_count() const {
+    return distances_.size();
+}
+
+/* own samples of the rider only (joined values of other sources are skipped), made non-decreasing,
+ * linearly interpolated by time at the trackpoints in between */
+std::vector<double> RaceIndex::resample_distance(const rider_columns_t& columns) const {
+    size_t count = store_.size();
+    std::vector<double> distances(count, std::numeric_limits<double>::quiet_NaN());
+
+    std::vector<std::pair<size_t, double>> samples; // row, distance
+    double total = 0.0;
+    double lat = 0.0;
+    double lon = 0.0;
+    for (size_t row = 0; row < count; ++row) {
+        if (columns.distance != TrackpointStore::npos) {
+            if (store_.is_sample(columns.distance, row)) {
+                total = std::max(total, store_.value(columns.distance, row));
+                samples.emplace_back(row, total);
+            }
+        } else if (columns.lat != TrackpointStore::npos && columns.lon != TrackpointStore::npos &&
+                   store_.is_sample(columns.lat, row) && store_.is_sample(columns.lon, row)) {
+            double next_lat = store_.value(columns.lat, row);
+            double next_lon = store_.value(columns.lon, row);
+            total += samples.empty() ? 0.0 : haversine(lat, lon, next_lat, next_lon);
+            lat = next_lat;
+            lon = next_lon;
+            samples.emplace_back(row, total);
+        }
+    }
+    if (samples.empty()) {
+        return distances;
+    }
+
+    auto timestamps = store_.timestamps();
+    for (size_t i = 0; i + 1 < samples.size(); ++i) {
+        auto [row0, d0] = samples[i];
+        auto [row1, d1] = samples[i + 1];
+        double span = static_cast<double>(timestamps[row1] - timestamps[row0]);
+        for (size_t row = row0; row < row1; ++row) {
+            double factor = static_cast<double>(timestamps[row] - timestamps[row0]) / span;
+            distances[row] = d0 + factor * (d1 - d0);
+        }
+    }
+    std::fill(distances.begin() + static_cast<std::ptrdiff_t>(samples.back().first), distances.end(), samples.back().second);
+    return distances;
+}
+
+void RaceIndex::update(time::microseconds_t timestamp) {
+    if (timestamp == timestamp_) {
+        return;
+    }
+    timestamp_ = timestamp;
+
+    auto timestamps = store_.timestamps();
+    size_t row = store_.floor_index(timestamp, cursor_);
+    double factor = 0.0;
+    if (row != TrackpointStore::npos && row + 1 < timestamps.size()) {
+        factor = static_cast<double>(timestamp - timestamps[row]) / static_cast<double>(timestamps[row + 1] - timestamps[row]);
+    }
+    for (size_t rider = 0; rider < distances_.size(); ++rider) {
+        if (row == TrackpointStore::npos) {
+            current_[rider] = std::numeric_limits<double>::quiet_NaN();
+            continue;
+        }
+        const auto& distances = distances_[rider];
+        double d0 = distances[row];
+        double d1 = (row + 1 < distances.size()) ? distances[row + 1] : d0;
+        current_[rider] = std::isnan(d1) ? d0 : d0 + factor * (d1 - d0);
+    }
+
+    // insertion sort from previous order - linear unless many riders swapped since last frame
+    auto ahead = [this](size_t a, size_t b) {
+        double da = current_[a];
+        double db = current_[b];
+        if (std::isnan(da) != std::isnan(db)) {
+            return !std::isnan(da);
+        }
+        if (!std::isnan(da) && da != db) {
+            return da > db;
+        }
+        return a < b;
+    };
+    for (size_t i = 1; i < order_.size(); ++i) {
+        size_t rider = order_[i];
+        size_t j = i;
+        for (; j > 0 && ahead(rider, order_[j - 1]); --j) {
+            order_[j] = order_[j - 1];
+        }
+        order_[j] = rider;
+    }
+    for (size_t rank = 0; rank < order_.size(); ++rank) {
+        ranks_[order_[rank]] = rank;
+    }
+
+    if (order_.empty()) {
+        return;
+    }
+    size_t leader = order_.front();
+    if (leader != leader_) {
+        leader_ = leader;
+        std::fill(gap_hints_.begin(), gap_hints_.end(), first_rows_[leader]);
+    }
+    for (size_t rider = 0; rider < distances_.size(); ++rider) {
+        if (std::isnan(current_[rider]) || std::isnan(current_[leader])) {
+            gaps_[rider] = std::numeric_limits<double>::quiet_NaN();
+        } else if (rider == leader) {
+            gaps_[rider] = 0.0;
+        } else {
+            time::microseconds_t reached = time_at_distance(leader, current_[rider], gap_hints_[rider]);
+            gaps_[rider] = std::max(0.0, time::us_to_s(timestamp - reached));
+        }
+    }
+}
+
+size_t RaceIndex::rank(size_t rider) const {
+    return ranks_[rider];
+}
+
+size_t RaceIndex::rider_at(size_t rank) const {
+    return order_[rank];
+}
+
+double RaceIndex::distance(size_t rider) const {
+    return current_[rider];
+}
+
+double RaceIndex::gap(size_t rider) const {
+    return gaps_[rider];
+}
+
+/* first row with distance >= given one is searched by galloping from the hint in either direction,
+ * then binary search within the last step */
+time::microseconds_t RaceIndex::time_at_distance(size_t rider, double distance, size_t& hint) const {
+    const auto& distances = distances_[rider];
+    auto timestamps = store_.timestamps();
+    size_t first = first_rows_[rider];
+    size_t count = distances.size();
+
+    size_t row = std::clamp(hint, first, count - 1);
+    size_t lo = first; // search range [lo, hi)
+    size_t hi = count;
+    if (distances[row] < distance) {
+        size_t step = 1;
+        lo = row + 1;
+        while (row + step < count && distances[row + step] < distance) {
+            lo = row + step + 1;
+            step *= 2;
+        }
+        hi = std::min(row + step + 1, count);
+    } else {
+        size_t step = 1;
+        hi = row + 1;
+        while (row >= first + step && distances[row - step] >= distance) {
+            hi = row - step + 1;
+            step *= 2;
+        }
+        lo = (row >= first + step) ? row - step + 1 : first;
+    }
+    row = static_cast<size_t>(std::distance(distances.begin(),
+        std::lower_bound(distances.begin() + static_cast<std::ptrdiff_t>(lo), distances.begin() + static_cast<std::ptrdiff_t>(hi), distance)));
+    hint = std::min(row, count - 1);
+
+    if (row >= count) {
+        return timestamps.back();
+    }
+    if (row == first || distances[row] == distances[row - 1]) {
+        return timestamps[row];
+    }
+    double factor = (distance - distances[row - 1]) / (distances[row] - distances[row - 1]);
+    return timestamps[row - 1] + static_cast<time::microseconds_t>(factor * static_cast<double>(timestamps[row] - timestamps[row - 1]));
+}
+
+size_t RaceIndex::memory_usage() const {
+    size_t bytes = 0;
+    for (const auto& distances : distances_) {
+        bytes += distances.size() * sizeof(double);
+    }
+    return bytes;
+}
+
+} // namespace track
+} // namespace telemetry
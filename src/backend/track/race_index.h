@@ -0,0 +1,76 @@
+#ifndef RACE_INDEX_H
+#define RACE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "backend/utils/time.h"
+#include "track_cursor.h"
+#include "trackpoint_store.h"
+
+namespace telemetry {
+namespace track {
+
+/* Standings of riders whose trackpoints share one timeline (merged track set).
+ *
+ * Distance covered by each rider is resampled once onto the shared trackpoints
+ * (from its distance column, or summed from its positions), so at a frame all
+ * riders are located with a single cursor. Standings are updated per frame
+ * timestamp: ranking is re-sorted from the previous frame's order (riders
+ * rarely swap between frames, so this is linear), gaps are found by galloping
+ * from the previous position in the leader's distance series.
+ * Not thread safe. */
+class RaceIndex {
+public:
+    /* columns of one rider in the store, distance preferred, position used if distance is npos */
+    struct rider_columns_t {
+        size_t distance = TrackpointStore::npos; // meters
+        size_t lat = TrackpointStore::npos;      // degrees
+        size_t lon = TrackpointStore::npos;
+    };
+
+    RaceIndex(const TrackpointStore& store, const std::vector<rider_columns_t>& riders);
+    ~RaceIndex() = default;
+
+    size_t rider_count() const;
+
+    /* moves standings to given timestamp, no-op if already there */
+    void update(time::microseconds_t timestamp);
+
+    /* 0 based rank of rider (0 - leader), riders without distance yet are ranked last by index */
+    size_t rank(size_t rider) const;
+    /* rider at 0 based rank */
+    size_t rider_at(size_t rank) const;
+    /* meters, NaN before first sample of rider */
+    double distance(size_t rider) const;
+    /* seconds since leader was at rider's distance, NaN before first sample of rider */
+    double gap(size_t rider) const;
+
+    size_t memory_usage() const;
+
+private:
+    std::vector<double> resample_distance(const rider_columns_t& columns) const;
+    /* time (track domain) at which rider reached given distance, hint - row to gallop from */
+    time::microseconds_t time_at_distance(size_t rider, double distance, size_t& hint) const;
+
+    const TrackpointStore& store_;
+
+    // per rider: distance at each trackpoint, NaN before first sample, last value after last sample
+    std::vector<std::vector<double>> distances_;
+    std::vector<size_t> first_rows_; // first trackpoint with distance, npos if none
+
+    time::microseconds_t timestamp_ = time::INVALID_TIME;
+    TrackCursor cursor_;
+    size_t leader_ = SIZE_MAX;
+    std::vector<size_t> order_;        // riders by rank
+    std::vector<size_t> ranks_;        // rank by rider
+    std::vector<double> current_;      // distance by rider at timestamp_
+    std::vector<double> gaps_;         // gap by rider at timestamp_
+    std::vector<size_t> gap_hints_;    // row in leader's distances by rider, reset when leader changes
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // RACE_INDEX_H
@@ -0,0 +1,197 @@
+#include "segment_index.h"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+
+namespace telemetry {
+namespace track {
+
+namespace {
+    std::atomic<uint64_t> next_index_id{1};
+}
+
+thread_local SegmentIndex::lookup_cache_t SegmentIndex::lookup_cache_;
+
+void SegmentIndex::build(std::vector<interval_t> intervals) {
+    id_ = next_index_id.fetch_add(1);
+
+    // stable sorts keep segment id order for equal times
+    std::stable_sort(intervals.begin(), intervals.end(),
+                     [](const interval_t& a, const interval_t& b) {
+                         return a.end < b.end;
+                     });
+    ends_.clear();
+    by_end_.clear();
+    for (const auto& interval : intervals) {
+        ends_.push_back(interval.end);
+        by_end_.push_back(interval.segment);
+    }
+
+    std::stable_sort(intervals.begin(), intervals.end(),
+                     [](const interval_t& a, const interval_t& b) {
+                         return a.start < b.start;
+                     });
+    starts_.clear();
+    by_start_.clear();
+    for (const auto& interval : intervals) {
+        starts_.push_back(interval.start);
+        by_start_.push_back(interval.segment);
+    }
+
+    // active set only changes at segment start and right after segment end
+    boundaries_.clear();
+    for (const auto& interval : intervals) {
+        boundaries_.push_back(interval.start);
+        boundaries_.push_back(interval.end + 1);
+    }
+    std::sort(boundaries_.begin(), boundaries_.end());
+    boundaries_.erase(std::unique(boundaries_.begin(), boundaries_.end()), boundaries_.end());
+
+    // positions in start order, ordered by end - for removing segments from running active set
+    std::vector<uint32_t> end_order(intervals.size());
+    std::iota(end_order.begin(), end_order.end(), 0);
+    std::stable_sort(end_order.begin(), end_order.end(),
+                     [&intervals](uint32_t a, uint32_t b) {
+                         return intervals[a].end < intervals[b].end;
+                     });
+
+    // single sweep over boundaries - running active set holds positions in start order, so it stays
+    // sorted by appending at segment start and erasing after segment end
+    std::vector<uint32_t> running;
+    size_t next_start = 0;
+    size_t next_end = 0;
+    active_offsets_.assign(1, 0);
+    active_.clear();
+    for (auto boundary : boundaries_) {
+        for (; next_end < end_order.size() && intervals[end_order[next_end]].end < boundary; ++next_end) {
+            auto it = std::lower_bound(running.begin(), running.end(), end_order[next_end]);
+            if (it != running.end() && *it == end_order[next_end]) {
+                running.erase(it);
+            }
+        }
+        for (; next_start < intervals.size() && intervals[next_start].start <= boundary; ++next_start) {
+            // segments ending before they start are never active
+            if (boundary <= intervals[next_start].end) {
+                running.push_back(static_cast<uint32_t>(next_start));
+            }
+        }
+        for (uint32_t position : running) {
+            active_.push_back(intervals[position].segment);
+        }
+        active_offsets_.push_back(static_cast<uint32_t>(active_.size()));
+    }
+
+    arrays_ = arrays_t{starts_, by_start_, ends_, by_end_, boundaries_, active_offsets_, active_};
+}
+
+void SegmentIndex::attach(const arrays_t& arrays) {
+    id_ = next_index_id.fetch_add(1);
+
+    starts_.clear();
+    by_start_.clear();
+    ends_.clear();
+    by_end_.clear();
+    boundaries_.clear();
+    active_offsets_.clear();
+    active_.clear();
+
+    arrays_ = arrays;
+}
+
+const SegmentIndex::arrays_t& SegmentIndex::arrays() const {
+    return arrays_;
+}
+
+size_t SegmentIndex::size() const {
+    return arrays_.starts.size();
+}
+
+size_t SegmentIndex::active_count(time::microseconds_t timestamp) const {
+    return active_segments(timestamp).size();
+}
+
+size_t SegmentIndex::prev_count(time::microseconds_t timestamp) const {
+    return locate(timestamp).prev_count;
+}
+
+size_t SegmentIndex::next_count(time::microseconds_t timestamp) const {
+    return arrays_.starts.size() - locate(timestamp).next_first;
+}
+
+size_t SegmentIndex::max_active_count() const {
+    size_t count = 0;
+    for (size_t i = 0; i + 1 < arrays_.active_offsets.size(); ++i) {
+        count = std::max<size_t>(count, arrays_.active_offsets[i + 1] - arrays_.active_offsets[i]);
+    }
+    return count;
+}
+
+time::microseconds_t SegmentIndex::next_boundary(time::microseconds_t timestamp) const {
+    const auto& pos = locate(timestamp);
+    size_t next_piece = (pos.piece == SIZE_MAX) ? 0 : pos.piece + 1;
+    if (next_piece < arrays_.boundaries.size()) {
+        return arrays_.boundaries[next_piece];
+    }
+    return time::INVALID_TIME;
+}
+
+uint32_t SegmentIndex::active(time::microseconds_t timestamp, size_t n) const {
+    auto segments = active_segments(timestamp);
+    if (n < segments.size()) {
+        return segments[n];
+    }
+    return npos;
+}
+
+uint32_t SegmentIndex::prev(time::microseconds_t timestamp, size_t n) const {
+    const auto& pos = locate(timestamp);
+    if (n < pos.prev_count) {
+        return arrays_.by_end[pos.prev_count - 1 - n];
+    }
+    return npos;
+}
+
+uint32_t SegmentIndex::next(time::microseconds_t timestamp, size_t n) const {
+    const auto& pos = locate(timestamp);
+    if (pos.next_first + n < arrays_.by_start.size()) {
+        return arrays_.by_start[pos.next_first + n];
+    }
+    return npos;
+}
+
+const SegmentIndex::position_t& SegmentIndex::locate(time::microseconds_t timestamp) const {
+    lookup_cache_t& cache = lookup_cache_;
+    if (cache.index_id == id_ && cache.timestamp == timestamp) {
+        return cache.position;
+    }
+
+    position_t& pos = cache.position;
+
+    auto bit = std::upper_bound(arrays_.boundaries.begin(), arrays_.boundaries.end(), timestamp);
+    pos.piece = (bit == arrays_.boundaries.begin())
+        ? SIZE_MAX
+        : static_cast<size_t>(std::distance(arrays_.boundaries.begin(), bit)) - 1;
+
+    auto eit = std::lower_bound(arrays_.ends.begin(), arrays_.ends.end(), timestamp);
+    pos.prev_count = static_cast<size_t>(std::distance(arrays_.ends.begin(), eit));
+
+    auto sit = std::upper_bound(arrays_.starts.begin(), arrays_.starts.end(), timestamp);
+    pos.next_first = static_cast<size_t>(std::distance(arrays_.starts.begin(), sit));
+
+    cache.index_id = id_;
+    cache.timestamp = timestamp;
+    return pos;
+}
+
+std::span<const uint32_t> SegmentIndex::active_segments(time::microseconds_t timestamp) const {
+    const auto& pos = locate(timestamp);
+    if (pos.piece == SIZE_MAX) {
+        return {};
+    }
+    return arrays_.active.subspan(
+        arrays_.active_offsets[pos.piece], arrays_.active_offsets[pos.piece + 1] - arrays_.active_offsets[pos.piece]);
+}
+
+} // namespace track
+} // namespace telemetry
@@ -0,0 +1,113 @@
+#ifndef SEGMENT_INDEX_H
+#define SEGMENT_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "backend/utils/time.h"
+
+namespace telemetry {
+namespace track {
+
+/* Interval index over all segments of one type.
+ *
+ * Built once at load time from segment start/end times (already in the
+ * relative time domain). Answers "N-th active/prev/next segment at t" with
+ * binary searches only and without allocating:
+ *  - active - start <= t <= end, ordered by start time ascending
+ *  - prev   - end < t, ordered by end time descending
+ *  - next   - start > t, ordered by start time ascending
+ * Active sets are precomputed per elementary interval (between consecutive
+ * start / end+1 boundaries) in one sweep over start/end events. Last looked up timestamp is cached per thread,
+ * as all fields of a frame are queried with the same timestamp.
+ * Like TrackpointStore, the index can be attached to external arrays
+ * (memory mapped track snapshot) instead of being built. */
+class SegmentIndex {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    struct interval_t {
+        uint32_t segment;
+        time::microseconds_t start;
+        time::microseconds_t end;
+    };
+
+    struct arrays_t {
+        std::span<const time::microseconds_t> starts;     // ascending
+        std::span<const uint32_t> by_start;
+        std::span<const time::microseconds_t> ends;       // ascending
+        std::span<const uint32_t> by_end;
+        // elementary intervals [boundaries[i], boundaries[i + 1])
+        std::span<const time::microseconds_t> boundaries;
+        // active segments of piece i are active[active_offsets[i] .. active_offsets[i + 1])
+        std::span<const uint32_t> active_offsets;
+        std::span<const uint32_t> active;
+    };
+
+    SegmentIndex() = default;
+    ~SegmentIndex() = default;
+
+    void build(std::vector<interval_t> intervals);
+
+    /* use external arrays - they must outlive the index */
+    void attach(const arrays_t& arrays);
+    const arrays_t& arrays() const;
+
+    size_t size() const;
+
+    size_t active_count(time::microseconds_t timestamp) const;
+    size_t prev_count(time::microseconds_t timestamp) const;
+    size_t next_count(time::microseconds_t timestamp) const;
+    /* most segments active at once */
+    size_t max_active_count() const;
+
+    /* first timestamp after given one at which any of the lists changes, INVALID_TIME if none */
+    time::microseconds_t next_boundary(time::microseconds_t timestamp) const;
+
+    /* segment id of n-th segment in list, npos if out of range */
+    uint32_t active(time::microseconds_t timestamp, size_t n) const;
+    uint32_t prev(time::microseconds_t timestamp, size_t n) const;
+    uint32_t next(time::microseconds_t timestamp, size_t n) const;
+
+private:
+    struct position_t {
+        size_t piece = SIZE_MAX; // elementary interval, SIZE_MAX before first boundary
+        size_t prev_count = 0;   // segments with end < timestamp
+        size_t next_first = 0;   // first segment (by start) with start > timestamp
+    };
+
+    struct lookup_cache_t {
+        uint64_t index_id = 0;
+        time::microseconds_t timestamp = 0;
+        position_t position{};
+    };
+    static thread_local lookup_cache_t lookup_cache_;
+
+    const position_t& locate(time::microseconds_t timestamp) const;
+    std::span<const uint32_t> active_segments(time::microseconds_t timestamp) const;
+
+    uint64_t id_ = 0; // unique per build/attach, keys the per-thread lookup cache
+
+    // owned storage, empty when attached to external arrays
+    std::vector<time::microseconds_t> starts_;
+    std::vector<uint32_t> by_start_;
+    std::vector<time::microseconds_t> ends_;
+    std::vector<uint32_t> by_end_;
+    std::vector<time::microseconds_t> boundaries_;
+    std::vector<uint32_t> active_offsets_;
+    std::vector<uint32_t> active_;
+
+    // views used for all lookups
+    arrays_t arrays_;
+
+    // views may point into own storage - copies would dangle
+    SegmentIndex(const SegmentIndex&) = delete;
+    SegmentIndex& operator=(const SegmentIndex&) = delete;
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // SEGMENT_INDEX_H
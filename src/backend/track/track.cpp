@@ -1,38 +1,40 @@
 #include "track.h"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <charconv>
 #include <cmath>
-
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <limits>
+#include <queue>
+#include <set>
+#include <thread>
+#include <utility>
+
+#include "backend/utils/blocking_queue.h"
 #include "backend/utils/time.h"
 #include "trace/trace.h"
+#include "csv_reader.h"
+#include "fit_reader.h"
+#include "xml_stream_reader.h"
 
 
-std::string drop_ns(const std::string& name) {
+std::string_view local_name(std::string_view name) {
     auto pos = name.rfind(':');
-    return (pos == std::string::npos) ? name : name.substr(pos + 1);
+    return (pos == std::string_view::npos) ? name : name.substr(pos + 1);
+}
+
+std::string drop_ns(const std::string& name) {
+    return std::string(local_name(name));
 }
 
 namespace telemetry {
 namespace track {
 namespace consts {
-    namespace mask {
-        const field_id_t flags            = 0xFF000000;
-
-        const field_id_t virtual_flag     = 0x80000000;
-        const field_id_t metadata_flag    = 0x40000000;
-        const field_id_t trackpoint_flag  = 0x20000000;
-        const field_id_t segment_flag     = 0x10000000;
-      /*   unused 0x08 flag                 0x08000000 */ 
-      /*   unused 0x04 flag                 0x04000000 */
-        const field_id_t lerp_flag        = 0x02000000;
-        const field_id_t pchip_flag       = 0x01000000;
-
-        namespace segment {
-            const field_id_t type         = 0x00F80000; // up to 32 segment types
-            const field_id_t list         = 0x00070000; // up to 8 segment lists
-            const field_id_t segment      = 0x0000FF00; // up to 256 segment instances (within type-list context)
-            const field_id_t field        = 0x000000FF; // up to 256 fields (within segment point/segment metadata)
-        }
-    }
     namespace prefix {
         const std::string metadata = "meta_";
         const std::string custom = "custom_";
@@ -47,6 +49,13 @@ namespace consts {
         const field_id_t prev   = 0x1;  // previously active segments
         const field_id_t next   = 0x2;  // next active segments
         const field_id_t all    = 0x3;  // all segments of this type
+
+        // lists with s_TYPE_LIST_N_ aliases of segment metadata (N-th segment of "all" list)
+        const std::array<std::pair<std::string_view, field_id_t>, 3> aliased = {{
+            {"active", active},
+            {"prev",   prev},
+            {"next",   next},
+        }};
     }
     namespace field {
         namespace segment {
@@ -61,35 +70,182 @@ namespace consts {
         }
     }
 
-    const field_id_t invalid_segment_idx = 0xFF;
+    const field_id_t invalid_segment_idx = 0xFFFF;
+
+    const std::string custom_series_extension = ".csv";
+
+    // standings of riders of a track set, see Track::build_race_index
+    namespace rider {
+        const std::string prefix = "r";           // rN_FIELD, N from 1
+        const std::string rank_prefix = "rank_";  // rank_N_FIELD, N from 1
+        const std::string count = "rider_count";
+        const std::string distance_field = "dist";
+        const std::string lat_field = "lat";
+        const std::string lon_field = "lon";
+
+        namespace id {
+            constexpr field_id_t count = 0x0;
+            constexpr field_id_t rank = 0x1;
+            constexpr field_id_t gap = 0x2;
+            constexpr field_id_t distance = 0x3;
+            constexpr field_id_t name = 0x4;
+            constexpr field_id_t rider = 0x5;
+        }
+
+        const std::array<std::pair<std::string_view, field_id_t>, 4> fields = {{
+            {"rank",     id::rank},
+            {"gap",      id::gap},
+            {"distance", id::distance},
+            {"name",     id::name},
+        }};
+        const std::array<std::pair<std::string_view, field_id_t>, 4> ranked_fields = {{
+            {"rider",    id::rider},
+            {"gap",      id::gap},
+            {"distance", id::distance},
+            {"name",     id::name},
+        }};
+    }
+
+    namespace bake {
+        constexpr size_t memory_budget = 256 * 1024 * 1024; // all baked fields of a track
+    }
+
+    namespace live {
+        constexpr std::chrono::seconds first_trackpoint_timeout{60}; // load_live gives up after
+    }
+
+    namespace stream {
+        constexpr size_t batch_size = 1024;                // trkpts parsed by one worker task
+        constexpr size_t pending_batches_per_worker = 2;   // bounds raw text held in flight
+    }
+
+    // subset of FIT profile - message and field numbers, value = raw / scale - offset
+    namespace fit {
+        const std::string extension = ".fit";
+        const std::string lap_segment_type = "lap";
+
+        namespace message {
+            constexpr uint16_t session = 18;
+            constexpr uint16_t lap = 19;
+            constexpr uint16_t record = 20;
+        }
+
+        struct field_t {
+            uint8_t number;
+            std::string_view name;
+            double scale;
+            double offset;
+        };
+
+        constexpr double semicircles_per_degree = 2147483648.0 / 180.0;
+
+        // record fields as trackpoint fields, named like in Garmin GPX exports
+        constexpr std::array<field_t, 12> record_fields = {{
+            {0,  "lat",   semicircles_per_degree, 0.0},
+            {1,  "lon",   semicircles_per_degree, 0.0},
+            {2,  "ele",   5.0,    500.0}, // altitude
+            {78, "ele",   5.0,    500.0}, // enhanced altitude
+            {3,  "hr",    1.0,    0.0},
+            {4,  "cad",   1.0,    0.0},
+            {5,  "dist",  100.0,  0.0},
+            {6,  "speed", 1000.0, 0.0},
+            {73, "speed", 1000.0, 0.0},   // enhanced speed
+            {7,  "power", 1.0,    0.0},
+            {9,  "grade", 100.0,  0.0},
+            {13, "atemp", 1.0,    0.0},
+        }};
+        constexpr uint8_t unmapped = UINT8_MAX; // record field without trackpoint field
+
+        namespace lap {
+            constexpr uint8_t start_time = 2; // end time is the timestamp
+        }
+
+        // lap fields as segment metadata
+        constexpr std::array<field_t, 16> lap_fields = {{
+            {7,   "elapsedtime", 1000.0, 0.0},
+            {8,   "timertime",   1000.0, 0.0},
+            {9,   "distance",    100.0,  0.0},
+            {11,  "calories",    1.0,    0.0},
+            {13,  "avgspeed",    1000.0, 0.0},
+            {110, "avgspeed",    1000.0, 0.0}, // enhanced
+            {14,  "maxspeed",    1000.0, 0.0},
+            {111, "maxspeed",    1000.0, 0.0}, // enhanced
+            {15,  "avghr",       1.0,    0.0},
+            {16,  "maxhr",       1.0,    0.0},
+            {17,  "avgcadence",  1.0,    0.0},
+            {18,  "maxcadence",  1.0,    0.0},
+            {19,  "avgpower",    1.0,    0.0},
+            {20,  "maxpower",    1.0,    0.0},
+            {21,  "ascent",      1.0,    0.0},
+            {22,  "descent",     1.0,    0.0},
+        }};
+
+        namespace session {
+            constexpr uint8_t sport = 5;
+        }
+
+        // sport enum as track type
+        constexpr std::array<std::pair<uint8_t, std::string_view>, 8> sports = {{
+            {0,  "generic"},
+            {1,  "running"},
+            {2,  "cycling"},
+            {4,  "fitness_equipment"},
+            {5,  "swimming"},
+            {10, "training"},
+            {11, "walking"},
+            {17, "hiking"},
+        }};
+    }
 } // namespace consts
 
+namespace {
+    /* threads running parse tasks for the duration of single load */
+    class ParseWorkers {
+    public:
+        ParseWorkers(size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                threads_.emplace_back([this]() {
+                    std::function<void()> task;
+                    while (queue_.pop(task)) {
+                        task();
+                    }
+                });
+            }
+        }
+
+        ~ParseWorkers() {
+            queue_.close(); // remaining tasks are still executed, threads join on destruction
+        }
+
+        void submit(std::function<void()> task) {
+            queue_.push(std::move(task));
+        }
 
-struct segment_field_id {
-    field_id_t type;
-    field_id_t list;
-    field_id_t segment;
-    field_id_t field;
+        size_t size() const {
+            return threads_.size();
+        }
 
-    segment_field_id(field_id_t type, field_id_t list, field_id_t segment, field_id_t field)
-        : type(type), list(list), segment(segment), field(field) {}
+    private:
+        BlockingQueue<std::function<void()>> queue_;
+        std::vector<std::jthread> threads_;
+    };
 
-    segment_field_id(field_id_t fid) {
-        type = (fid & consts::mask::segment::type) >> 19;
-        list = (fid & consts::mask::segment::list) >> 16;
-        segment = (fid & consts::mask::segment::segment) >> 8;
-        field = fid & consts::mask::segment::field;
+    /* lowercase file extension with dot */
+    std::string lowercase_extension(const std::string& path) {
+        std::string extension = std::filesystem::path(path).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension;
     }
 
-    explicit operator field_id_t() const {
-        return ((type << 19) & consts::mask::segment::type) |
-               ((list << 16) & consts::mask::segment::list) |
-               ((segment << 8) & consts::mask::segment::segment) |
-               (field & consts::mask::segment::field);
+    /* horizon of values changing continuously with time */
+    time::microseconds_t next_microsecond(time::microseconds_t timestamp) {
+        return (timestamp < VALID_FOREVER) ? timestamp + 1 : VALID_FOREVER;
     }
-};
+}
+
 
-std::string uint_to_hex(uint32_t v, int width = 0, bool prefix = true, bool uppercase = true) {
+std::string uint_to_hex(uint64_t v, int width = 0, bool prefix = true, bool uppercase = true) {
     std::ostringstream ss;
     if (prefix) ss << "0x";
     ss << std::hex << (uppercase ? std::uppercase : std::nouppercase)
@@ -101,14 +257,16 @@ std::string uint_to_hex(uint32_t v, int width = 0, bool prefix = true, bool uppe
     //      only exception being accpower
 
     // TODO move to markdown documentation
-    //                          xxxx xxxx  xxxx xxxx  xxxx xxxx  xxxx xxxx
+    // field ids are 64 bit (see field_id.h), top byte are flags:
+    //                          xxxx xxxx  xxxx xxxx  xxxx xxxx  xxxx xxxx  xxxx xxxx  [32 bits]
     //                         |--flags--|
     
     // field types:
-    // virtual         0x80     1000 .... |-----------field-id------------|
-    // metadata        0x40     0100 .... |-----------field-id------------|
-    // trackpt         0x20     0010 .... |-----------field-id------------|
+    // virtual         0x80     1000 ....  .... .... .... .... .... .... |--field-id--|
+    // metadata        0x40     0100 ....  .... .... .... .... .... .... |--field-id--|
+    // trackpt         0x20     0010 ....  .... .... .... .... .... .... |--field-id--|
     // segment         0x10     0001 .... 
+    // cumulative      0xA0     1010 ....  .... .... .... .... SSSS SSSS |--trackpt-field-id--|  (S - CumulativeStat)
 
     // modifiers:
     // lerp            0x08     00.. 10..
@@ -117,10 +275,10 @@ std::string uint_to_hex(uint32_t v, int width = 0, bool prefix = true, bool uppe
     // unused          0x01     .... ...1
 
 
-    // segment field id layout:
-    //                                     0001 ..00  TTTT TLLL NNNN NNNN  IIII IIII
+    // segment field id layout (each letter 4 bits):
+    //                                     0001 ..00  TTTT LL NNNN IIII
     //
-    // examples (not real bit values):
+    // examples (not real bit values, each letter 1 bit):
     // s_climb_prev_0_meta_distance        0001 0000  0000 1001 0000 0000  0001 0010
     //    type = 0x01  segment
     //    mods = 0x00  (no modifiers)
@@ -140,34 +298,33 @@ std::string uint_to_hex(uint32_t v, int width = 0, bool prefix = true, bool uppe
     //    field= 0x12* "dist" point field within segment
 
 
-    // TTTT T     - segment type identifier (up to 16 types)
-    // LLL        - segment list identifier (up to 8 lists)
-    // NNNN NNNN  - segment instance identifier (up to 256 instances)
-    // IIII IIII  - field identifier within segment (up to 256 fields)
+    // TTTT       - segment type identifier (up to 65536 types)
+    // LL         - segment list identifier (up to 256 lists)
+    // NNNN       - segment instance identifier (up to 65536 instances)
+    // IIII       - field identifier within segment (up to 65536 fields)
     // 
-    // segments types (TTTT T) - mapped to TYPE in "s_TYPE_" field name prefix:
+    // segments types (TTTT) - mapped to TYPE in "s_TYPE_" field name prefix:
     //      auto generated from track
     //      e.g. "segment" "climb" generated by GPST in ActivitySegmentType extension
     //      in future e.g. "laps"
     //
-    // segment lists (LLL):
+    // segment lists (LL):
     //     - currently active segment   (mapped to "s_TYPE_active_N_")
     //     - previous active segment    (mapped to "s_TYPE_prev_N_")
     //     - next active segment        (mapped to "s_TYPE_next_N_")
     //     - all segments               (mapped to "s_TYPE_N_")
     //
-    // segment instance id (NNN NNNN) - mapped to N in field name prefix above:
+    // segment instance id (NNNN) - mapped to N in field name prefix above:
     //     unique identifier for segment instance within its type-list
     //
     // suffix:
     //     - metadata: "_meta_FIELDNAME"
     //     - point data: "_point_FIELDNAME" (only relevant for "active" list)
     //
-    // field id within segment (IIII IIII) - mapped to FIELDNAME above
+    // field id within segment (IIII) - mapped to FIELDNAME above
     //     TBD for metadata generated
-    //     TBD generated from track point field names within segment context
-    //     TBD with cumulative values virtualized to treat segment start as zero point
-    //     TBD - actually only metadata and cumulative fields make sense - rest will be taken from actual points
+    //     for point data index of trackpoint field (sorted by name), value relative to segment start
+    //     (see generate_segment_point_fields)
     //
     // example field names:
     //   s_climb_active_0_point_dist - cumulative distance since start of current climb segment
@@ -180,42 +337,526 @@ Track::Track(time::microseconds_t offset): start_offset_(offset) {
     create_virtual_fields();
 }
 
-bool Track::load(const std::string& path) {
+bool Track::load(const std::string& path, size_t worker_count) {
     TRACE_EVENT_BEGIN(EV_TRACK_LOAD);
     log.info("Loading track from path: {}", path);
 
+    snapshot::source_t source{};
+    std::string snapshot_path = snapshot::cache_path(path);
+    bool use_snapshot = !snapshot_path.empty() && snapshot::get_source(path, start_offset_, source);
+
+    if (use_snapshot && load_snapshot(snapshot_path, source)) {
+        TRACE_EVENT_END(EV_TRACK_LOAD);
+        return true;
+    }
+
+    bool ok = (lowercase_extension(path) == consts::fit::extension) ? load_fit(path)
+                                                                     : load_gpx(path, Parser::Stream, worker_count);
+
+    if (ok && use_snapshot) {
+        save_snapshot(snapshot_path, source);
+    }
+
+    TRACE_EVENT_END(EV_TRACK_LOAD);
+    return ok;
+}
+
+bool Track::load(const std::vector<source_t>& sources, size_t worker_count) {
+    if (sources.empty()) {
+        log.error("No track source provided");
+        return false;
+    }
+    if (sources.front().offset != 0 || !sources.front().prefix.empty()) {
+        log.error("Offset and prefix can not be set for first track source: {}", sources.front().path);
+        return false;
+    }
+    for (const auto& source : sources) {
+        if (source.live && (sources.size() > 1 || source.rider)) {
+            log.error("Live track source can not be merged with other sources: {}", source.path);
+            return false;
+        }
+    }
+    if (sources.front().live) {
+        return load_live(sources.front().path);
+    }
+
+    // riders other than the first source are merged with rN_ prefix, so rN_point_speed resolves to point_rN_speed
+    std::vector<source_t> resolved = sources;
+    size_t rider_count = 0;
+    for (size_t i = 0; i < resolved.size(); ++i) {
+        auto& source = resolved[i];
+        if (!source.rider) {
+            continue;
+        }
+        ++rider_count;
+        if (!source.prefix.empty()) {
+            log.error("Prefix can not be set for rider track source: {}", source.path);
+            return false;
+        }
+        if (i > 0) {
+            source.prefix = consts::rider::prefix + std::to_string(rider_count) + "_";
+        }
+    }
+
+    if (!load(resolved.front().path, worker_count)) {
+        return false;
+    }
+    if (resolved.size() > 1 && !load_sources(resolved, worker_count)) {
+        return false;
+    }
+    if (rider_count > 0) {
+        build_race_index(resolved);
+    }
+    return true;
+}
+
+bool Track::load_sources(const std::vector<source_t>& sources, size_t worker_count) {
+    // other sources as standalone tracks first (each cached in own snapshot), clock offset applied while loading
+    std::vector<std::unique_ptr<Track>> tracks;
+    for (size_t i = 1; i < sources.size(); ++i) {
+        const auto& source = sources[i];
+        log.info("Loading track source: {} (offset: {} us, prefix: '{}')", source.path, source.offset, source.prefix);
+        auto track = std::make_unique<Track>(start_offset_ + source.offset);
+        if (!track->load(source.path, worker_count)) {
+            log.error("Failed to load track source: {}", source.path);
+            return false;
+        }
+        if (track->start_time_ == time::INVALID_TIME_POINT || track->trackpoints_.size() == 0) {
+            log.error("No trackpoints in track source: {}", source.path);
+            return false;
+        }
+        tracks.push_back(std::move(track));
+    }
+
+    return merge_sources(sources, tracks);
+}
+
+/* k-way merge-join of trackpoints of this track and other sources into one timeline - columns of a source
+ * hold its own samples at its own timestamps, at timestamps of other sources they are joined (linearly
+ * interpolated between surrounding own samples, see TrackpointStore::is_sample) and outside of its time
+ * span missing. Segments and metadata of other sources are not merged. */
+bool Track::merge_sources(const std::vector<source_t>& sources, const std::vector<std::unique_ptr<Track>>& tracks) {
+    TRACE_EVENT_BEGIN(EV_TRACK_MERGE_SOURCES);
+    auto started = std::chrono::steady_clock::now();
+
+    if (start_time_ == time::INVALID_TIME_POINT) {
+        log.error("Track start time unknown, can not align other track sources");
+        TRACE_EVENT_END(EV_TRACK_MERGE_SOURCES);
+        return false;
+    }
+
+    struct input_t {
+        const TrackpointStore* store;
+        time::microseconds_t shift;  // into time domain of this track
+        std::vector<size_t> columns; // merged column of each store column, npos if not merged
+    };
+    std::vector<input_t> inputs;
+    std::vector<TrackpointStore::ColumnType> types; // of merged columns
+
+    // columns of this track keep their indexes
+    inputs.push_back({&trackpoints_, 0, {}});
+    for (size_t column = 0; column < trackpoints_.column_count(); ++column) {
+        inputs.back().columns.push_back(column);
+        types.push_back(trackpoints_.column_type(column));
+    }
+
+    // validate names of fields from other sources before touching track state
+    std::vector<std::pair<std::string, size_t>> fields; // key (without point_ prefix), merged column
+    std::set<std::string> keys;
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        const Track& track = *tracks[i];
+        const source_t& source = sources[i + 1];
+        auto shift = std::chrono::duration_cast<std::chrono::microseconds>(track.start_time_ - start_time_).count();
+        inputs.push_back({&track.trackpoints_, shift, std::vector<size_t>(track.trackpoints_.column_count(), TrackpointStore::npos)});
+
+        for (const auto& name : track.get_field_names()) {
+            if (!name.starts_with(consts::prefix::trackpoint)) {
+                continue;
+            }
+            size_t column = track.get_trackpoint_column(track.get_field_id(name));
+            if (column == TrackpointStore::npos) {
+                continue;
+            }
+            std::string key = source.prefix + name.substr(consts::prefix::trackpoint.size());
+            if (!keys.insert(key).second || get_field_id(consts::prefix::trackpoint + key) != INVALID_FIELD) {
+                log.error("Field {} of track source {} is already defined, set a different prefix",
+                          consts::prefix::trackpoint + key, source.path);
+                TRACE_EVENT_END(EV_TRACK_MERGE_SOURCES);
+                return false;
+            }
+            inputs.back().columns[column] = types.size();
+            fields.emplace_back(std::move(key), types.size());
+            types.push_back(track.trackpoints_.column_type(column));
+        }
+    }
+
+    // k-way merge of sorted timestamps, same timestamp in several sources becomes one trackpoint
+    using head_t = std::pair<time::microseconds_t, size_t>; // next timestamp, input
+    std::priority_queue<head_t, std::vector<head_t>, std::greater<head_t>> heads;
+    std::vector<size_t> positions(inputs.size(), 0);
+    size_t total = 0;
+    for (size_t k = 0; k < inputs.size(); ++k) {
+        auto own = inputs[k].store->timestamps();
+        total += own.size();
+        if (!own.empty()) {
+            heads.emplace(own.front() + inputs[k].shift, k);
+        }
+    }
+
+    std::vector<time::microseconds_t> timestamps;
+    timestamps.reserve(total);
+    while (!heads.empty()) {
+        auto [timestamp, k] = heads.top();
+        heads.pop();
+        if (timestamps.empty() || timestamps.back() != timestamp) {
+            timestamps.push_back(timestamp);
+        }
+        auto own = inputs[k].store->timestamps();
+        if (++positions[k] < own.size()) {
+            heads.emplace(own[positions[k]] + inputs[k].shift, k);
+        }
+    }
+
+    // join - walk merged timeline once per source, own samples are copied, the rest interpolated
+    size_t count = timestamps.size();
+    std::vector<std::vector<double>> values(types.size(), std::vector<double>(count, std::numeric_limits<double>::quiet_NaN()));
+    std::vector<std::vector<uint64_t>> joined(types.size(), std::vector<uint64_t>((count + 63) / 64, 0));
+    for (const auto& input : inputs) {
+        const TrackpointStore& store = *input.store;
+        auto own = store.timestamps();
+        size_t next = 0; // first own trackpoint not before current merged one
+        for (size_t row = 0; row < count; ++row) {
+            time::microseconds_t timestamp = timestamps[row];
+            if (next < own.size() && own[next] + input.shift == timestamp) {
+                for (size_t c = 0; c < input.columns.size(); ++c) {
+                    if (input.columns[c] != TrackpointStore::npos && store.is_valid(c, next)) {
+                        values[input.columns[c]][row] = store.value(c, next);
+                    }
+                }
+                ++next;
+                continue;
+            }
+            if (next == 0 || next == own.size()) {
+                continue; // outside of time span of source
+            }
+
+            size_t lower = next - 1;
+            time::microseconds_t t0 = own[lower] + input.shift;
+            time::microseconds_t t1 = own[next] + input.shift;
+            double factor = static_cast<double>(timestamp - t0) / static_cast<double>(t1 - t0);
+            for (size_t c = 0; c < input.columns.size(); ++c) {
+                size_t column = input.columns[c];
+                if (column == TrackpointStore::npos || !store.is_valid(c, lower) || !store.is_valid(c, next)) {
+                    continue;
+                }
+                double lv = store.value(c, lower);
+                double uv = store.value(c, next);
+                values[column][row] = lv + factor * (uv - lv);
+                joined[column][row / 64] |= (uint64_t{1} << (row % 64));
+            }
+        }
+    }
+
+    // this track's columns may be attached to snapshot - replaced by owned merged ones
+    trackpoints_.clear();
+    for (auto type : types) {
+        trackpoints_.add_column(type);
+    }
+    trackpoints_.build(std::move(timestamps), std::move(values), std::move(joined));
+
+    for (const auto& [key, column] : fields) {
+        trackpoint_columns_[register_trackpoint_field(key)] = column;
+    }
+    index_trackpoints();
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    log.info("Merged {} track sources: {} trackpoints, {} fields, {} bytes in {} ms",
+             inputs.size(), trackpoints_.size(), trackpoints_.column_count(), trackpoints_.memory_usage(), elapsed.count());
+
+    TRACE_EVENT_END(EV_TRACK_MERGE_SOURCES);
+    return true;
+}
+
+/* standings of rider sources over the merged timeline - distance from rider's point_dist samples, or
+ * summed from its point_lat/point_lon samples */
+void Track::build_race_index(const std::vector<source_t>& sources) {
+    std::vector<RaceIndex::rider_columns_t> columns;
+    for (const auto& source : sources) {
+        if (!source.rider) {
+            continue;
+        }
+        std::string name = source.name.empty() ? std::filesystem::path(source.path).stem().string() : source.name;
+        auto column = [this, &source](const std::string& key) {
+            return get_trackpoint_column(get_field_id(consts::prefix::trackpoint + source.prefix + key));
+        };
+        RaceIndex::rider_columns_t rider{column(consts::rider::distance_field), column(consts::rider::lat_field),
+                                         column(consts::rider::lon_field)};
+        if (rider.distance == TrackpointStore::npos && (rider.lat == TrackpointStore::npos || rider.lon == TrackpointStore::npos)) {
+            log.warning("Rider {} has neither distance nor position, ranked last", name);
+        }
+        columns.push_back(rider);
+        riders_.push_back({source.prefix, std::move(name)});
+    }
+
+    race_ = std::make_unique<RaceIndex>(trackpoints_, columns);
+    log.info("Built race index of {} riders: {} bytes", riders_.size(), race_->memory_usage());
+}
+
+bool Track::load_gpx(const std::string& path, Parser parser, size_t worker_count) {
+    if (parser == Parser::Stream) {
+        return parse_gpx_stream(path, worker_count);
+    }
+
     pugi::xml_document doc;
     pugi::xml_parse_result result = doc.load_file(path.c_str());
 
     if (!result) {
         log.error("Failed to load track file: {}. Error description: {}", path, result.description());
-        TRACE_EVENT_END(EV_TRACK_LOAD);
         return false;
     }
 
     if (doc.children().empty()) {
         log.error("Empty track file: {}", path);
-        TRACE_EVENT_END(EV_TRACK_LOAD);
         return false;
     }
 
     if (std::distance(doc.children().begin(), doc.children().end()) > 1) {
         log.error("More than one root node in track file");
-        TRACE_EVENT_END(EV_TRACK_LOAD);
         return false;
     }
 
     pugi::xml_node root = doc.child("gpx");
     if (!root) {
         log.error("No <gpx> root node found in track file");
-        TRACE_EVENT_END(EV_TRACK_LOAD);
         return false;
     }
 
-    bool ok = parse_gpx(root);
+    return parse_gpx(root);
+}
 
-    TRACE_EVENT_END(EV_TRACK_LOAD);
-    return ok;
+/* record messages are decoded straight into columns (row per timestamp, NaN where missing), moved into
+ * the trackpoint store as is when records are in time order */
+bool Track::load_fit(const std::string& path) {
+    log.info("Decoding FIT file: {}", path);
+
+    class FitHandler : public FitReader::Handler {
+    public:
+        FitHandler(Track& track) : track_(track) {
+            record_fields_.fill(consts::fit::unmapped);
+            for (size_t i = 0; i < consts::fit::record_fields.size(); ++i) {
+                record_fields_[consts::fit::record_fields[i].number] = static_cast<uint8_t>(i);
+            }
+            columns_.fill(TrackpointStore::npos);
+        }
+
+        bool accept(uint16_t message) override {
+            return message == consts::fit::message::record || message == consts::fit::message::lap ||
+                   message == consts::fit::message::session;
+        }
+
+        void on_message(uint16_t message, std::span<const FitReader::field_t> fields) override {
+            switch (message) {
+                case consts::fit::message::record:
+                    on_record(fields);
+                    break;
+                case consts::fit::message::lap:
+                    on_lap(fields);
+                    break;
+                case consts::fit::message::session:
+                    on_session(fields);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        std::vector<time::microseconds_t> timestamps; // since epoch
+        std::vector<std::vector<double>> values;      // by trackpoint column
+        bool sorted = true;
+        size_t skipped_records = 0;
+        bool ok = true;
+
+    private:
+        static time::microseconds_t to_epoch_us(double fit_seconds) {
+            return (static_cast<time::microseconds_t>(fit_seconds) + FitReader::epoch_offset) * 1'000'000;
+        }
+
+        static const FitReader::field_t* find(std::span<const FitReader::field_t> fields, uint8_t number) {
+            for (const auto& field : fields) {
+                if (field.number == number) {
+                    return &field;
+                }
+            }
+            return nullptr;
+        }
+
+        void set(size_t column, double value) {
+            if (column >= values.size()) {
+                values.resize(column + 1, std::vector<double>(timestamps.size(), std::numeric_limits<double>::quiet_NaN()));
+            }
+            values[column].back() = value;
+        }
+
+        void on_record(std::span<const FitReader::field_t> fields) {
+            const FitReader::field_t* timestamp = find(fields, FitReader::timestamp_field);
+            if (!timestamp) {
+                ++skipped_records;
+                return;
+            }
+
+            // later record of the same second updates the row like later trkpt of same time
+            time::microseconds_t us = to_epoch_us(timestamp->value);
+            if (timestamps.empty() || timestamps.back() != us) {
+                sorted = sorted && (timestamps.empty() || timestamps.back() < us);
+                timestamps.push_back(us);
+                for (auto& column : values) {
+                    column.push_back(std::numeric_limits<double>::quiet_NaN());
+                }
+            }
+
+            if (time_column_ == TrackpointStore::npos) {
+                time_column_ = track_.get_trackpoint_handle("time", TrackpointStore::ColumnType::TimePoint);
+            }
+            set(time_column_, static_cast<double>(us));
+
+            for (const auto& field : fields) {
+                uint8_t index = record_fields_[field.number];
+                if (index == consts::fit::unmapped) {
+                    continue;
+                }
+                const auto& mapping = consts::fit::record_fields[index];
+                if (columns_[index] == TrackpointStore::npos) {
+                    columns_[index] = track_.get_trackpoint_handle(mapping.name, TrackpointStore::ColumnType::Double);
+                }
+                set(columns_[index], field.value / mapping.scale - mapping.offset);
+            }
+        }
+
+        void on_lap(std::span<const FitReader::field_t> fields) {
+            const FitReader::field_t* start = find(fields, consts::fit::lap::start_time);
+            const FitReader::field_t* end = find(fields, FitReader::timestamp_field);
+            if (!start || !end) {
+                track_.log.warning("Lap missing start or end time");
+                ok = false;
+                return;
+            }
+
+            std::map<std::string, Value> metadata;
+            auto start_time = time::time_point_t(std::chrono::microseconds(to_epoch_us(start->value)));
+            auto end_time = time::time_point_t(std::chrono::microseconds(to_epoch_us(end->value)));
+            metadata["type"] = Value(consts::fit::lap_segment_type);
+            metadata["starttime"] = Value(start_time);
+            metadata["endtime"] = Value(end_time);
+            for (const auto& field : fields) {
+                for (const auto& mapping : consts::fit::lap_fields) {
+                    if (mapping.number == field.number) {
+                        metadata[std::string(mapping.name)] = Value(field.value / mapping.scale - mapping.offset);
+                    }
+                }
+            }
+            ok = track_.store_segment(consts::fit::lap_segment_type, start_time, end_time, std::move(metadata)) && ok;
+        }
+
+        void on_session(std::span<const FitReader::field_t> fields) {
+            const FitReader::field_t* sport = find(fields, consts::fit::session::sport);
+            if (!sport) {
+                return;
+            }
+            for (const auto& [number, name] : consts::fit::sports) {
+                if (number == sport->value) {
+                    track_.store_metadata("type", Value(std::string(name)));
+                }
+            }
+        }
+
+        Track& track_;
+        std::array<uint8_t, 256> record_fields_; // field number -> index in record_fields
+        std::array<size_t, consts::fit::record_fields.size()> columns_; // trackpoint column of record_fields
+        size_t time_column_ = TrackpointStore::npos;
+    };
+
+    FitHandler handler(*this);
+    FitReader reader;
+    if (!reader.read(path, handler)) {
+        return false;
+    }
+    if (handler.timestamps.empty()) {
+        log.error("No records with timestamp in FIT file: {}", path);
+        return false;
+    }
+    if (handler.skipped_records > 0) {
+        log.warning("Skipped {} records without timestamp", handler.skipped_records);
+    }
+
+    time::microseconds_t start_us = *std::min_element(handler.timestamps.begin(), handler.timestamps.end());
+    start_time_ = time::time_point_t(std::chrono::microseconds(start_us));
+    log.info("Track start time: {}", std::format("{}", start_time_));
+
+    if (!segment_types_.empty()) {
+        generate_segment_virtual_metadata_fields();
+    }
+    build_segment_index();
+
+    time::microseconds_t shift = start_offset_ - start_us;
+    if (handler.sorted) {
+        for (auto& timestamp : handler.timestamps) {
+            timestamp += shift;
+        }
+        trackpoints_.build(std::move(handler.timestamps), std::move(handler.values));
+    } else {
+        log.warning("Records of FIT file are not in time order, sorting: {}", path);
+        for (size_t column = 0; column < handler.values.size(); ++column) {
+            for (size_t row = 0; row < handler.timestamps.size(); ++row) {
+                if (!std::isnan(handler.values[column][row])) {
+                    trackpoints_.set(handler.timestamps[row], column, handler.values[column][row]);
+                }
+            }
+        }
+        trackpoints_.build(shift);
+    }
+    trackpoint_handles_.clear();
+
+    log.info("Built trackpoint store: {} trackpoints, {} fields, {} bytes",
+             trackpoints_.size(), trackpoints_.column_count(), trackpoints_.memory_usage());
+
+    index_trackpoints();
+    return handler.ok;
+}
+
+bool Track::load_live(const std::string& path) {
+    log.info("Loading live track from path: {}", path);
+
+    // trkpts are parsed on the feed thread by a track of its own (relative to epoch), so nothing of this
+    // track is touched there - times are aligned when batches are applied
+    auto parser = std::make_shared<Track>();
+    parser->start_time_ = time::time_point_t{};
+    auto parse_trkpt = [parser](pugi::xml_node node, TrackpointChunk& chunk) {
+        auto timestamp = parser->parse_trkpt_time(node);
+        if (timestamp != time::INVALID_TIME_POINT &&
+            (chunk.start_time == time::INVALID_TIME_POINT || timestamp < chunk.start_time)) {
+            chunk.start_time = timestamp;
+        }
+        return parser->parse_trkpt(node, timestamp, chunk);
+    };
+    auto format = (lowercase_extension(path) == consts::custom_series_extension) ? LiveFeed::Format::Csv
+                                                                                  : LiveFeed::Format::Gpx;
+
+    live_ = std::make_unique<LiveFeed>(path, format, parse_trkpt);
+    if (!live_->start()) {
+        live_.reset();
+        return false;
+    }
+
+    // fields have to exist before the layout binds them
+    log.info("Waiting for first trackpoints of live track");
+    auto batch = live_->wait(consts::live::first_trackpoint_timeout);
+    if (!batch) {
+        log.error("No trackpoints in live track within {} s: {}", consts::live::first_trackpoint_timeout.count(), path);
+        live_.reset();
+        return false;
+    }
+    apply_live_batch(*batch);
+    return true;
 }
 
 bool Track::load_custom_data(const std::string& path) {
@@ -223,6 +864,12 @@ bool Track::load_custom_data(const std::string& path) {
 
     log.info("Loading custom data from path: {}", path);
 
+    if (lowercase_extension(path) == consts::custom_series_extension) {
+        bool ok = load_custom_series(path);
+        TRACE_EVENT_END(EV_TRACK_LOAD_CUSTOM_DATA);
+        return ok;
+    }
+
     pugi::xml_document doc;
     pugi::xml_parse_result result = doc.load_file(path.c_str());
 
@@ -292,109 +939,506 @@ bool Track::load_custom_data(const std::string& path) {
     return ok;
 }
 
-field_id_t Track::get_field_id(const std::string& field_name) const {
-    auto it = field_ids_.find(field_name);
-    if (it != field_ids_.end()) {
-        return it->second;
+/* CSV time series as custom_KEY fields (with lerp_/pchip_ variants) - kept in own store with own
+ * timestamps, so trackpoints of the track are not affected */
+bool Track::load_custom_series(const std::string& path) {
+    auto started = std::chrono::steady_clock::now();
+
+    CsvReader reader;
+    CsvReader::series_t series;
+    if (!reader.read(path, series)) {
+        return false;
+    }
+    if (series.timestamps.empty()) {
+        log.error("No rows in custom series file: {}", path);
+        return false;
     }
-    return INVALID_FIELD;
-}
 
-Track::trackpoint_ts_view_t Track::get_trackpoint_timestamps() const {
-    return std::views::keys(trackpoints_);
-}
+    std::set<std::string> names;
+    for (const auto& name : series.names) {
+        if (!names.insert(name).second || get_field_id(consts::prefix::custom + name) != INVALID_FIELD) {
+            log.error("Custom series column '{}' is already defined", name);
+            return false;
+        }
+    }
 
-Value Track::get(const std::string& key, time::microseconds_t timestamp) const {
-    field_id_t field_id = get_field_id(key);
-    return get(field_id, timestamp);
-}
+    // into track time domain - seconds are relative to track start
+    time::microseconds_t shift = start_offset_;
+    if (series.absolute_time) {
+        if (start_time_ == time::INVALID_TIME_POINT) {
+            log.error("Track start time unknown, can not align times of custom series: {}", path);
+            return false;
+        }
+        shift -= std::chrono::duration_cast<std::chrono::microseconds>(start_time_.time_since_epoch()).count();
+    }
+    for (auto& timestamp : series.timestamps) {
+        timestamp += shift;
+    }
 
-Value Track::get(field_id_t field_id, time::microseconds_t timestamp) const {
-    if (field_id == INVALID_FIELD) {
-        log.debug("Invalid field id requested");
-        return Value();
+    auto store = std::make_unique<TrackpointStore>();
+    for (size_t i = 0; i < series.names.size(); ++i) {
+        store->add_column(TrackpointStore::ColumnType::Double);
     }
-    
-    if (field_id & consts::mask::virtual_flag) { // virtual first to cover also segment virtuals
-        return get_virtual_data(field_id, timestamp);
-    } else if (field_id & consts::mask::segment_flag) { // segments second to cover also segment metadata
-        return get_segment_data(field_id, timestamp);
-    } else if (field_id & consts::mask::trackpoint_flag) { // then trackpoint in different flavors
-        if (field_id & consts::mask::lerp_flag) {
-            return get_lerp_trackpoint_data(field_id, timestamp);
-        } else if (field_id & consts::mask::pchip_flag) {
-            return get_pchip_trackpoint_data(field_id, timestamp);
-        } else {
-            return get_trackpoint_data(field_id, timestamp);
-        }
-    } else if (field_id & consts::mask::metadata_flag) { // metadata at the end
-        return get_metadata(field_id);
+
+    size_t rows = series.timestamps.size();
+    bool sorted = std::adjacent_find(series.timestamps.begin(), series.timestamps.end(),
+                                     std::greater_equal<time::microseconds_t>()) == series.timestamps.end();
+    if (sorted) {
+        store->build(std::move(series.timestamps), std::move(series.columns));
     } else {
-        log.warning("Unparsable field id: {}", uint_to_hex(field_id));
-        return Value();
+        log.warning("Rows of custom series are not in time order, sorting: {}", path);
+        for (size_t column = 0; column < series.columns.size(); ++column) {
+            for (size_t row = 0; row < rows; ++row) {
+                if (!std::isnan(series.columns[column][row])) {
+                    store->set(series.timestamps[row], column, series.columns[column][row]);
+                }
+            }
+        }
+        store->build();
     }
-}
 
-Value Track::get_metadata(field_id_t field_id) const {
-    auto it = metadata_.find(field_id);
-    if (it != metadata_.end()) {
-        return it->second;
+    for (size_t column = 0; column < series.names.size(); ++column) {
+        field_id_t field_id = register_custom_series_field(series.names[column]);
+        custom_series_columns_[field_id] = {store.get(), column};
     }
-    return Value();
-}
 
-Value Track::get_trackpoint_data(field_id_t field_id, time::microseconds_t timestamp) const {
-    //TODO add caching of last accessed trackpoint (or similar) (maybe?)
-    //TODO need to handle case where the data is stale?
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    log.info("Loaded custom series: {} rows, {} fields, {} bytes in {} ms",
+             rows, series.names.size(), store->memory_usage(), elapsed.count());
+    custom_series_.push_back(std::move(store));
+    return true;
+}
+
+field_id_t Track::get_field_id(const std::string& field_name) const {
+    field_id_t id = field_ids_.find(field_name);
+    if (id != INVALID_FIELD) {
+        return id;
+    }
+    if (snapshot_) {
+        id = get_snapshot_field_id(field_name);
+        if (id != INVALID_FIELD) {
+            return id;
+        }
+    }
+    id = resolve_rider_field(field_name);
+    if (id != INVALID_FIELD) {
+        return id;
+    }
+    return resolve_segment_metadata_alias(field_name);
+}
+
+std::vector<std::string> Track::get_field_names() const {
+    std::vector<std::string> names;
+    names.reserve(field_ids_.size());
+    for (const auto& entry : field_ids_.entries()) {
+        names.push_back(entry.name);
+    }
+    if (snapshot_) {
+        for (const auto& record : snapshot_->section<snapshot::dictionary_record_t>(snapshot::Section::Dictionary)) {
+            names.emplace_back(snapshot_->string(record.name));
+        }
+    }
+    // not registered, but resolvable
+    for (const auto& [type, type_id] : segment_types_) {
+        auto instances = segments_lut_.find(type_id);
+        if (instances == segments_lut_.end()) {
+            continue;
+        }
+        for (const auto& [instance_idx, _] : instances->second) {
+            for (const auto& [partial_name, fid] : segment_metadata_partial_field_ids_) {
+                for (const auto& [list_name, list_id] : consts::segment_list::aliased) {
+                    names.push_back(consts::prefix::segment + type + "_" + std::string(list_name) + "_" +
+                                    std::to_string(instance_idx) + "_" + partial_name);
+                }
+            }
+        }
+    }
+    // rider standings, rN_ aliases of rider trackpoint fields are not listed
+    if (!riders_.empty()) {
+        names.push_back(consts::rider::count);
+    }
+    for (size_t number = 1; number <= riders_.size(); ++number) {
+        for (const auto& [field_name, _] : consts::rider::fields) {
+            names.push_back(consts::rider::prefix + std::to_string(number) + "_" + std::string(field_name));
+        }
+        for (const auto& [field_name, _] : consts::rider::ranked_fields) {
+            names.push_back(consts::rider::rank_prefix + std::to_string(number) + "_" + std::string(field_name));
+        }
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    return names;
+}
+
+Track::trackpoint_ts_view_t Track::get_trackpoint_timestamps() const {
+    return trackpoints_.timestamps();
+}
+
+Value Track::get(const std::string& key, time::microseconds_t timestamp) const {
+    field_id_t field_id = get_field_id(key);
+    return get(field_id, timestamp);
+}
+
+Value Track::get(field_id_t field_id, time::microseconds_t timestamp) const {
+    TrackCursor cursor;
+    return get(field_id, timestamp, cursor);
+}
+
+Value Track::get(field_id_t field_id, time::microseconds_t timestamp, TrackCursor& cursor) const {
+    if (field_id == INVALID_FIELD) {
+        log.debug("Invalid field id requested");
+        return Value();
+    }
+    
+    if (field_id & consts::mask::virtual_flag) { // virtual first to cover also segment virtuals and cumulative
+        if (field_id & consts::mask::trackpoint_flag) {
+            return get_cumulative_data(field_id, timestamp, cursor);
+        }
+        return get_virtual_data(field_id, timestamp);
+    } else if (field_id & consts::mask::segment_flag) { // segments second to cover also segment metadata
+        return get_segment_data(field_id, timestamp, cursor);
+    } else if (field_id & consts::mask::trackpoint_flag) { // then trackpoint in different flavors
+        if (field_id & consts::mask::lerp_flag) {
+            return get_lerp_trackpoint_data(field_id, timestamp, cursor);
+        } else if (field_id & consts::mask::pchip_flag) {
+            return get_pchip_trackpoint_data(field_id, timestamp, cursor);
+        } else {
+            return get_trackpoint_data(field_id, timestamp, cursor);
+        }
+    } else if (field_id & consts::mask::metadata_flag) { // metadata at the end
+        return get_metadata(field_id);
+    } else {
+        log.warning("Unparsable field id: {}", uint_to_hex(field_id));
+        return Value();
+    }
+}
 
-    auto tp_it = trackpoints_.upper_bound(timestamp);
+FieldHandle Track::bind(const std::string& field_name) const {
+    FieldHandle field = bind(get_field_id(field_name));
+    if (!field.is_valid()) {
+        log.debug("Failed to bind field: {}", field_name);
+    }
+    return field;
+}
 
-    if (tp_it != trackpoints_.begin()) {
-        --tp_it;
+/* same dispatch order as get(field_id_t, ...) */
+FieldHandle Track::bind(field_id_t field_id) const {
+    FieldHandle field;
+    if (field_id == INVALID_FIELD) {
+        return field;
+    }
+    field.id_ = field_id;
 
-        auto& tp_data = *(tp_it->second);
-        auto field_it = tp_data.find(field_id);
-        if (field_it != tp_data.end()) {
-            return field_it->second;
+    if (field_id & consts::mask::virtual_flag) {
+        field_id_t index = field_id & ~consts::mask::flags;
+        if (field_id & consts::mask::segment_flag) {
+            field.kind_ = FieldHandle::Kind::SegmentVirtual;
+        } else if (field_id & consts::mask::rider_flag) {
+            if (race_) {
+                field.kind_ = FieldHandle::Kind::Rider;
+            }
+        } else if (field_id & consts::mask::trackpoint_flag) {
+            field.series_ = get_cumulative_series(field_id);
+            if (field.series_) {
+                field.kind_ = FieldHandle::Kind::Cumulative;
+            }
+        } else if (index < static_cast<field_id_t>(VirtualField::Count)) {
+            field.kind_ = FieldHandle::Kind::Virtual;
+            field.virtual_ = static_cast<VirtualField>(index);
         }
+    } else if (field_id & consts::mask::segment_flag) {
+        field.kind_ = FieldHandle::Kind::Segment;
+    } else if (field_id & consts::mask::trackpoint_flag) {
+        FieldHandle::Kind kind = FieldHandle::Kind::Trackpoint;
+        field_id_t data_field_id = field_id;
+        if (field_id & consts::mask::lerp_flag) {
+            kind = FieldHandle::Kind::Lerp;
+            data_field_id ^= consts::mask::lerp_flag;
+        } else if (field_id & consts::mask::pchip_flag) {
+            kind = FieldHandle::Kind::Pchip;
+            data_field_id ^= consts::mask::pchip_flag;
+        }
+        field.store_ = get_trackpoint_store(data_field_id, field.column_);
+        if (field.store_) {
+            field.kind_ = kind;
+        }
+    } else if (field_id & consts::mask::metadata_flag) {
+        // metadata does not change after load
+        field.kind_ = FieldHandle::Kind::Metadata;
+        field.value_ = get_metadata(field_id);
+    }
+    return field;
+}
+
+Value Track::get(const FieldHandle& field, time::microseconds_t timestamp, TrackCursor& cursor) const {
+    validity_t validity;
+    return get(field, timestamp, cursor, validity);
+}
+
+Value Track::get(const FieldHandle& field, time::microseconds_t timestamp, TrackCursor& cursor, validity_t& validity) const {
+    validity.from = timestamp;
+    switch (field.kind_) {
+        case FieldHandle::Kind::Invalid:
+        case FieldHandle::Kind::Virtual:
+        case FieldHandle::Kind::Metadata:
+            return evaluate(field, timestamp, cursor, validity.until); // cheaper than the cache lookup
+        default:
+            break;
+    }
+
+    Value value;
+    if (!query_cache_.find(field.id_, timestamp, value, validity.until)) {
+        value = evaluate(field, timestamp, cursor, validity.until);
+        query_cache_.store(field.id_, timestamp, value, validity.until);
+    }
+    return value;
+}
+
+void Track::begin_frame(time::microseconds_t timestamp) {
+    if (live_) {
+        if (auto batch = live_->take()) {
+            apply_live_batch(*batch);
+        }
+    }
+    query_cache_.begin_frame(timestamp);
+}
+
+QueryCache::stats_t Track::get_query_cache_stats() const {
+    return query_cache_.stats();
+}
+
+Value Track::evaluate(const FieldHandle& field, time::microseconds_t timestamp, TrackCursor& cursor,
+                      time::microseconds_t& valid_until) const {
+    switch (field.kind_) {
+        case FieldHandle::Kind::Virtual:
+            valid_until = get_virtual_valid_until(field.virtual_, timestamp);
+            return get_virtual_value(field.virtual_, timestamp);
+        case FieldHandle::Kind::Cumulative:
+            valid_until = get_next_trackpoint_time(trackpoints_, timestamp, cursor);
+            return get_cumulative_value(*field.series_, timestamp, cursor);
+        case FieldHandle::Kind::SegmentVirtual:
+            valid_until = get_segment_valid_until(field.id_, timestamp);
+            return get_segment_virtual_data(field.id_, timestamp);
+        case FieldHandle::Kind::Rider:
+            valid_until = get_rider_valid_until(field.id_, timestamp);
+            return get_rider_data(field.id_, timestamp);
+        case FieldHandle::Kind::Segment:
+            valid_until = get_segment_valid_until(field.id_, timestamp);
+            if (field.id_ & consts::mask::trackpoint_flag) {
+                valid_until = std::min(valid_until, get_next_trackpoint_time(trackpoints_, timestamp, cursor));
+            }
+            return get_segment_data(field.id_, timestamp, cursor);
+        case FieldHandle::Kind::Trackpoint:
+            valid_until = get_next_trackpoint_time(*field.store_, timestamp, cursor);
+            return get_trackpoint_value(*field.store_, field.column_, timestamp, cursor);
+        case FieldHandle::Kind::Lerp:
+        case FieldHandle::Kind::Pchip:
+            {
+                Value value;
+                if (!get_baked_value(field, timestamp, value)) {
+                    value = (field.kind_ == FieldHandle::Kind::Lerp)
+                        ? get_lerp_trackpoint_value(*field.store_, field.column_, timestamp, cursor)
+                        : get_pchip_trackpoint_value(*field.store_, field.column_, timestamp, cursor);
+                }
+                // interpolated values change continuously, missing ones only when bounding trackpoints change
+                valid_until = value.is_valid() ? next_microsecond(timestamp) : get_next_trackpoint_time(*field.store_, timestamp, cursor);
+                return value;
+            }
+        case FieldHandle::Kind::Metadata:
+            valid_until = VALID_FOREVER;
+            return field.value_;
+        default:
+            valid_until = VALID_FOREVER;
+            return Value();
+    }
+}
+
+const WindowIndex* Track::get_window_index(const FieldHandle& field) const {
+    switch (field.kind_) {
+        case FieldHandle::Kind::Trackpoint:
+        case FieldHandle::Kind::Lerp:
+        case FieldHandle::Kind::Pchip:
+            break;
+        default:
+            log.warning("Window aggregates are only available for trackpoint fields, field: {}", uint_to_hex(field.id_));
+            return nullptr;
+    }
+    if (field.store_->column_type(field.column_) != TrackpointStore::ColumnType::Double) {
+        log.warning("Window aggregates are only available for numeric fields, field: {}", uint_to_hex(field.id_));
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(window_indexes_mutex_);
+    auto& index = window_indexes_[{field.store_, field.column_}];
+    if (!index) {
+        index = std::make_unique<WindowIndex>(*field.store_, field.column_);
+        log.info("Built window index for column {}: {} bytes", field.column_, index->memory_usage());
+    }
+    return index.get();
+}
+
+const MinMaxPyramid* Track::get_min_max_pyramid(const FieldHandle& field) const {
+    switch (field.kind_) {
+        case FieldHandle::Kind::Trackpoint:
+        case FieldHandle::Kind::Lerp:
+        case FieldHandle::Kind::Pchip:
+            break;
+        default:
+            log.debug("Min/max pyramid is only available for trackpoint fields, field: {}", uint_to_hex(field.id_));
+            return nullptr;
+    }
+    if (field.store_->column_type(field.column_) != TrackpointStore::ColumnType::Double) {
+        log.debug("Min/max pyramid is only available for numeric fields, field: {}", uint_to_hex(field.id_));
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(min_max_pyramids_mutex_);
+    auto& pyramid = min_max_pyramids_[{field.store_, field.column_}];
+    if (!pyramid) {
+        pyramid = std::make_unique<MinMaxPyramid>(*field.store_, field.column_);
+        log.info("Built min/max pyramid for column {}: {} bytes", field.column_, pyramid->memory_usage());
+    }
+    return pyramid.get();
+}
+
+void Track::set_frame_rate(uint32_t fps_n, uint32_t fps_d) {
+    if (baked_ && baked_->fps_n() == fps_n && baked_->fps_d() == fps_d) {
+        return;
+    }
+    auto timestamps = trackpoints_.timestamps();
+    if (fps_n == 0 || fps_d == 0 || timestamps.empty()) {
+        log.info("Frame rate {}/{} - interpolated fields will not be baked", fps_n, fps_d);
+        baked_.reset();
+        return;
+    }
+    if (trackpoints_.is_growing()) {
+        // frame grid is fixed to the track span when baked
+        log.info("Live track - interpolated fields will not be baked");
+        return;
+    }
+    // lerp and pchip slot per column
+    baked_ = std::make_unique<BakedTimeline>(fps_n, fps_d, timestamps.front(), timestamps.back(),
+                                             trackpoints_.column_count() * 2, consts::bake::memory_budget);
+    log.info("Interpolated fields will be baked at {}/{} fps, {} samples per field",
+             fps_n, fps_d, baked_->sample_count());
+}
+
+size_t Track::get_baked_memory_usage() const {
+    return baked_ ? baked_->memory_usage() : 0;
+}
+
+/* only double columns of track trackpoints can be interpolated, others are never baked */
+bool Track::get_baked_value(const FieldHandle& field, time::microseconds_t timestamp, Value& value) const {
+    if (!baked_ || field.store_ != &trackpoints_ ||
+        trackpoints_.column_type(field.column_) != TrackpointStore::ColumnType::Double) {
+        return false;
+    }
+
+    bool pchip = (field.kind_ == FieldHandle::Kind::Pchip);
+    size_t slot = field.column_ * 2 + (pchip ? 1 : 0);
+    double baked_value = 0.0;
+    bool found = baked_->get(slot, timestamp, baked_value,
+        [this, &field, pchip](time::microseconds_t sample_time, TrackCursor& cursor) {
+            Value v = pchip ? get_pchip_trackpoint_value(trackpoints_, field.column_, sample_time, cursor)
+                            : get_lerp_trackpoint_value(trackpoints_, field.column_, sample_time, cursor);
+            return v.is_valid() ? v.as_double() : std::numeric_limits<double>::quiet_NaN();
+        });
+    if (!found) {
+        return false;
+    }
+    value = std::isnan(baked_value) ? Value() : Value(baked_value);
+    return true;
+}
+
+time::microseconds_t Track::get_next_trackpoint_time(const TrackpointStore& store, time::microseconds_t timestamp, TrackCursor& cursor) const {
+    auto timestamps = store.timestamps();
+    size_t idx = store.floor_index(timestamp, cursor);
+    if (idx == TrackpointStore::npos) {
+        return timestamps.empty() ? VALID_FOREVER : timestamps.front();
+    }
+    if (idx + 1 < timestamps.size()) {
+        return timestamps[idx + 1];
+    }
+    return store.is_growing() ? next_microsecond(timestamp) : VALID_FOREVER;
+}
+
+/* segment lists only change at segment index boundaries, "all" list never */
+time::microseconds_t Track::get_segment_valid_until(field_id_t field_id, time::microseconds_t timestamp) const {
+    segment_field_id sfid(field_id);
+    if (sfid.list == consts::segment_list::all) {
+        return VALID_FOREVER;
+    }
+    const SegmentIndex* index = get_segment_index(sfid.type);
+    time::microseconds_t boundary = index ? index->next_boundary(timestamp) : time::INVALID_TIME;
+    return (boundary == time::INVALID_TIME) ? VALID_FOREVER : boundary;
+}
+
+Value Track::get_metadata(field_id_t field_id) const {
+    auto it = metadata_.find(field_id);
+    if (it != metadata_.end()) {
+        return it->second;
+    }
+    Value value;
+    if (snapshot_ && get_snapshot_metadata(field_id, value)) {
+        return value;
     }
     return Value();
 }
 
-Value Track::get_lerp_trackpoint_data(field_id_t field_id, time::microseconds_t timestamp) const {
-    field_id_t data_field_id = field_id ^ consts::mask::lerp_flag;
+Value Track::get_trackpoint_data(field_id_t field_id, time::microseconds_t timestamp, TrackCursor& cursor) const {
+    //TODO need to handle case where the data is stale?
+    size_t column = TrackpointStore::npos;
+    const TrackpointStore* store = get_trackpoint_store(field_id, column);
+    if (!store) {
+        return Value();
+    }
+    return get_trackpoint_value(*store, column, timestamp, cursor);
+}
 
-    auto upper_it = trackpoints_.upper_bound(timestamp);
-    if (upper_it != trackpoints_.begin() && upper_it != trackpoints_.end()) {
-        auto lower_it = std::prev(upper_it);
+Value Track::get_trackpoint_value(const TrackpointStore& store, size_t column, time::microseconds_t timestamp, TrackCursor& cursor) const {
+    size_t idx = store.floor_index(timestamp, cursor);
+    if (idx != TrackpointStore::npos && store.is_valid(column, idx)) {
+        return make_trackpoint_value(store, column, idx);
+    }
+    return Value();
+}
 
-        auto& lower_data = *(lower_it->second);
-        auto& upper_data = *(upper_it->second);
+Value Track::get_lerp_trackpoint_data(field_id_t field_id, time::microseconds_t timestamp, TrackCursor& cursor) const {
+    field_id_t data_field_id = field_id ^ consts::mask::lerp_flag;
 
-        auto lower_field_it = lower_data.find(data_field_id);
-        auto upper_field_it = upper_data.find(data_field_id);
+    size_t column = TrackpointStore::npos;
+    const TrackpointStore* store = get_trackpoint_store(data_field_id, column);
+    if (!store) {
+        log.debug("Field id {} not found in trackpoints for lerp interpolation", uint_to_hex(data_field_id));
+        return Value();
+    }
+    return get_lerp_trackpoint_value(*store, column, timestamp, cursor);
+}
 
-        if (lower_field_it != lower_data.end() && upper_field_it != upper_data.end()) {
-            Value lower_value = lower_field_it->second;
-            Value upper_value = upper_field_it->second;
+Value Track::get_lerp_trackpoint_value(const TrackpointStore& store, size_t column, time::microseconds_t timestamp, TrackCursor& cursor) const {
+    size_t lower = store.floor_index(timestamp, cursor);
+    if (lower != TrackpointStore::npos && lower + 1 < store.size()) {
+        size_t upper = lower + 1;
 
-            if (lower_value.is_double() && upper_value.is_double()) {
-                double lv = lower_value.as_double();
-                double uv = upper_value.as_double();
+        if (store.is_valid(column, lower) && store.is_valid(column, upper)) {
+            if (store.column_type(column) == TrackpointStore::ColumnType::Double) {
+                double lv = store.value(column, lower);
+                double uv = store.value(column, upper);
 
-                time::microseconds_t t0 = lower_it->first;
-                time::microseconds_t t1 = upper_it->first;
+                auto timestamps = store.timestamps();
+                time::microseconds_t t0 = timestamps[lower];
+                time::microseconds_t t1 = timestamps[upper];
 
                 double factor = static_cast<double>(timestamp - t0) / static_cast<double>(t1 - t0);
                 double interpolated_value = lv + factor * (uv - lv);
 
                 return Value(interpolated_value);
             } else {
-                log.warning("Lerp interpolation only supported for double values. Field id: {}", uint_to_hex(data_field_id));
+                log.warning("Lerp interpolation only supported for double values. Column: {}", column);
             }
         }
         else {
-            log.debug("Field id {} not found in both bounding trackpoints for lerp interpolation", uint_to_hex(data_field_id));
+            log.debug("Column {} not found in both bounding trackpoints for lerp interpolation", column);
         }
     } else {
         log.debug("Not enough trackpoints for lerp interpolation at timestamp {}", timestamp);
@@ -402,137 +1446,827 @@ Value Track::get_lerp_trackpoint_data(field_id_t field_id, time::microseconds_t
     return Value();
 }
 
-Value Track::get_pchip_trackpoint_data(field_id_t field_id, time::microseconds_t timestamp) const {
+Value Track::get_pchip_trackpoint_data(field_id_t field_id, time::microseconds_t timestamp, TrackCursor& cursor) const {
     field_id_t data_field_id = field_id ^ consts::mask::pchip_flag;
 
-    auto it2 = trackpoints_.upper_bound(timestamp);
-    auto it1 = (it2 != trackpoints_.begin()) ? std::prev(it2) : trackpoints_.end();
-    auto it0 = (it1 != trackpoints_.begin()) ? std::prev(it1) : trackpoints_.end();
-    auto it3 = (it2 != trackpoints_.end()) ? std::next(it2) : trackpoints_.end();
+    size_t column = TrackpointStore::npos;
+    const TrackpointStore* store = get_trackpoint_store(data_field_id, column);
+    if (!store) {
+        log.debug("Field id {} not found in trackpoints for PCHIP interpolation", uint_to_hex(data_field_id));
+        return Value();
+    }
+    return get_pchip_trackpoint_value(*store, column, timestamp, cursor);
+}
 
-    if (it0 == trackpoints_.end() || it1 == trackpoints_.end() ||
-        it2 == trackpoints_.end() || it3 == trackpoints_.end()) {
+Value Track::get_pchip_trackpoint_value(const TrackpointStore& store, size_t column, time::microseconds_t timestamp, TrackCursor& cursor) const {
+    size_t idx1 = store.floor_index(timestamp, cursor);
+    if (idx1 == TrackpointStore::npos || idx1 < 1 || idx1 + 2 >= store.size()) {
         log.debug("Not enough trackpoints for PCHIP interpolation at timestamp {}", timestamp);
         return Value();
     }
+    size_t idx0 = idx1 - 1;
+    size_t idx2 = idx1 + 1;
+    size_t idx3 = idx1 + 2;
 
-    auto data_it0 = it0->second->find(data_field_id);
-    auto data_it1 = it1->second->find(data_field_id);
-    auto data_it2 = it2->second->find(data_field_id);
-    auto data_it3 = it3->second->find(data_field_id);
+    if (!store.is_valid(column, idx0) || !store.is_valid(column, idx1) ||
+        !store.is_valid(column, idx2) || !store.is_valid(column, idx3)) {
+        log.debug("Column {} not found in all bounding trackpoints for PCHIP interpolation", column);
+        return Value();
+    }
 
-    if (data_it0 == it0->second->end() || data_it1 == it1->second->end() ||
-        data_it2 == it2->second->end() || data_it3 == it3->second->end()) {
-        log.debug("Field id {} not found in all bounding trackpoints for PCHIP interpolation", uint_to_hex(data_field_id));
+    if (store.column_type(column) != TrackpointStore::ColumnType::Double) {
+        log.warning("PCHIP interpolation only supported for double values. Column: {}", column);
         return Value();
     }
 
-    if (it0->first >= it1->first || it1->first >= it2->first || it2->first >= it3->first) {
-        log.error("Timestamps for PCHIP interpolation are not strictly increasing");
+    auto timestamps = store.timestamps();
+
+    double x1 = store.value(column, idx1);
+    if (timestamp == timestamps[idx1]) {
+        return Value(x1);
+    }
+    double x2 = store.value(column, idx2);
+
+    // derivatives at bounding trackpoints are precomputed at load time
+    double m1 = store.pchip_slope(column, idx1);
+    double m2 = store.pchip_slope(column, idx2);
+
+    double t1 = time::us_to_s(timestamps[idx1]);
+    double h = time::us_to_s(timestamps[idx2]) - t1;
+
+    // normalized parameter
+    double s = (time::us_to_s(timestamp) - t1) / h;
+
+    // cubic hermite polynomial in horner form
+    double c2 = 3 * (x2 - x1) - h * (2 * m1 + m2);
+    double c3 = 2 * (x1 - x2) + h * (m1 + m2);
+    double x = x1 + s * (h * m1 + s * (c2 + s * c3));
+
+    return Value(x);
+}
+
+Value Track::get_virtual_data(field_id_t field_id, time::microseconds_t timestamp) const {
+    if (field_id & consts::mask::segment_flag) {
+        return get_segment_virtual_data(field_id, timestamp);
+    }
+    if (field_id & consts::mask::rider_flag) {
+        return get_rider_data(field_id, timestamp);
+    }
+
+    field_id_t index = field_id & ~consts::mask::flags;
+    if (index < static_cast<field_id_t>(VirtualField::Count)) {
+        return get_virtual_value(static_cast<VirtualField>(index), timestamp);
+    }
+
+    log.warning("Unknown virtual field id: {}", uint_to_hex(field_id));
+    return Value();
+}
+
+Value Track::get_virtual_value(VirtualField field, time::microseconds_t timestamp) const {
+    switch (field) {
+        case VirtualField::Timestamp:
+            return Value(time::time_point_t(start_time_ + std::chrono::microseconds(timestamp - start_offset_)));
+        case VirtualField::VideoTime:
+            return Value(time::us_to_s(timestamp));
+        case VirtualField::TimeElapsed:
+            if (min_timestamp_ != time::INVALID_TIME) {
+                return Value(time::us_to_s(timestamp - min_timestamp_));
+            }
+            return Value();
+        case VirtualField::TimeRemaining:
+            if (max_timestamp_ != 0) {
+                return Value(time::us_to_s(max_timestamp_ - timestamp));
+            }
+            return Value();
+        case VirtualField::Active:
+            if (min_timestamp_ != time::INVALID_TIME && max_timestamp_ != 0) {
+                return Value(timestamp >= min_timestamp_ && timestamp <= max_timestamp_);
+            }
+            return Value(false);
+        case VirtualField::Countdown:
+            if (min_timestamp_ != time::INVALID_TIME && min_timestamp_ > timestamp) {
+                return Value(time::us_to_s(min_timestamp_ - timestamp));
+            }
+            return Value();
+        case VirtualField::Overtime:
+            if (max_timestamp_ != 0 && timestamp > max_timestamp_) {
+                return Value(time::us_to_s(timestamp - max_timestamp_));
+            }
+            return Value();
+        case VirtualField::Count:
+            break;
+    }
+    return Value();
+}
+
+time::microseconds_t Track::get_virtual_valid_until(VirtualField field, time::microseconds_t timestamp) const {
+    bool has_start = min_timestamp_ != time::INVALID_TIME;
+    bool has_end = max_timestamp_ != 0;
+    switch (field) {
+        case VirtualField::Timestamp:
+        case VirtualField::VideoTime:
+            return next_microsecond(timestamp);
+        case VirtualField::TimeElapsed:
+            return has_start ? next_microsecond(timestamp) : VALID_FOREVER;
+        case VirtualField::TimeRemaining:
+            return has_end ? next_microsecond(timestamp) : VALID_FOREVER;
+        case VirtualField::Active:
+            if (!has_start || !has_end || timestamp > max_timestamp_) {
+                return trackpoints_.is_growing() ? next_microsecond(timestamp) : VALID_FOREVER;
+            }
+            return (timestamp < min_timestamp_) ? min_timestamp_ : max_timestamp_ + 1;
+        case VirtualField::Countdown:
+            return (has_start && timestamp < min_timestamp_) ? next_microsecond(timestamp) : VALID_FOREVER;
+        case VirtualField::Overtime:
+            if (!has_end) {
+                return VALID_FOREVER;
+            }
+            return (timestamp <= max_timestamp_) ? max_timestamp_ + 1 : next_microsecond(timestamp);
+        case VirtualField::Count:
+            break;
+    }
+    return VALID_FOREVER;
+}
+
+/* s_TYPE[_LIST]_count - type and list are decoded from the field id itself */
+Value Track::get_segment_virtual_data(field_id_t field_id, time::microseconds_t timestamp) const {
+    segment_field_id sfid(field_id);
+    if (sfid.field != consts::field::segment::virt::id::count) {
+        log.warning("Unknown segment virtual field id: {}", uint_to_hex(field_id));
         return Value();
     }
 
-    if (timestamp < it1->first || timestamp > it2->first) {
-        log.error("Timestamp {} for PCHIP interpolation is out of bounds [{}, {}]", timestamp, it1->first, it2->first);
+    if (sfid.list == consts::segment_list::all) {
+        auto it = segments_lut_.find(sfid.type);
+        return Value(static_cast<double>(it != segments_lut_.end() ? it->second.size() : 0));
+    }
+
+    const SegmentIndex* index = get_segment_index(sfid.type);
+    if (!index) {
+        return Value(0.0);
+    }
+    switch (sfid.list) {
+        case consts::segment_list::active:
+            return Value(static_cast<double>(index->active_count(timestamp)));
+        case consts::segment_list::prev:
+            return Value(static_cast<double>(index->prev_count(timestamp)));
+        case consts::segment_list::next:
+            return Value(static_cast<double>(index->next_count(timestamp)));
+    }
+
+    log.warning("Unknown segment virtual field id: {}", uint_to_hex(field_id));
+    return Value();
+}
+
+/* rider_count, rN_FIELD and rank_N_FIELD - standings are moved to the timestamp by the first query of a frame */
+Value Track::get_rider_data(field_id_t field_id, time::microseconds_t timestamp) const {
+    field_id_t field = (field_id & consts::mask::rider::field) >> std::countr_zero(consts::mask::rider::field);
+    size_t index = static_cast<size_t>((field_id & consts::mask::rider::index) >> std::countr_zero(consts::mask::rider::index));
+    if (field == consts::rider::id::count) {
+        return Value(static_cast<double>(riders_.size()));
+    }
+    if (!race_ || index >= riders_.size()) {
+        log.warning("Unknown rider field id: {}", uint_to_hex(field_id));
         return Value();
     }
 
-    double t = time::us_to_s(timestamp);
+    std::lock_guard<std::mutex> lock(race_mutex_);
+    race_->update(timestamp);
+    size_t rider = (field_id & consts::mask::rider::ranked) ? race_->rider_at(index) : index;
+    switch (field) {
+        case consts::rider::id::rank:
+            return Value(static_cast<double>(race_->rank(rider) + 1));
+        case consts::rider::id::gap:
+            return std::isnan(race_->gap(rider)) ? Value() : Value(race_->gap(rider));
+        case consts::rider::id::distance:
+            return std::isnan(race_->distance(rider)) ? Value() : Value(race_->distance(rider));
+        case consts::rider::id::name:
+            return Value(riders_[rider].name);
+        case consts::rider::id::rider:
+            return Value(static_cast<double>(rider + 1));
+    }
+
+    log.warning("Unknown rider field id: {}", uint_to_hex(field_id));
+    return Value();
+}
+
+/* standings change continuously, only rider count and name of a rider (not of a rank) are constant */
+time::microseconds_t Track::get_rider_valid_until(field_id_t field_id, time::microseconds_t timestamp) const {
+    field_id_t field = (field_id & consts::mask::rider::field) >> std::countr_zero(consts::mask::rider::field);
+    bool constant = (field == consts::rider::id::count) ||
+                    (field == consts::rider::id::name && !(field_id & consts::mask::rider::ranked));
+    return constant ? VALID_FOREVER : next_microsecond(timestamp);
+}
+
+/* rider_count, rN_FIELD, rank_N_FIELD and rN_ aliases of rider trackpoint fields - rN_point_speed,
+ * rN_lerp_point_speed, rN_avg_point_speed ... of N-th rider resolve to its merged point_rN_speed ... */
+field_id_t Track::resolve_rider_field(std::string_view name) const {
+    if (riders_.empty()) {
+        return INVALID_FIELD;
+    }
+    auto make_id = [](field_id_t field, size_t index, bool ranked) {
+        return consts::mask::virtual_flag | consts::mask::rider_flag | (ranked ? consts::mask::rider::ranked : 0) |
+               ((field << std::countr_zero(consts::mask::rider::field)) & consts::mask::rider::field) |
+               (static_cast<field_id_t>(index) & consts::mask::rider::index);
+    };
+    if (name == consts::rider::count) {
+        return make_id(consts::rider::id::count, 0, false);
+    }
+
+    bool ranked = name.starts_with(consts::rider::rank_prefix);
+    if (!ranked && !name.starts_with(consts::rider::prefix)) {
+        return INVALID_FIELD;
+    }
+    std::string_view rest = name.substr(ranked ? consts::rider::rank_prefix.size() : consts::rider::prefix.size());
+    size_t number = 0;
+    auto [ptr, ec] = std::from_chars(rest.data(), rest.data() + rest.size(), number);
+    if (ec != std::errc() || ptr == rest.data() + rest.size() || *ptr != '_' || number == 0 || number > riders_.size()) {
+        return INVALID_FIELD;
+    }
+    rest = rest.substr(static_cast<size_t>(ptr - rest.data()) + 1);
+
+    for (const auto& [field_name, field] : ranked ? consts::rider::ranked_fields : consts::rider::fields) {
+        if (rest == field_name) {
+            return make_id(field, number - 1, ranked);
+        }
+    }
+    if (ranked) {
+        return INVALID_FIELD;
+    }
+
+    const std::string& prefix = riders_[number - 1].prefix;
+    if (prefix.empty()) {
+        return get_field_id(std::string(rest));
+    }
+    size_t pos = rest.find(consts::prefix::trackpoint);
+    if (pos == std::string_view::npos) {
+        return INVALID_FIELD; // segments and metadata are taken from the first source only
+    }
+    pos += consts::prefix::trackpoint.size();
+    return get_field_id(std::string(rest.substr(0, pos)) + prefix + std::string(rest.substr(pos)));
+}
+
+bool Track::load_snapshot(const std::string& path, const snapshot::source_t& source) {
+    TRACE_EVENT_BEGIN(EV_TRACK_LOAD_SNAPSHOT);
+
+    auto snap = std::make_unique<TrackSnapshot>();
+    if (!snap->open(path, source)) {
+        TRACE_EVENT_END(EV_TRACK_LOAD_SNAPSHOT);
+        return false;
+    }
+
+    auto broken = [this, &path](const char* what) {
+        log.warning("Broken track snapshot {}: {}", path, what);
+        TRACE_EVENT_END(EV_TRACK_LOAD_SNAPSHOT);
+        return false;
+    };
+
+    auto info_records = snap->section<snapshot::info_t>(snapshot::Section::Info);
+    if (info_records.size() != 1) {
+        return broken("info");
+    }
+    const auto& info = info_records.front();
+
+    auto timestamps = snap->array<time::microseconds_t>(info.timestamps);
+    if (timestamps.size() != info.timestamps.count) {
+        return broken("timestamps");
+    }
+    size_t count = timestamps.size();
+
+    // validate all views before touching track state
+    std::map<field_id_t, size_t> columns;
+    std::vector<TrackpointStore::column_view_t> column_views;
+    for (const auto& record : snap->section<snapshot::column_record_t>(snapshot::Section::Columns)) {
+        auto type = static_cast<TrackpointStore::ColumnType>(record.type);
+        auto values = snap->array<double>(record.values);
+        auto validity = snap->array<uint64_t>(record.validity);
+        auto slopes = snap->array<double>(record.slopes);
+
+        bool is_double = type == TrackpointStore::ColumnType::Double;
+        if ((!is_double && type != TrackpointStore::ColumnType::TimePoint) ||
+            values.size() != count || validity.size() != (count + 63) / 64 ||
+            slopes.size() != (is_double ? count : 0)) {
+            return broken("trackpoint column");
+        }
+
+        columns[record.field_id] = column_views.size();
+        column_views.push_back({type, values, validity, slopes});
+    }
+
+    std::map<field_id_t, SegmentIndex::arrays_t> indexes;
+    for (const auto& record : snap->section<snapshot::segment_index_record_t>(snapshot::Section::SegmentIndexes)) {
+        SegmentIndex::arrays_t arrays{
+            snap->array<time::microseconds_t>(record.starts),
+            snap->array<uint32_t>(record.by_start),
+            snap->array<time::microseconds_t>(record.ends),
+            snap->array<uint32_t>(record.by_end),
+            snap->array<time::microseconds_t>(record.boundaries),
+            snap->array<uint32_t>(record.active_offsets),
+            snap->array<uint32_t>(record.active),
+        };
+
+        if (arrays.starts.size() != record.starts.count || arrays.by_start.size() != arrays.starts.size() ||
+            arrays.ends.size() != arrays.starts.size() || arrays.by_end.size() != arrays.starts.size() ||
+            arrays.boundaries.size() != record.boundaries.count ||
+            arrays.active_offsets.size() != arrays.boundaries.size() + 1 ||
+            arrays.active.size() != record.active.count ||
+            arrays.active_offsets.back() != arrays.active.size()) {
+            return broken("segment index");
+        }
+        indexes[record.type_id] = arrays;
+    }
+
+    start_time_ = time::time_point_t(time::time_point_t::duration(info.start_time));
+    min_timestamp_ = info.min_timestamp;
+    max_timestamp_ = info.max_timestamp;
+    next_field_id_ = info.next_field_id;
+    next_segment_metadata_field_id_ = info.next_segment_metadata_field_id;
+
+    for (const auto& record : snap->section<snapshot::named_id_record_t>(snapshot::Section::SegmentTypes)) {
+        segment_types_[std::string(snap->string(record.name))] = record.id;
+    }
+    for (const auto& record : snap->section<snapshot::named_id_record_t>(snapshot::Section::SegmentFields)) {
+        segment_metadata_partial_field_ids_[std::string(snap->string(record.name))] = record.id;
+    }
+    for (const auto& record : snap->section<snapshot::segment_record_t>(snapshot::Section::Segments)) {
+        segments_lut_[record.type_id][record.instance] = {
+            time::time_point_t(time::time_point_t::duration(record.start_time)),
+            time::time_point_t(time::time_point_t::duration(record.end_time))};
+    }
+
+    trackpoint_columns_ = std::move(columns);
+    trackpoints_.attach(timestamps, std::move(column_views));
+    for (const auto& [type_id, arrays] : indexes) {
+        segment_index_[type_id].attach(arrays);
+    }
+
+    snapshot_ = std::move(snap);
+
+    // virtual fields are code, not data - register them again
+    generate_segment_virtual_metadata_fields();
+    generate_cumulative_fields();
+    generate_segment_point_fields();
+    build_segment_metadata_index();
+
+    log.info("Loaded track from snapshot: {} trackpoints, {} fields, {} segment types",
+             trackpoints_.size(), trackpoints_.column_count(), segment_types_.size());
+
+    TRACE_EVENT_END(EV_TRACK_LOAD_SNAPSHOT);
+    return true;
+}
+
+bool Track::save_snapshot(const std::string& path, const snapshot::source_t& source) const {
+    TRACE_EVENT_BEGIN(EV_TRACK_SAVE_SNAPSHOT);
+
+    TrackSnapshotWriter writer;
+
+    // sorted by name - lookups binary search the mapped records
+    std::vector<const FieldDictionary::entry_t*> entries;
+    entries.reserve(field_ids_.size());
+    for (const auto& entry : field_ids_.entries()) {
+        entries.push_back(&entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto* a, const auto* b) {
+        return a->name < b->name;
+    });
+    std::vector<snapshot::dictionary_record_t> dictionary;
+    dictionary.reserve(entries.size());
+    for (const auto* entry : entries) {
+        dictionary.push_back({writer.add_string(entry->name), entry->id});
+    }
+
+    std::vector<snapshot::metadata_record_t> metadata;
+    metadata.reserve(metadata_.size());
+    for (const auto& [id, value] : metadata_) {
+        snapshot::metadata_record_t record{id, snapshot::ValueType::Invalid, 0, 0};
+        if (value.is_double()) {
+            record.type = snapshot::ValueType::Double;
+            record.payload = std::bit_cast<uint64_t>(value.as_double());
+        } else if (value.is_bool()) {
+            record.type = snapshot::ValueType::Bool;
+            record.payload = value.as_bool() ? 1 : 0;
+        } else if (value.is_string()) {
+            auto ref = writer.add_string(value.as_string());
+            record.type = snapshot::ValueType::String;
+            record.payload = (static_cast<uint64_t>(ref.offset) << 32) | ref.length;
+        } else if (value.is_time_point()) {
+            record.type = snapshot::ValueType::TimePoint;
+            record.payload = static_cast<uint64_t>(value.as_time_point().time_since_epoch().count());
+        }
+        metadata.push_back(record);
+    }
+
+    snapshot::info_t info{};
+    info.start_time = start_time_.time_since_epoch().count();
+    info.min_timestamp = min_timestamp_;
+    info.max_timestamp = max_timestamp_;
+    info.next_field_id = next_field_id_;
+    info.next_segment_metadata_field_id = next_segment_metadata_field_id_;
+    info.timestamps = writer.add_array(trackpoints_.timestamps());
 
-    double t0 = time::us_to_s(it0->first);
-    double t1 = time::us_to_s(it1->first);
-    double t2 = time::us_to_s(it2->first);
-    double t3 = time::us_to_s(it3->first);
+    std::vector<snapshot::column_record_t> columns(trackpoints_.column_count());
+    for (const auto& [field_id, column] : trackpoint_columns_) {
+        auto view = trackpoints_.column(column);
+        columns[column] = {field_id,
+                           static_cast<uint32_t>(view.type),
+                           0,
+                           writer.add_array(view.values),
+                           writer.add_array(view.validity),
+                           writer.add_array(view.slopes)};
+    }
+
+    std::vector<snapshot::named_id_record_t> segment_types;
+    for (const auto& [name, id] : segment_types_) {
+        segment_types.push_back({writer.add_string(name), id});
+    }
+
+    std::vector<snapshot::named_id_record_t> segment_fields;
+    for (const auto& [name, id] : segment_metadata_partial_field_ids_) {
+        segment_fields.push_back({writer.add_string(name), id});
+    }
+
+    std::vector<snapshot::segment_record_t> segments;
+    for (const auto& [type_id, instances] : segments_lut_) {
+        for (const auto& [instance_idx, times] : instances) {
+            segments.push_back({type_id, instance_idx,
+                                times.first.time_since_epoch().count(),
+                                times.second.time_since_epoch().count()});
+        }
+    }
 
-    if (t == t1) {
-        return Value(data_it1->second);
+    std::vector<snapshot::segment_index_record_t> indexes;
+    for (const auto& [type_id, index] : segment_index_) {
+        const auto& arrays = index.arrays();
+        indexes.push_back({type_id,
+                           writer.add_array(arrays.starts),
+                           writer.add_array(arrays.by_start),
+                           writer.add_array(arrays.ends),
+                           writer.add_array(arrays.by_end),
+                           writer.add_array(arrays.boundaries),
+                           writer.add_array(arrays.active_offsets),
+                           writer.add_array(arrays.active)});
     }
-    if (t == t2) {
-        return Value(data_it2->second);
+
+    writer.set_section(snapshot::Section::Info, std::span<const snapshot::info_t>(&info, 1));
+    writer.set_section<snapshot::dictionary_record_t>(snapshot::Section::Dictionary, dictionary);
+    writer.set_section<snapshot::metadata_record_t>(snapshot::Section::Metadata, metadata);
+    writer.set_section<snapshot::column_record_t>(snapshot::Section::Columns, columns);
+    writer.set_section<snapshot::named_id_record_t>(snapshot::Section::SegmentTypes, segment_types);
+    writer.set_section<snapshot::named_id_record_t>(snapshot::Section::SegmentFields, segment_fields);
+    writer.set_section<snapshot::segment_record_t>(snapshot::Section::Segments, segments);
+    writer.set_section<snapshot::segment_index_record_t>(snapshot::Section::SegmentIndexes, indexes);
+
+    bool ok = writer.write(path, source);
+
+    TRACE_EVENT_END(EV_TRACK_SAVE_SNAPSHOT);
+    return ok;
+}
+
+field_id_t Track::get_snapshot_field_id(const std::string& field_name) const {
+    auto dictionary = snapshot_->section<snapshot::dictionary_record_t>(snapshot::Section::Dictionary);
+    auto it = std::lower_bound(dictionary.begin(), dictionary.end(), std::string_view(field_name),
+                               [this](const snapshot::dictionary_record_t& record, std::string_view name) {
+                                   return snapshot_->string(record.name) < name;
+                               });
+    if (it != dictionary.end() && snapshot_->string(it->name) == field_name) {
+        return it->field_id;
+    }
+    return INVALID_FIELD;
+}
+
+bool Track::get_snapshot_metadata(field_id_t field_id, Value& value) const {
+    auto metadata = snapshot_->section<snapshot::metadata_record_t>(snapshot::Section::Metadata);
+    auto it = std::lower_bound(metadata.begin(), metadata.end(), field_id,
+                               [](const snapshot::metadata_record_t& record, field_id_t id) {
+                                   return record.field_id < id;
+                               });
+    if (it == metadata.end() || it->field_id != field_id) {
+        return false;
+    }
+
+    switch (it->type) {
+        case snapshot::ValueType::Double:
+            value = Value(std::bit_cast<double>(it->payload));
+            break;
+        case snapshot::ValueType::Bool:
+            value = Value(it->payload != 0);
+            break;
+        case snapshot::ValueType::String:
+            {
+                snapshot::string_ref_t ref{static_cast<uint32_t>(it->payload >> 32),
+                                           static_cast<uint32_t>(it->payload & 0xFFFFFFFF)};
+                value = Value(snapshot_->string(ref));
+            }
+            break;
+        case snapshot::ValueType::TimePoint:
+            value = Value(time::time_point_t(time::time_point_t::duration(static_cast<int64_t>(it->payload))));
+            break;
+        default:
+            value = Value();
+            break;
+    }
+    return true;
+}
+
+bool Track::parse_gpx(pugi::xml_node node) {
+    log.info("Parsing GPX root node");
+
+    bool ok = true;
+
+    pugi::xml_node metadata = node.child("metadata");
+    if (metadata) {
+        ok = parse_metadata(metadata) && ok;
+    }
+
+    pugi::xml_node trk = node.child("trk");
+    if (trk) {
+        ok = parse_trk(trk) && ok;
     }
 
-    double x0 = data_it0->second.as_double();
-    double x1 = data_it1->second.as_double();
-    double x2 = data_it2->second.as_double();
-    double x3 = data_it3->second.as_double();
+    return ok;
+}
+
+/* Streaming counterpart of parse_gpx. Only metadata, trk header fields,
+ * trk extensions and single trkpts are parsed with pugixml, one at a time.
+ * Relies on schema order within trk (header, extensions, then trksegs) to
+ * register fields in the same order as the DOM path. Start time is not
+ * known until all trackpoints are read, so they are staged relative to
+ * epoch and shifted when the store is built.
+ *
+ * Trkpts are collected into batches. With more than one worker, batches
+ * are parsed into TrackpointChunks on worker threads while the file is
+ * still being read, and merged on this thread in document order. */
+bool Track::parse_gpx_stream(const std::string& path, size_t worker_count) {
+    log.info("Parsing GPX root node (stream)");
+
+    struct trkpt_batch_t {
+        std::string text;
+        std::vector<std::pair<size_t, size_t>> fragments; // offset, length within text
+        TrackpointChunk chunk;
+    };
+
+    class GpxHandler : public XmlStreamReader::Handler {
+    public:
+        GpxHandler(Track& track, ParseWorkers* workers) : track_(track), workers_(workers) {}
+
+        bool on_start(std::string_view name, size_t depth) override {
+            if (depth == 0) {
+                root_ok = (name == "gpx");
+                return false;
+            }
+            if (!root_ok) {
+                return false;
+            }
+
+            if (depth == 1) {
+                if (name == "metadata" && !metadata_done_) {
+                    return true;
+                }
+                if (name == "trk" && !trk_seen) {
+                    track_.log.info("Parsing GPX track");
+                    trk_seen = true;
+                    in_trk_ = true;
+                }
+            } else if (depth == 2 && in_trk_) {
+                for (auto& field : header_) {
+                    if (name == field.key) {
+                        return !field.seen;
+                    }
+                }
+                if (name == "extensions" && !extensions_done_) {
+                    flush_header();
+                    return true;
+                }
+                if (name == "trkseg") {
+                    flush_header();
+                    track_.log.info("Parsing GPX track segment");
+                    in_trkseg_ = true;
+                }
+            } else if (depth == 3 && in_trkseg_) {
+                return name == "trkpt";
+            }
+            return false;
+        }
+
+        void on_fragment(std::string_view name, std::string_view fragment, size_t depth) override {
+            if (depth == 3) {
+                if (!batch_) {
+                    batch_ = std::make_shared<trkpt_batch_t>();
+                }
+                batch_->fragments.emplace_back(batch_->text.size(), fragment.size());
+                batch_->text.append(fragment);
+                if (batch_->fragments.size() >= consts::stream::batch_size) {
+                    submit_batch();
+                }
+                return;
+            }
+
+            // anything else may register fields - trackpoints before it have to be merged first
+            drain();
+
+            pugi::xml_parse_result result = doc_.load_buffer(fragment.data(), fragment.size());
+            if (!result) {
+                track_.log.error("Failed to parse <{}> element: {}", name, result.description());
+                ok = false;
+                return;
+            }
+            pugi::xml_node node = doc_.first_child();
+
+            if (depth == 1) {
+                metadata_done_ = true;
+                ok = track_.parse_metadata(node) && ok;
+            } else if (depth == 2 && name == "extensions") {
+                extensions_done_ = true;
+                ok = track_.parse_trk_ext(node) && ok;
+            } else if (depth == 2) {
+                for (auto& field : header_) {
+                    if (name == field.key) {
+                        field.seen = true;
+                        field.value = node.text().as_string();
+                        if (header_flushed_) {
+                            store_header_field(field);
+                        }
+                    }
+                }
+            }
+        }
+
+        void on_end(std::string_view name, size_t depth) override {
+            if (depth == 1 && name == "trk" && in_trk_) {
+                flush_header();
+                in_trk_ = false;
+            } else if (depth == 2 && name == "trkseg") {
+                in_trkseg_ = false;
+            }
+        }
+
+        /* parses and merges all collected trkpts */
+        void drain() {
+            submit_batch();
+            while (!pending_.empty()) {
+                merge_front();
+            }
+        }
+
+        bool ok = true;
+        bool root_ok = false;
+        bool trk_seen = false;
+        time::time_point_t start_time = time::INVALID_TIME_POINT;
+
+    private:
+        static void parse_batch(const Track& track, trkpt_batch_t& batch) {
+            pugi::xml_document doc;
+            auto& chunk = batch.chunk;
+            for (auto [offset, length] : batch.fragments) {
+                pugi::xml_parse_result result = doc.load_buffer(batch.text.data() + offset, length);
+                if (!result) {
+                    track.log.error("Failed to parse <trkpt> element: {}", result.description());
+                    chunk.ok = false;
+                    continue;
+                }
+                pugi::xml_node node = doc.first_child();
+
+                auto timestamp = track.parse_trkpt_time(node);
+                if (timestamp != time::INVALID_TIME_POINT &&
+                    (chunk.start_time == time::INVALID_TIME_POINT || timestamp < chunk.start_time)) {
+                    chunk.start_time = timestamp;
+                }
+                chunk.ok = track.parse_trkpt(node, timestamp, chunk) && chunk.ok;
+            }
+            batch.text = {};
+            batch.fragments = {};
+        }
+
+        void merge(const trkpt_batch_t& batch) {
+            const auto& chunk = batch.chunk;
+            ok = chunk.ok && ok;
+            if (chunk.start_time != time::INVALID_TIME_POINT &&
+                (start_time == time::INVALID_TIME_POINT || chunk.start_time < start_time)) {
+                start_time = chunk.start_time;
+            }
+            track_.merge_trackpoint_chunk(chunk);
+        }
 
-    //pchip interpolation algorithm
+        void merge_front() {
+            auto& [batch, done] = pending_.front();
+            done.get();
+            merge(*batch);
+            pending_.pop_front();
+        }
 
-    // intervals
-    double h0 = t1 - t0;
-    double h1 = t2 - t1;
-    double h2 = t3 - t2;
+        void submit_batch() {
+            if (!batch_) {
+                return;
+            }
+            auto batch = std::move(batch_);
 
-    // secant slopes
-    double d0 = (x1 - x0) / h0;
-    double d1 = (x2 - x1) / h1;
-    double d2 = (x3 - x2) / h2;
+            if (!workers_) {
+                parse_batch(track_, *batch);
+                merge(*batch);
+                return;
+            }
 
-    // derivative at t1
-    double m1 = 0;
-    if (d0 * d1 > 0) {
-        m1 = (h0 + h1) / ((h1 / d0) + (h0 / d1));
-    }
+            if (pending_.size() >= workers_->size() * consts::stream::pending_batches_per_worker) {
+                merge_front();
+            }
+            auto task = std::make_shared<std::packaged_task<void()>>(
+                [&track = std::as_const(track_), batch]() { parse_batch(track, *batch); });
+            pending_.emplace_back(batch, task->get_future());
+            workers_->submit([task]() { (*task)(); });
+        }
 
-    // defivative at t2
-    double m2 = 0;
-    if (d1 * d2 > 0) {
-        m2 = (h1 + h2) / ((h2 / d1) + (h1 / d2));
-    }
+        struct header_field_t {
+            const char* key;
+            bool seen = false;
+            std::string value;
+        };
 
-    // normalized parameter
-    double s = (t - t1) / h1;
+        void store_header_field(const header_field_t& field) {
+            track_.log.debug("Track {}: {}", field.key, field.value);
+            track_.store_metadata(field.key, field.value);
+        }
 
-    // hermite basiss
-    double h00 = 2 * std::pow(s, 3) - 3 * std::pow(s, 2) + 1;
-    double h10 = std::pow(s, 3) - 2 * std::pow(s, 2) + s;
-    double h01 = -2 * std::pow(s, 3) + 3 * std::pow(s, 2);
-    double h11 = std::pow(s, 3) - std::pow(s, 2);
+        // trk name/src/type are stored before extensions, like in parse_trk
+        void flush_header() {
+            if (header_flushed_) {
+                return;
+            }
+            header_flushed_ = true;
+            for (const auto& field : header_) {
+                if (field.seen) {
+                    store_header_field(field);
+                }
+            }
+        }
 
-    // interpolated value
-    double x = h00 * x1 + h10 * h1 * m1 + h01 * x2 + h11 * h1 * m2;
+        Track& track_;
+        ParseWorkers* workers_;
+        pugi::xml_document doc_;
 
-    return Value(x);
-}
+        std::shared_ptr<trkpt_batch_t> batch_;
+        std::deque<std::pair<std::shared_ptr<trkpt_batch_t>, std::future<void>>> pending_;
 
-Value Track::get_virtual_data(field_id_t field_id, time::microseconds_t timestamp) const {
-    auto it = virtual_data_mapping_.find(field_id);
-    if (it != virtual_data_mapping_.end()) {
-        return it->second(timestamp);
-    }
+        bool metadata_done_ = false;
+        bool extensions_done_ = false;
+        bool header_flushed_ = false;
+        bool in_trk_ = false;
+        bool in_trkseg_ = false;
+        header_field_t header_[3] = {{"name"}, {"src"}, {"type"}};
+    };
 
-    log.warning("Unknown virtual field id: {}", uint_to_hex(field_id));
-    return Value();
-}
+    // stage trackpoints relative to epoch until real start time is known
+    start_time_ = time::time_point_t{};
 
-bool Track::parse_gpx(pugi::xml_node node) {
-    log.info("Parsing GPX root node");
+    std::unique_ptr<ParseWorkers> workers;
+    if (worker_count > 1) {
+        log.info("Parsing trackpoints with {} worker threads", worker_count);
+        workers = std::make_unique<ParseWorkers>(worker_count);
+    }
 
-    bool ok = true;
+    GpxHandler handler(*this, workers.get());
+    XmlStreamReader reader;
+    bool read_ok = reader.read(path, handler);
+    handler.drain();
+    if (!read_ok) {
+        log.error("Failed to load track file: {}", path);
+        return false;
+    }
 
-    pugi::xml_node metadata = node.child("metadata");
-    if (metadata) {
-        ok = parse_metadata(metadata) && ok;
+    if (!handler.root_ok) {
+        log.error("No <gpx> root node found in track file");
+        return false;
+    }
+    if (!handler.trk_seen) {
+        return handler.ok;
     }
 
-    pugi::xml_node trk = node.child("trk");
-    if (trk) {
-        ok = parse_trk(trk) && ok;
+    if (handler.start_time == time::INVALID_TIME_POINT) {
+        log.error("Failed to find valid start timestamp in track");
+        return false;
     }
+    start_time_ = handler.start_time;
+    log.info("Track start time: {}", std::format("{}", start_time_));
 
-    return ok;
+    auto start_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        start_time_.time_since_epoch()).count();
+
+    build_segment_index();
+    build_trackpoint_store(-start_us);
+
+    return handler.ok;
 }
 
-Value Track::get_segment_data(field_id_t field_id, time::microseconds_t timestamp) const {
+Value Track::get_segment_data(field_id_t field_id, time::microseconds_t timestamp, TrackCursor& cursor) const {
     field_id_t flags = field_id & consts::mask::flags;
     segment_field_id sfid(field_id);
 
     switch (sfid.list) {
         case consts::segment_list::active:
             {
-                std::vector<field_id_t> segments = get_active_segments_ordered(sfid.type, timestamp);
-                if (segments.size() > sfid.segment) {
-                    sfid.segment = segments[sfid.segment];
+                const SegmentIndex* index = get_segment_index(sfid.type);
+                uint32_t segment = index ? index->active(timestamp, sfid.segment) : SegmentIndex::npos;
+                if (segment != SegmentIndex::npos) {
+                    sfid.segment = segment;
                     sfid.list = consts::segment_list::all;
                 } else {
                     log.debug("Active segment index {} out of range for type {}", sfid.segment, uint_to_hex(sfid.type));
@@ -542,9 +2276,10 @@ Value Track::get_segment_data(field_id_t field_id, time::microseconds_t timestam
             break;
         case consts::segment_list::prev:
             {
-                std::vector<field_id_t> segments = get_prev_segments_ordered(sfid.type, timestamp);
-                if (segments.size() > sfid.segment) {
-                    sfid.segment = segments[sfid.segment];
+                const SegmentIndex* index = get_segment_index(sfid.type);
+                uint32_t segment = index ? index->prev(timestamp, sfid.segment) : SegmentIndex::npos;
+                if (segment != SegmentIndex::npos) {
+                    sfid.segment = segment;
                     sfid.list = consts::segment_list::all;
                 } else {
                     log.debug("Prev segment index {} out of range for type {}", sfid.segment, uint_to_hex(sfid.type));
@@ -554,9 +2289,10 @@ Value Track::get_segment_data(field_id_t field_id, time::microseconds_t timestam
             break;
         case consts::segment_list::next:
             {
-                std::vector<field_id_t> segments = get_next_segments_ordered(sfid.type, timestamp);
-                if (segments.size() > sfid.segment) {
-                    sfid.segment = segments[sfid.segment];
+                const SegmentIndex* index = get_segment_index(sfid.type);
+                uint32_t segment = index ? index->next(timestamp, sfid.segment) : SegmentIndex::npos;
+                if (segment != SegmentIndex::npos) {
+                    sfid.segment = segment;
                     sfid.list = consts::segment_list::all;
                 } else {
                     log.debug("Next segment index {} out of range for type {}", sfid.segment, uint_to_hex(sfid.type));
@@ -577,16 +2313,48 @@ Value Track::get_segment_data(field_id_t field_id, time::microseconds_t timestam
     if (real_fid & consts::mask::metadata_flag) {
         return get_segment_metadata(real_fid);
     }
+    if (real_fid & consts::mask::trackpoint_flag) {
+        return get_segment_point_data(real_fid, timestamp, cursor);
+    }
 
     log.warning("Segment field data not possible to be retrieved for field {} at {} (mapped to {})",
                 uint_to_hex(field_id), std::format("{}", timestamp), uint_to_hex(real_fid));
     return Value();
 }
 
-Value Track::get_segment_metadata(field_id_t field_id) const {//metadata_[full_field_id] = value;
-    auto it = metadata_.find(field_id);
-    if (it != metadata_.end()) {
-        return it->second;
+/* field value minus its value at segment start, time points as seconds */
+Value Track::get_segment_point_data(field_id_t field_id, time::microseconds_t timestamp, TrackCursor& cursor) const {
+    segment_field_id sfid(field_id);
+    auto it = segment_start_indexes_.find(sfid.type);
+    if (it == segment_start_indexes_.end() || sfid.segment >= it->second.size() ||
+        sfid.field >= segment_point_columns_.size()) {
+        log.warning("Segment point field id not found: {}", uint_to_hex(field_id));
+        return Value();
+    }
+
+    size_t column = segment_point_columns_[sfid.field];
+    size_t start = it->second[sfid.segment];
+    size_t idx = trackpoints_.floor_index(timestamp, cursor);
+    if (start == TrackpointStore::npos || idx == TrackpointStore::npos || idx < start ||
+        !trackpoints_.is_valid(column, start) || !trackpoints_.is_valid(column, idx)) {
+        return Value();
+    }
+
+    double delta = trackpoints_.value(column, idx) - trackpoints_.value(column, start);
+    if (trackpoints_.column_type(column) == TrackpointStore::ColumnType::TimePoint) {
+        return Value(time::us_to_s(static_cast<time::microseconds_t>(delta)));
+    }
+    return Value(delta);
+}
+
+Value Track::get_segment_metadata(field_id_t field_id) const {
+    segment_field_id sfid(field_id);
+    if (sfid.type < segment_metadata_index_.size() && sfid.field < next_segment_metadata_field_id_) {
+        const auto& values = segment_metadata_index_[sfid.type];
+        size_t slot = sfid.segment * next_segment_metadata_field_id_ + sfid.field;
+        if (slot < values.size() && values[slot].is_valid()) {
+            return values[slot];
+        }
     }
     log.warning("Segment metadata field id not found: {}", uint_to_hex(field_id));
     return Value();
@@ -633,58 +2401,12 @@ bool Track::parse_metadata(pugi::xml_node node) {
     return true;
 }
 
-/* segments with start_time <= timestamp <= end_time ordered by start_time ascending */
-std::vector<field_id_t> Track::get_active_segments_ordered(
-                    field_id_t segment_type, time::microseconds_t timestamp) const {
-    std::vector<field_id_t> segments;
-
-    for (auto idx : segments_ordered_by_start_time_.at(segment_type)) {
-        auto times = segments_lut_.at(segment_type).at(idx);
-        time::microseconds_t start_us = to_relative_time_domain(times.first);
-        time::microseconds_t end_us = to_relative_time_domain(times.second);
-
-        if (start_us <= timestamp && timestamp <= end_us) {
-            segments.push_back(idx);
-        }
-    }
-
-    return segments;
-}
-
-/* segments with end_time < timestamp ordered by end_time descending */
-std::vector<field_id_t> Track::get_prev_segments_ordered(
-                    field_id_t segment_type, time::microseconds_t timestamp) const {
-    std::vector<field_id_t> segments;
-
-    for (auto it = segments_ordered_by_end_time_.at(segment_type).rbegin();
-         it != segments_ordered_by_end_time_.at(segment_type).rend(); ++it) {
-        auto idx = *it;
-        auto times = segments_lut_.at(segment_type).at(idx);
-        time::microseconds_t end_us = to_relative_time_domain(times.second);
-
-        if (end_us < timestamp) {
-            segments.push_back(idx);
-        }
-    }
-
-    return segments;
-}
-
-/* segments with start_time > timestamp ordered by start_time ascending */
-std::vector<field_id_t> Track::get_next_segments_ordered(
-                    field_id_t segment_type, time::microseconds_t timestamp) const {
-    std::vector<field_id_t> segments;
-
-    for (auto idx : segments_ordered_by_start_time_.at(segment_type)) {
-        auto times = segments_lut_.at(segment_type).at(idx);
-        time::microseconds_t start_us = to_relative_time_domain(times.first);
-
-        if (start_us > timestamp) {
-            segments.push_back(idx);
-        }
+const SegmentIndex* Track::get_segment_index(field_id_t segment_type) const {
+    auto it = segment_index_.find(segment_type);
+    if (it != segment_index_.end()) {
+        return &it->second;
     }
-
-    return segments;
+    return nullptr;
 }
 
 bool Track::parse_trk(pugi::xml_node node) {
@@ -724,6 +2446,9 @@ bool Track::parse_trk(pugi::xml_node node) {
         ok = parse_trkseg(trkseg) && ok;
     }
 
+    build_segment_index();
+    build_trackpoint_store();
+
     return ok;
 }
 
@@ -732,13 +2457,10 @@ time::time_point_t Track::find_start_time(
     time::time_point_t st = time::INVALID_TIME_POINT;
     for (auto trkseg: trksegs) {
         for (auto trkpt : trkseg.children("trkpt")) {
-            if (trkpt.child("time")) {
-                std::string time_str = trkpt.child("time").text().as_string();
-                auto timestamp = time::parse_iso8601(time_str);
-                if (timestamp != time::INVALID_TIME_POINT) {
-                    if (st == time::INVALID_TIME_POINT || timestamp < st) {
-                        st = timestamp;
-                    }
+            auto timestamp = parse_trkpt_time(trkpt);
+            if (timestamp != time::INVALID_TIME_POINT) {
+                if (st == time::INVALID_TIME_POINT || timestamp < st) {
+                    st = timestamp;
                 }
             }
         }
@@ -794,8 +2516,6 @@ bool Track::parse_trk_ext_asx(pugi::xml_node node) {
         }
     }
 
-    generate_sorted_segment_lists();
-    generate_segment_metadata_field_aliases();
     generate_segment_virtual_metadata_fields();
 
     return ok;
@@ -804,7 +2524,6 @@ bool Track::parse_trk_ext_asx(pugi::xml_node node) {
 //TODO refactor into subfunctions?
 bool Track::parse_trk_ext_asx_segment(pugi::xml_node node) {
     log.info("Parsing GPX segment");
-    bool ok = true;
 
     std::string type = "unknown";
     time::time_point_t start_time = time::INVALID_TIME_POINT;
@@ -847,6 +2566,14 @@ bool Track::parse_trk_ext_asx_segment(pugi::xml_node node) {
         return false;
     }
 
+    return store_segment(type, start_time, end_time, std::move(metadata));
+}
+
+/* registers segment instance of given type and its s_TYPE_N_meta_FIELD metadata */
+bool Track::store_segment(const std::string& type, time::time_point_t start_time, time::time_point_t end_time,
+                          std::map<std::string, Value> metadata) {
+    bool ok = true;
+
     // register segment type if new
     field_id_t type_id = INVALID_FIELD;
     if (segment_types_.find(type) == segment_types_.end()) {
@@ -889,27 +2616,27 @@ bool Track::parse_trk_ext_asx_segment(pugi::xml_node node) {
                               instance_idx,              // segment instance
                               fid);                      // field id within segment metadata
 
-        // FFFF FFFF  TTTT TLLL  NNNN NNNN  IIII IIII
-        // 0101 0000  tttt t011  nnnn nnnn  iiii iiii
+        // FF    TTTT  LL  NNNN  IIII   (hex digits)
+        // 50    tttt  03  nnnn  iiii
         //
-        // 0101 0000 - segment flag + metadata flag
-        // tttt t    - segment type (auto assigned above)
-        // 011       - all segments list (consts::segment_list::all == 0x3)
-        // nnnn nnnn - segment instance (auto assigned above)
-        // iiii iiii - field id within segment metadata (auto assigned above)
+        // 50   - segment flag + metadata flag
+        // tttt - segment type (auto assigned above)
+        // 03   - all segments list (consts::segment_list::all == 0x3)
+        // nnnn - segment instance (auto assigned above)
+        // iiii - field id within segment metadata (auto assigned above)
         field_id_t full_field_id = static_cast<field_id_t>(sfid) | consts::mask::segment_flag | consts::mask::metadata_flag;
 
         std::string segment_key = consts::prefix::segment + type + "_" + std::to_string(instance_idx) + "_"; // s_TYPE_N_
         std::string full_field_name = segment_key + partial_name; // s_TYPE_N_meta_FIELDNAME
 
-        if (field_ids_.find(full_field_name) != field_ids_.end()) {
-            log.warning("Segment field id already exists for field name: {} with id {}", full_field_name, uint_to_hex(field_ids_[full_field_name]));
+        if (field_ids_.contains(full_field_name)) {
+            log.warning("Segment field id already exists for field name: {} with id {}", full_field_name, uint_to_hex(field_ids_.find(full_field_name)));
             log.warning("While trying to assign id {}", uint_to_hex(full_field_id));
             ok = false;
             continue;
         }
         log.debug("Registered segment field id: {} = {}", full_field_name, uint_to_hex(full_field_id));
-        field_ids_[full_field_name] = full_field_id;
+        field_ids_.assign(full_field_name, full_field_id);
 
         // store segment metadata
         metadata_[full_field_id] = value;
@@ -918,61 +2645,64 @@ bool Track::parse_trk_ext_asx_segment(pugi::xml_node node) {
     return ok;
 }
 
-void Track::generate_sorted_segment_lists() {
+void Track::build_segment_index() {
     for (const auto& [type_id, instances] : segments_lut_) {
-        segments_ordered_by_start_time_[type_id] = {};
-        segments_ordered_by_end_time_[type_id] = {};
-
-        for (const auto& [instance_idx, _] : instances) {
-            segments_ordered_by_start_time_[type_id].push_back(instance_idx);
-            segments_ordered_by_end_time_[type_id].push_back(instance_idx);
-        }
-
-        // sort by start time
-        std::sort(segments_ordered_by_start_time_[type_id].begin(),
-                  segments_ordered_by_start_time_[type_id].end(),
-                  [this, type_id](field_id_t a, field_id_t b) {
-                      const auto& time_pair_a = segments_lut_.at(type_id).at(a);
-                      const auto& time_pair_b = segments_lut_.at(type_id).at(b);
-                      return time_pair_a.first < time_pair_b.first;
-                  });
-        // sort by end time
-        std::sort(segments_ordered_by_end_time_[type_id].begin(),
-                  segments_ordered_by_end_time_[type_id].end(),
-                  [this, type_id](field_id_t a, field_id_t b) {
-                      const auto& time_pair_a = segments_lut_.at(type_id).at(a);
-                      const auto& time_pair_b = segments_lut_.at(type_id).at(b);
-                      return time_pair_a.second < time_pair_b.second;
-                  });
-    }
-}
-
-void Track::generate_segment_metadata_field_aliases() {
-    for (const auto& [type, type_id] : segment_types_) {
-            for (const auto& [instance_idx, _] : segments_lut_[type_id]) {
-                for (const auto& [partial_name, fid] : segment_metadata_partial_field_ids_) {
-                    log.debug("Generating segment metadata field aliases for type: {}, instance: {}, field partial name: {}",
-                              type, uint_to_hex(instance_idx), partial_name);
-
-                    for (auto [list_name, list_id] : {std::make_pair("active", consts::segment_list::active),
-                                                      std::make_pair("prev",   consts::segment_list::prev),
-                                                      std::make_pair("next",   consts::segment_list::next)}) {
-                        
-                        segment_field_id sfid(type_id, list_id, instance_idx, fid);
-                        field_id_t full_field_id = static_cast<field_id_t>(sfid) | consts::mask::segment_flag | consts::mask::metadata_flag;
-
-                        std::string segment_key = consts::prefix::segment + type + "_" + list_name + "_" + std::to_string(instance_idx) + "_"; // s_TYPE_LIST_N_
-                        std::string full_field_name = segment_key + partial_name; // s_TYPE_LIST_N_meta_FIELDNAME
-
-                        log.debug("Registered segment field id alias: {} = {}", full_field_name, uint_to_hex(full_field_id));
-                        field_ids_[full_field_name] = full_field_id;
-                    }
-            }
+        std::vector<SegmentIndex::interval_t> intervals;
+        intervals.reserve(instances.size());
+
+        for (const auto& [instance_idx, times] : instances) {
+            intervals.push_back({static_cast<uint32_t>(instance_idx),
+                                 to_relative_time_domain(times.first),
+                                 to_relative_time_domain(times.second)});
         }
+
+        segment_index_[type_id].build(std::move(intervals));
+        log.debug("Built segment index for type {}: {} segments", uint_to_hex(type_id), instances.size());
     }
 }
 
+/* s_TYPE_LIST_N_FIELD - N-th segment of "all" list seen through active/prev/next list,
+ * parsed from the name instead of registering every type x instance x list x field combination */
+field_id_t Track::resolve_segment_metadata_alias(std::string_view name) const {
+    if (!name.starts_with(consts::prefix::segment)) {
+        return INVALID_FIELD;
+    }
+    name.remove_prefix(consts::prefix::segment.size());
+
+    // type names may contain '_' or prefix one another, try all
+    for (const auto& [type, type_id] : segment_types_) {
+        if (name.size() <= type.size() || !name.starts_with(type) || name[type.size()] != '_') {
+            continue;
+        }
+        std::string_view rest = name.substr(type.size() + 1);
+
+        for (const auto& [list_name, list_id] : consts::segment_list::aliased) {
+            if (rest.size() <= list_name.size() || !rest.starts_with(list_name) || rest[list_name.size()] != '_') {
+                continue;
+            }
+            std::string_view instance_name = rest.substr(list_name.size() + 1);
+
+            field_id_t instance_idx = 0;
+            auto [end, ec] = std::from_chars(instance_name.data(), instance_name.data() + instance_name.size(), instance_idx);
+            size_t digits = end - instance_name.data();
+            if (ec != std::errc() || digits == instance_name.size() || *end != '_' ||
+                (digits > 1 && instance_name.front() == '0')) {
+                continue;
+            }
+
+            auto instances = segments_lut_.find(type_id);
+            auto fid = segment_metadata_partial_field_ids_.find(std::string(instance_name.substr(digits + 1)));
+            if (instances == segments_lut_.end() || !instances->second.contains(instance_idx) ||
+                fid == segment_metadata_partial_field_ids_.end()) {
+                continue;
+            }
 
+            segment_field_id sfid(type_id, list_id, instance_idx, fid->second);
+            return static_cast<field_id_t>(sfid) | consts::mask::segment_flag | consts::mask::metadata_flag;
+        }
+    }
+    return INVALID_FIELD;
+}
 
 void Track::generate_segment_virtual_metadata_fields() {
     field_id_t flags = consts::mask::virtual_flag | consts::mask::segment_flag | consts::mask::metadata_flag;
@@ -990,118 +2720,187 @@ void Track::generate_segment_virtual_metadata_fields() {
         return consts::prefix::segment + type + "_" + list_name + "_" + field_name;
     };
 
-    auto count_all = [this](field_id_t type_id, time::microseconds_t) -> Value {
-        auto it = segments_lut_.find(type_id);
-        if (it != segments_lut_.end()) {
-            return Value(static_cast<double>(it->second.size()));
-        }
-        return Value(0.0);
-    };
-
-    auto count_active = [this](field_id_t type_id, time::microseconds_t timestamp) -> Value {
-        auto segments = get_active_segments_ordered(type_id, timestamp);
-        return Value(static_cast<double>(segments.size()));
-    };
-
-    auto count_prev = [this](field_id_t type_id, time::microseconds_t timestamp) -> Value {
-        auto segments = get_prev_segments_ordered(type_id, timestamp);
-        return Value(static_cast<double>(segments.size()));
-    };
-
-    auto count_next = [this](field_id_t type_id, time::microseconds_t timestamp) -> Value {
-        auto segments = get_next_segments_ordered(type_id, timestamp);
-        return Value(static_cast<double>(segments.size()));
-    };
-
-    auto lists = std::vector<std::tuple<std::string, field_id_t, std::function<Value(field_id_t, time::microseconds_t)>>>{
-        {"",       consts::segment_list::all, count_all},
-        {"active", consts::segment_list::active, count_active},
-        {"prev",   consts::segment_list::prev, count_prev},
-        {"next",   consts::segment_list::next, count_next},
+    auto lists = std::vector<std::pair<std::string, field_id_t>>{
+        {"",       consts::segment_list::all},
+        {"active", consts::segment_list::active},
+        {"prev",   consts::segment_list::prev},
+        {"next",   consts::segment_list::next},
     };
 
     for (const auto& [type, type_id] : segment_types_) {
-        for (const auto& [list_name, list_id, count_func] : lists) {
+        for (const auto& [list_name, list_id] : lists) {
             std::string fname = make_fname(type, list_name, consts::field::segment::virt::name::count);
             field_id_t fid = make_fid(type_id, list_id, consts::field::segment::virt::id::count);
 
-            virtual_data_mapping_[fid] = [this, type_id, count_func](time::microseconds_t timestamp) -> Value {
-                return count_func(type_id, timestamp);
-            };
-            field_ids_[fname] = fid;
+            // evaluated by get_segment_virtual_data straight from the id
+            field_ids_.assign(fname, fid);
             log.info("Registered segment virtual metadata field: {} = {}", fname, uint_to_hex(fid));
         }
     }
 }
 
+/* s_TYPE_active_N_point_FIELD for all trackpoint fields and N up to most segments active at once
+ * - trackpoints of segment starts are located once, so a query is a single subtraction */
+void Track::generate_segment_point_fields() {
+    segment_point_columns_.clear();
+    segment_start_indexes_.clear();
+
+    std::vector<std::string> partial_names; // point_FIELD, index is field within segment
+    for (const auto& name : get_field_names()) {
+        size_t column = name.starts_with(consts::prefix::trackpoint) ? get_trackpoint_column(get_field_id(name))
+                                                                     : TrackpointStore::npos;
+        if (column == TrackpointStore::npos) {
+            continue;
+        }
+        if (segment_point_columns_.size() > consts::mask::segment::field) {
+            log.warning("Too many trackpoint fields, segment point field not available for: {}", name);
+            continue;
+        }
+        segment_point_columns_.push_back(column);
+        partial_names.push_back(name);
+    }
+
+    for (const auto& [type, type_id] : segment_types_) {
+        const SegmentIndex* index = get_segment_index(type_id);
+        if (!index) {
+            continue;
+        }
+
+        const auto& arrays = index->arrays();
+        auto& starts = segment_start_indexes_[type_id];
+        for (size_t i = 0; i < arrays.starts.size(); ++i) {
+            uint32_t segment = arrays.by_start[i];
+            if (segment >= starts.size()) {
+                starts.resize(segment + 1, TrackpointStore::npos);
+            }
+            starts[segment] = trackpoints_.floor_index(arrays.starts[i]);
+        }
+
+        size_t active_count = std::min<size_t>(index->max_active_count(), consts::invalid_segment_idx);
+        for (size_t n = 0; n < active_count; ++n) {
+            for (size_t field = 0; field < partial_names.size(); ++field) {
+                segment_field_id sfid(type_id, consts::segment_list::active, n, field);
+                field_id_t fid = static_cast<field_id_t>(sfid) | consts::mask::segment_flag | consts::mask::trackpoint_flag;
+                std::string fname = consts::prefix::segment + type + "_active_" + std::to_string(n) + "_" + partial_names[field];
+                field_ids_.assign(fname, fid);
+                log.debug("Registered segment point field: {} = {}", fname, uint_to_hex(fid));
+            }
+        }
+    }
+}
+
+/* segment metadata (of "all" list, other lists are mapped to it) in a dense table per segment type,
+ * so lookups do not depend on number of segments or metadata fields */
+void Track::build_segment_metadata_index() {
+    size_t field_count = next_segment_metadata_field_id_;
+    segment_metadata_index_.assign(segment_types_.size(), {});
+    for (const auto& [type_id, instances] : segments_lut_) {
+        if (type_id < segment_metadata_index_.size() && !instances.empty()) {
+            segment_metadata_index_[type_id].resize((instances.rbegin()->first + 1) * field_count);
+        }
+    }
+
+    auto add = [this, field_count](field_id_t field_id, const Value& value) {
+        if ((field_id & consts::mask::flags) != (consts::mask::segment_flag | consts::mask::metadata_flag)) {
+            return;
+        }
+        segment_field_id sfid(field_id);
+        if (sfid.list != consts::segment_list::all || sfid.type >= segment_metadata_index_.size()) {
+            return;
+        }
+        auto& values = segment_metadata_index_[sfid.type];
+        size_t slot = sfid.segment * field_count + sfid.field;
+        if (sfid.field < field_count && slot < values.size()) {
+            values[slot] = value;
+        }
+    };
+
+    for (const auto& [field_id, value] : metadata_) {
+        add(field_id, value);
+    }
+    if (snapshot_) {
+        for (const auto& record : snapshot_->section<snapshot::metadata_record_t>(snapshot::Section::Metadata)) {
+            Value value;
+            if (get_snapshot_metadata(record.field_id, value)) {
+                add(record.field_id, value);
+            }
+        }
+    }
+}
+
 bool Track::parse_trkseg(pugi::xml_node node) {
     log.info("Parsing GPX track segment");
-    bool ok = true;
 
+    TrackpointChunk chunk;
     for (pugi::xml_node trkpt : node.children("trkpt")) {
-        ok = parse_trkpt(trkpt) && ok;
+        chunk.ok = parse_trkpt(trkpt, parse_trkpt_time(trkpt), chunk) && chunk.ok;
     }
+    merge_trackpoint_chunk(chunk);
 
-    return ok;
+    return chunk.ok;
 }
 
-bool Track::parse_trkpt(pugi::xml_node node) {
-    log.debug("Parsing GPX track point");
+time::time_point_t Track::parse_trkpt_time(pugi::xml_node node) const {
+    if (!node.child("time")) {
+        return time::INVALID_TIME_POINT;
+    }
+    return time::parse_iso8601(node.child("time").text().as_string());
+}
 
-    if (!node.attribute("lat") || !node.attribute("lon")) {
+/* timestamp - already parsed trkpt time (parse_trkpt_time)
+ *
+ * Hot path of track loading. Values go to chunk keyed by element name, which
+ * is resolved to a trackpoint store column only once per chunk on merge, so
+ * no field name strings are built or looked up per value. Does not modify
+ * the track, so separate chunks may be parsed concurrently. */
+bool Track::parse_trkpt(pugi::xml_node node, time::time_point_t timestamp, TrackpointChunk& chunk) const {
+    pugi::xml_attribute lat_attr = node.attribute("lat");
+    pugi::xml_attribute lon_attr = node.attribute("lon");
+    if (!lat_attr || !lon_attr) {
         log.warning("Track point missing lat or lon attribute");
         return false;
     }
-    if (!node.child("time")) {
+    pugi::xml_node time_node = node.child("time");
+    if (!time_node) {
         log.warning("Track point missing time value");
         return false;
     }
 
-    std::string time_str = node.child("time").text().as_string();
-    auto timestamp = time::parse_iso8601(time_str);
     if (timestamp == time::INVALID_TIME_POINT) {
-        log.warning("Failed to parse track point time: {}", time_str);
+        log.warning("Failed to parse track point time: {}", time_node.text().as_string());
         return false;
     }
-    log.debug("Track point time: {}", timestamp);
 
     time::microseconds_t ts = to_relative_time_domain(timestamp);
 
-    store_trackpoint_data(ts, "time", Value(timestamp));
-
-    double lat = node.attribute("lat").as_double();
-    double lon = node.attribute("lon").as_double();
-    store_trackpoint_data(ts, "lat", Value(lat));
-    store_trackpoint_data(ts, "lon", Value(lon));
-    log.debug("Track point lat: {}, lon: {}", lat, lon);
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(timestamp.time_since_epoch()).count();
+    chunk.add(ts, chunk.key_index("time", TrackpointStore::ColumnType::TimePoint), static_cast<double>(us));
+    chunk.add(ts, chunk.key_index("lat", TrackpointStore::ColumnType::Double), lat_attr.as_double());
+    chunk.add(ts, chunk.key_index("lon", TrackpointStore::ColumnType::Double), lon_attr.as_double());
 
     for (pugi::xml_node child : node.children()) {
-        std::string key = drop_ns(child.name());
+        std::string_view name = child.name();
+        std::string_view key = local_name(name);
         if (key == "time") {
             continue; // processed separately
         }
         if (key == "extensions") {
             for (pugi::xml_node ext_child : child.children()) {
-                std::string ext_key = drop_ns(ext_child.name());
+                std::string_view ext_key = local_name(ext_child.name());
                 if (ext_key == "TrackPointExtension" || ext_key == "ActivityTrackPointExtension") {
                     for (pugi::xml_node ext_data : ext_child.children()) {
-                        std::string data_key = drop_ns(ext_data.name());
                         if (ext_data.text().empty()) {
-                            log.debug("Track point extension data: {} has no data", data_key);
                             continue; // no data
                         }
-                        double value = ext_data.text().as_double();
-                        log.debug("Track point extension data: {} = {}", data_key, value);
-                        store_trackpoint_data(ts, data_key, Value(value));
+                        uint32_t key = chunk.key_index(ext_data.name(), TrackpointStore::ColumnType::Double);
+                        chunk.add(ts, key, ext_data.text().as_double());
                     }
                 } else if (ext_key == "power") { // special case for Strava gpx files
                     if (ext_child.text().empty()) {
-                        log.debug("Track point extension data: power has no data");
                         continue; // no data
                     }
-                    double value = ext_child.text().as_double();
-                    log.debug("Track point extension data: power = {}", value);
-                    store_trackpoint_data(ts, "power", Value(value));
+                    uint32_t key = chunk.key_index("power", TrackpointStore::ColumnType::Double);
+                    chunk.add(ts, key, ext_child.text().as_double());
                 } else {
                     log.debug("Ignoring unknown track point extension: {}", ext_key);
                 }
@@ -1109,12 +2908,9 @@ bool Track::parse_trkpt(pugi::xml_node node) {
             continue; // processed
         }
         if (child.text().empty()) {
-            log.debug("Track point data: {} has no data", key);
             continue; // no data
         }
-        double value = child.text().as_double();
-        log.debug("Track point data: {} = {}", key, value);
-        store_trackpoint_data(ts, key, Value(value));
+        chunk.add(ts, chunk.key_index(name, TrackpointStore::ColumnType::Double), child.text().as_double());
     }
 
     return true;
@@ -1132,83 +2928,304 @@ bool Track::store_custom_data(const std::string& key, const Value& value) {
     return true;
 }
 
-bool Track::store_trackpoint_data(time::microseconds_t timestamp,
-                                  const std::string& key, const Value& value) {
-    std::shared_ptr<std::map<field_id_t, Value>> tp_data;
-    
-    auto it = trackpoints_.find(timestamp);
-    if (it != trackpoints_.end()) {
-        tp_data = it->second;
-    } else {
-        tp_data = std::make_shared<std::map<field_id_t, Value>>();
-        trackpoints_[timestamp] = tp_data;
-
-        if (timestamp < min_timestamp_) {
-            min_timestamp_ = timestamp;
-        }
-        if (timestamp > max_timestamp_) {
-            max_timestamp_ = timestamp;
+/* column for trackpoint element, registers field and column on first use */
+size_t Track::get_trackpoint_handle(std::string_view element_name, TrackpointStore::ColumnType type) {
+    for (const auto& [name, column] : trackpoint_handles_) {
+        if (name == element_name) {
+            return column;
         }
     }
 
-    field_id_t field_id = register_trackpoint_field(key);
-    (*tp_data)[field_id] = value;
+    field_id_t field_id = register_trackpoint_field(std::string(local_name(element_name)));
+    size_t column = get_trackpoint_column(field_id);
+    if (column == TrackpointStore::npos) {
+        column = trackpoints_.add_column(type);
+        trackpoint_columns_[field_id] = column;
+    }
+    trackpoint_handles_.emplace_back(element_name, column);
+    return column;
+}
+
+bool Track::store_trackpoint_value(time::microseconds_t timestamp, size_t column, double value, std::string_view key) {
+    if (trackpoints_.column_type(column) == TrackpointStore::ColumnType::TimePoint) {
+        log.warning("Non time point value stored in time point trackpoint field: {}", local_name(key));
+        return false;
+    }
+    trackpoints_.set(timestamp, column, value);
     return true;
 }
 
-void Track::create_virtual_fields() {
-    virtual_data_mapping_[register_virtual_field("timestamp")] = [this](time::microseconds_t timestamp) -> Value {
-        time::time_point_t tp = start_time_ + std::chrono::microseconds(timestamp - start_offset_);
-        return Value(tp);
-    };
+/* chunks have to be merged in document order to keep field ids deterministic */
+void Track::merge_trackpoint_chunk(const TrackpointChunk& chunk) {
+    const auto& keys = chunk.keys();
+    std::vector<size_t> columns;
+    columns.reserve(keys.size());
+    for (const auto& key : keys) {
+        columns.push_back(get_trackpoint_handle(key.name, key.type));
+    }
+
+    auto timestamps = chunk.timestamps();
+    auto key_indexes = chunk.key_indexes();
+    auto values = chunk.values();
+    for (size_t i = 0; i < values.size(); ++i) {
+        const auto& key = keys[key_indexes[i]];
+        if (key.type == TrackpointStore::ColumnType::TimePoint) {
+            trackpoints_.set(timestamps[i], columns[key_indexes[i]], values[i]);
+        } else {
+            store_trackpoint_value(timestamps[i], columns[key_indexes[i]], values[i], key.name);
+        }
+    }
+}
 
-    virtual_data_mapping_[register_virtual_field("video_time")] = [this](time::microseconds_t timestamp) -> Value {
-        return Value(time::us_to_s(timestamp));
-    };
+void Track::build_trackpoint_store(time::microseconds_t timestamp_shift) {
+    trackpoints_.build(timestamp_shift);
+    trackpoint_handles_.clear();
+
+    log.info("Built trackpoint store: {} trackpoints, {} fields, {} bytes",
+             trackpoints_.size(), trackpoints_.column_count(), trackpoints_.memory_usage());
+
+    index_trackpoints();
+}
+
+/* track bounds and fields derived from trackpoints of a built store */
+void Track::index_trackpoints() {
+    auto timestamps = trackpoints_.timestamps();
+    if (!timestamps.empty()) {
+        min_timestamp_ = timestamps.front();
+        max_timestamp_ = timestamps.back();
+    }
 
-    virtual_data_mapping_[register_virtual_field("time_elapsed")] = [this](time::microseconds_t timestamp) -> Value {
-        if (min_timestamp_ != time::INVALID_TIME) {
-            return Value(time::us_to_s(timestamp - min_timestamp_));
+    generate_cumulative_fields();
+    generate_segment_point_fields();
+    build_segment_metadata_index();
+}
+
+/* first batch of a live track builds the store like a loaded track, later ones are appended to it */
+void Track::apply_live_batch(const LiveFeed::batch_t& batch) {
+    pugi::xml_document doc;
+    for (const auto& [name, text] : batch.elements) {
+        pugi::xml_parse_result result = doc.load_buffer(text.data(), text.size());
+        if (!result) {
+            log.warning("Failed to parse <{}> element of live track: {}", name, result.description());
+            continue;
+        }
+        if (name == "metadata") {
+            parse_metadata(doc.first_child());
         } else {
-            return Value();
+            store_metadata(name, std::string(doc.first_child().text().as_string()));
         }
-    };
+    }
 
-    virtual_data_mapping_[register_virtual_field("time_remaining")] = [this](time::microseconds_t timestamp) -> Value {
-        if (max_timestamp_ != 0) {
-            return Value(time::us_to_s(max_timestamp_ - timestamp));
-        } else {
-            return Value();
+    const TrackpointChunk& chunk = batch.chunk;
+    time::microseconds_t shift = start_offset_;
+    if (batch.absolute_time) {
+        if (start_time_ == time::INVALID_TIME_POINT) {
+            start_time_ = chunk.start_time;
+            log.info("Track start time: {}", std::format("{}", start_time_));
         }
-    };
+        shift -= std::chrono::duration_cast<std::chrono::microseconds>(start_time_.time_since_epoch()).count();
+    }
 
-    virtual_data_mapping_[register_virtual_field("active")] = [this](time::microseconds_t timestamp) -> Value {
-        if (min_timestamp_ != time::INVALID_TIME && max_timestamp_ != 0) {
-            return Value(timestamp >= min_timestamp_ && timestamp <= max_timestamp_);
-        } else {
-            return Value(false);
+    if (trackpoints_.size() == 0) {
+        merge_trackpoint_chunk(chunk);
+        build_trackpoint_store(shift);
+        trackpoints_.set_growing(true);
+        return;
+    }
+    append_trackpoints(chunk, shift);
+}
+
+/* Only rows after the last trackpoint are appended, the store and indexes built on it grow at the end - values
+ * at or before it (repeated or out of order trackpoints) are dropped. */
+void Track::append_trackpoints(const TrackpointChunk& chunk, time::microseconds_t timestamp_shift) {
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+    size_t column_count = trackpoints_.column_count();
+    const auto& keys = chunk.keys();
+    std::vector<size_t> columns;
+    columns.reserve(keys.size());
+    for (const auto& key : keys) {
+        columns.push_back(get_trackpoint_handle(key.name, key.type));
+    }
+    trackpoint_handles_.clear();
+    if (trackpoints_.column_count() > column_count) {
+        generate_cumulative_fields();
+    }
+
+    auto timestamps = chunk.timestamps();
+    auto key_indexes = chunk.key_indexes();
+    auto values = chunk.values();
+    time::microseconds_t last = trackpoints_.timestamps().back();
+    std::vector<time::microseconds_t> rows;
+    std::vector<std::vector<double>> row_values(trackpoints_.column_count());
+    size_t dropped = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        time::microseconds_t timestamp = timestamps[i] + timestamp_shift;
+        if (rows.empty() || timestamp != rows.back()) {
+            if (timestamp <= last) {
+                ++dropped;
+                continue;
+            }
+            rows.push_back(timestamp);
+            for (auto& column_values : row_values) {
+                column_values.push_back(nan);
+            }
+            last = timestamp;
         }
-    };
 
-    virtual_data_mapping_[register_virtual_field("countdown")] = [this](time::microseconds_t timestamp) -> Value {
-        if (min_timestamp_ != time::INVALID_TIME) {
-            time::microseconds_t diff = min_timestamp_ - timestamp;
-            if (diff > 0) {
-                return Value(time::us_to_s(diff));
+        const auto& key = keys[key_indexes[i]];
+        size_t column = columns[key_indexes[i]];
+        if (key.type != TrackpointStore::ColumnType::TimePoint &&
+            trackpoints_.column_type(column) == TrackpointStore::ColumnType::TimePoint) {
+            log.warning("Non time point value stored in time point trackpoint field: {}", local_name(key.name));
+            continue;
+        }
+        row_values[column].back() = values[i];
+    }
+    if (dropped > 0) {
+        log.warning("Dropped {} values of live trackpoints not after the last trackpoint", dropped);
+    }
+    if (rows.empty()) {
+        return;
+    }
+
+    trackpoints_.append(rows, row_values);
+    max_timestamp_ = rows.back();
+    extend_indexes();
+    log.debug("Appended {} live trackpoints, {} in total", rows.size(), trackpoints_.size());
+}
+
+/* indexes of trackpoint columns built so far (on first query) are extended by appended rows, none is rebuilt */
+void Track::extend_indexes() {
+    {
+        std::lock_guard<std::mutex> lock(cumulative_stats_mutex_);
+        for (auto& [column, stats] : cumulative_stats_) {
+            stats->extend();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(window_indexes_mutex_);
+        for (auto& [key, index] : window_indexes_) {
+            if (key.first == &trackpoints_) {
+                index->extend();
             }
         }
-        return Value();
-    };
+    }
+    {
+        std::lock_guard<std::mutex> lock(min_max_pyramids_mutex_);
+        for (auto& [key, pyramid] : min_max_pyramids_) {
+            if (key.first == &trackpoints_) {
+                pyramid->extend();
+            }
+        }
+    }
+}
+
+/* STAT_point_FIELD for numeric trackpoint fields (np only for power), evaluated by
+ * get_cumulative_series straight from the id - trackpoint field id with stat and virtual flag */
+void Track::generate_cumulative_fields() {
+    for (const auto& name : get_field_names()) {
+        if (!name.starts_with(consts::prefix::trackpoint)) {
+            continue;
+        }
+        field_id_t data_field_id = get_field_id(name);
+        size_t column = get_trackpoint_column(data_field_id);
+        if (column == TrackpointStore::npos || trackpoints_.column_type(column) != TrackpointStore::ColumnType::Double) {
+            continue;
+        }
+        if (data_field_id & consts::mask::cumulative::stat) {
+            log.warning("Trackpoint field id {} too large for cumulative fields of: {}", uint_to_hex(data_field_id), name);
+            continue;
+        }
 
-    virtual_data_mapping_[register_virtual_field("overtime")] = [this](time::microseconds_t timestamp) -> Value {
-        if (max_timestamp_ != 0) {
-            time::microseconds_t diff = timestamp - max_timestamp_;
-            if (diff > 0) {
-                return Value(time::us_to_s(diff));
+        for (size_t i = 0; i < cumulative_stat_names.size(); ++i) {
+            if (static_cast<CumulativeStat>(i) == CumulativeStat::Np && name.find("power") == std::string::npos) {
+                continue;
             }
+            std::string fname = std::string(cumulative_stat_names[i]) + "_" + name;
+            field_id_t fid = data_field_id | consts::mask::virtual_flag | (static_cast<field_id_t>(i) << std::countr_zero(consts::mask::cumulative::stat));
+            field_ids_.assign(fname, fid);
+            log.debug("Registered cumulative field: {} = {}", fname, uint_to_hex(fid));
         }
+    }
+}
+
+size_t Track::get_trackpoint_column(field_id_t field_id) const {
+    auto it = trackpoint_columns_.find(field_id);
+    if (it != trackpoint_columns_.end()) {
+        return it->second;
+    }
+    return TrackpointStore::npos;
+}
+
+/* store and column of trackpoint field - track trackpoints or custom series, nullptr if unknown */
+const TrackpointStore* Track::get_trackpoint_store(field_id_t field_id, size_t& column) const {
+    column = get_trackpoint_column(field_id);
+    if (column != TrackpointStore::npos) {
+        return &trackpoints_;
+    }
+    auto it = custom_series_columns_.find(field_id);
+    if (it != custom_series_columns_.end()) {
+        column = it->second.second;
+        return it->second.first;
+    }
+    return nullptr;
+}
+
+Value Track::make_trackpoint_value(const TrackpointStore& store, size_t column, size_t index) const {
+    double value = store.value(column, index);
+    if (store.column_type(column) == TrackpointStore::ColumnType::TimePoint) {
+        auto us = std::chrono::microseconds(static_cast<int64_t>(value));
+        return Value(time::time_point_t(us));
+    }
+    return Value(value);
+}
+
+/* prefix array of the statistic, built for all statistics of the column on first request */
+const std::vector<double>* Track::get_cumulative_series(field_id_t field_id) const {
+    auto stat = static_cast<CumulativeStat>((field_id & consts::mask::cumulative::stat) >> std::countr_zero(consts::mask::cumulative::stat));
+    field_id_t data_field_id = field_id & ~(consts::mask::virtual_flag | consts::mask::cumulative::stat);
+    size_t column = get_trackpoint_column(data_field_id);
+    if (stat >= CumulativeStat::Count || column == TrackpointStore::npos ||
+        trackpoints_.column_type(column) != TrackpointStore::ColumnType::Double) {
+        log.warning("Unknown cumulative field id: {}", uint_to_hex(field_id));
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(cumulative_stats_mutex_);
+    auto& stats = cumulative_stats_[column];
+    if (!stats) {
+        stats = std::make_unique<CumulativeStats>(trackpoints_, column);
+        log.info("Built cumulative statistics for column {}: {} bytes", column, stats->memory_usage());
+    }
+    return stats->series(stat);
+}
+
+Value Track::get_cumulative_data(field_id_t field_id, time::microseconds_t timestamp, TrackCursor& cursor) const {
+    const std::vector<double>* series = get_cumulative_series(field_id);
+    if (!series) {
         return Value();
-    };
+    }
+    return get_cumulative_value(*series, timestamp, cursor);
+}
+
+Value Track::get_cumulative_value(const std::vector<double>& series, time::microseconds_t timestamp, TrackCursor& cursor) const {
+    size_t idx = trackpoints_.floor_index(timestamp, cursor);
+    if (idx == TrackpointStore::npos || std::isnan(series[idx])) {
+        return Value();
+    }
+    return Value(series[idx]);
+}
+
+/* virtual field id is its VirtualField enumerator, so they must be the first fields registered */
+void Track::create_virtual_fields() {
+    for (size_t i = 0; i < virtual_field_names.size(); ++i) {
+        std::string key(virtual_field_names[i]);
+        field_id_t id = static_cast<field_id_t>(i) | consts::mask::virtual_flag;
+        field_ids_.assign(key, id);
+        log.debug("Registered new virtual field: {} with id {}", key, uint_to_hex(id));
+    }
+    next_field_id_ = std::max(next_field_id_, static_cast<field_id_t>(virtual_field_names.size()));
 }
 
 field_id_t Track::register_metadata_field(const std::string& key) {
@@ -1225,23 +3242,27 @@ field_id_t Track::register_custom_data_field(const std::string& key) {
     return id;
 }
 
+/* trackpoint field in custom namespace, samples are in custom_series_ */
+field_id_t Track::register_custom_series_field(const std::string& key) {
+    std::string customkey = consts::prefix::custom + key;
+    auto id = register_field(customkey, consts::mask::trackpoint_flag);
+    field_ids_.assign(consts::prefix::lerp + customkey, id | consts::mask::lerp_flag);
+    field_ids_.assign(consts::prefix::pchip + customkey, id | consts::mask::pchip_flag);
+    log.debug("Registered new custom series field: {} with id {}", customkey, uint_to_hex(id));
+    return id;
+}
+
 field_id_t Track::register_trackpoint_field(const std::string& key) {
     std::string tpkey = consts::prefix::trackpoint + key;
     auto id = register_field(tpkey, consts::mask::trackpoint_flag);
     log.debug("Registered new trackpoint field: {} with id {}", tpkey, uint_to_hex(id));
 
     auto lerp_id = id | consts::mask::lerp_flag;;
-    field_ids_[consts::prefix::lerp + tpkey] = lerp_id;
+    field_ids_.assign(consts::prefix::lerp + tpkey, lerp_id);
 
     auto pchip_id = id | consts::mask::pchip_flag;;
-    field_ids_[consts::prefix::pchip + tpkey] = pchip_id;
-
-    return id;
-}
+    field_ids_.assign(consts::prefix::pchip + tpkey, pchip_id);
 
-field_id_t Track::register_virtual_field(const std::string& key) {
-    auto id = register_field(key, consts::mask::virtual_flag);
-    log.debug("Registered new virtual field: {} with id {}", key, uint_to_hex(id));
     return id;
 }
 
@@ -1253,7 +3274,7 @@ field_id_t Track::register_field(const std::string& key, field_id_t mask) {
 
     id = next_field_id_++;
     id |= mask;
-    field_ids_[key] = id;
+    field_ids_.assign(key, id);
 
     return id;
 }
@@ -6,53 +6,135 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
-#include <ranges>
+#include <span>
 #include <string>
+#include <string_view>
 #include <variant>
+#include <vector>
 #include <stdint.h>
 
 #include <pugixml.hpp>
 
 #include "backend/utils/logging/logger.h"
 #include "backend/utils/time.h"
+#include "baked_timeline.h"
+#include "cumulative_stats.h"
+#include "field_dictionary.h"
+#include "field_handle.h"
+#include "live_feed.h"
+#include "min_max_pyramid.h"
+#include "query_cache.h"
+#include "race_index.h"
+#include "segment_index.h"
+#include "track_cursor.h"
+#include "track_snapshot.h"
+#include "trackpoint_chunk.h"
+#include "trackpoint_store.h"
 #include "value.h"
+#include "window_index.h"
+#include "virtual_field.h"
 
 namespace telemetry {
 namespace track {
 
-using field_id_t = uint32_t;
-static constexpr field_id_t INVALID_FIELD = UINT32_MAX;
-
 class Track {
 public:
     using fields_map_t = std::map<field_id_t, Value>;
-    using trackpoint_data_map_t = std::map<time::microseconds_t, std::shared_ptr<fields_map_t>>;
     using segments_metadata_map_t = std::map<field_id_t, std::shared_ptr<fields_map_t>>;
-    using trackpoint_ts_view_t = std::ranges::keys_view<std::ranges::ref_view<const trackpoint_data_map_t>>;
+    using trackpoint_ts_view_t = std::span<const time::microseconds_t>;
+
+    enum class Parser {
+        Dom,    // whole document parsed by pugixml
+        Stream, // streamed, only single trackpoints/small subtrees parsed at once
+    };
+
+    /* one of several track files recorded at the same time (e.g. head unit and watch, riders of a group ride) */
+    struct source_t {
+        std::string path;
+        time::microseconds_t offset = 0; // added to timestamps of source (clock correction)
+        std::string prefix;              // of field names from source, e.g. "watch_" -> point_watch_hr
+        bool rider = false;              // N-th rider source is addressed as rN_ (rN_point_speed, rN_rank ...)
+        std::string name;                // of rider, file name without extension if empty
+        bool live = false;               // followed while it is being written, see load_live - only as sole source
+    };
 
     Track(time::microseconds_t offset = 0);
     ~Track() = default;
 
-    bool load(const std::string& path);
+    /* loads track from snapshot cache if possible, otherwise streams the GPX (or decodes .fit file)
+     * worker_count - threads parsing trackpoints, 1 parses on calling thread */
+    bool load(const std::string& path, size_t worker_count = 1);
+    /* loads first source like load(path), trackpoints of others are merged into its timeline, so
+     * their fields are queried like fields of a single track; first source defines start time and
+     * keeps its field names, offset and prefix apply to the other sources only; rider sources get
+     * standings fields (rank, gap to leader ...) of a shared RaceIndex */
+    bool load(const std::vector<source_t>& sources, size_t worker_count = 1);
+    /* parses the GPX with given parser, bypassing snapshot cache
+     * worker_count - only used by stream parser */
+    bool load_gpx(const std::string& path, Parser parser, size_t worker_count = 1);
+    /* decodes FIT activity file (record messages as trackpoints, laps as "lap" segments),
+     * bypassing snapshot cache */
+    bool load_fit(const std::string& path);
+    /* follows GPX or CSV time series (.csv, value columns as point_ fields) that is still being written - growing
+     * file or named pipe; waits for the first trackpoints, later ones are parsed on a background thread and
+     * appended at frame starts (begin_frame) with indexes built so far extended, see LiveFeed */
+    bool load_live(const std::string& path);
+    /* custom data XML (scalar custom_ fields) or CSV time series (.csv), see docs/CustomData.md */
     bool load_custom_data(const std::string& path);
 
     field_id_t get_field_id(const std::string& field_name) const;
+    /* all registered field names, sorted */
+    std::vector<std::string> get_field_names() const;
 
     trackpoint_ts_view_t get_trackpoint_timestamps() const;
 
     Value get(const std::string& key, time::microseconds_t timestamp = time::INVALID_TIME) const;
     Value get(field_id_t field_id, time::microseconds_t timestamp = time::INVALID_TIME) const;
+    Value get(field_id_t field_id, time::microseconds_t timestamp, TrackCursor& cursor) const;
+
+    /* resolves field once (e.g. when layout is created), invalid handle if unknown */
+    FieldHandle bind(const std::string& field_name) const;
+    FieldHandle bind(field_id_t field_id) const;
+    /* frame time query without any name or id lookups, memoized while timestamp is the frame timestamp */
+    Value get(const FieldHandle& field, time::microseconds_t timestamp, TrackCursor& cursor) const;
+    /* same, validity is set to the range in which the value stays the same (next trackpoint,
+     * next segment boundary, forever for metadata, single microsecond for interpolated values) */
+    Value get(const FieldHandle& field, time::microseconds_t timestamp, TrackCursor& cursor, validity_t& validity) const;
+
+    /* sliding window aggregates over samples of a point_ (or its lerp_/pchip_) field, built on first
+     * request and kept for the lifetime of the track; nullptr if field has no numeric samples */
+    const WindowIndex* get_window_index(const FieldHandle& field) const;
+    /* min/max decimation pyramid over samples of the same fields (e.g. chart envelopes), built on
+     * first request and kept for the lifetime of the track; nullptr if field has no numeric samples.
+     * Samples of a custom_ series are its own rows, not trackpoints - see MinMaxPyramid::timestamp */
+    const MinMaxPyramid* get_min_max_pyramid(const FieldHandle& field) const;
+
+    /* resample lerp_/pchip_ fields onto frame grid of given rate (on first query of each field),
+     * so frame timestamps need no interpolation, see BakedTimeline; 0 rate disables baking */
+    void set_frame_rate(uint32_t fps_n, uint32_t fps_d);
+    size_t get_baked_memory_usage() const;
+
+    /* starts frame of handle queries, see QueryCache; trackpoints of a live track published since previous
+     * frame are appended here - frames do not overlap, so no query runs meanwhile */
+    void begin_frame(time::microseconds_t timestamp);
+    QueryCache::stats_t get_query_cache_stats() const;
 
     Value get_metadata(field_id_t field_id) const;
     
-    Value get_trackpoint_data(field_id_t field_id, time::microseconds_t timestamp) const;
-    Value get_lerp_trackpoint_data(field_id_t field_id, time::microseconds_t timestamp) const;
-    Value get_pchip_trackpoint_data(field_id_t field_id, time::microseconds_t timestamp) const;
+    Value get_trackpoint_data(field_id_t field_id, time::microseconds_t timestamp, TrackCursor& cursor) const;
+    Value get_lerp_trackpoint_data(field_id_t field_id, time::microseconds_t timestamp, TrackCursor& cursor) const;
+    Value get_pchip_trackpoint_data(field_id_t field_id, time::microseconds_t timestamp, TrackCursor& cursor) const;
     
     Value get_virtual_data(field_id_t field_id, time::microseconds_t timestamp) const;
+    Value get_virtual_value(VirtualField field, time::microseconds_t timestamp) const;
+    time::microseconds_t get_virtual_valid_until(VirtualField field, time::microseconds_t timestamp) const;
+    Value get_segment_virtual_data(field_id_t field_id, time::microseconds_t timestamp) const;
+    Value get_rider_data(field_id_t field_id, time::microseconds_t timestamp) const;
+    Value get_cumulative_data(field_id_t field_id, time::microseconds_t timestamp, TrackCursor& cursor) const;
     
-    Value get_segment_data(field_id_t field_id, time::microseconds_t timestamp) const;
+    Value get_segment_data(field_id_t field_id, time::microseconds_t timestamp, TrackCursor& cursor) const;
     Value get_segment_metadata(field_id_t field_id) const;
 
 private:
@@ -61,7 +143,20 @@ private:
     using segments_lut_t = std::map<field_id_t, std::map<field_id_t, std::pair<time::time_point_t, time::time_point_t>>>;
     /* segments[segment type id][instance index] = {start time, end time} */
 
+    /* loads sources other than the first one and merges them into this track */
+    bool load_sources(const std::vector<source_t>& sources, size_t worker_count);
+    bool merge_sources(const std::vector<source_t>& sources, const std::vector<std::unique_ptr<Track>>& tracks);
+    void build_race_index(const std::vector<source_t>& sources);
+    field_id_t resolve_rider_field(std::string_view name) const;
+    time::microseconds_t get_rider_valid_until(field_id_t field_id, time::microseconds_t timestamp) const;
+
+    bool load_snapshot(const std::string& path, const snapshot::source_t& source);
+    bool save_snapshot(const std::string& path, const snapshot::source_t& source) const;
+    field_id_t get_snapshot_field_id(const std::string& field_name) const;
+    bool get_snapshot_metadata(field_id_t field_id, Value& value) const;
+
     bool parse_gpx(pugi::xml_node node);
+    bool parse_gpx_stream(const std::string& path, size_t worker_count);
     bool parse_metadata(pugi::xml_node node);
 
     bool parse_trk(pugi::xml_node node);
@@ -73,53 +168,122 @@ private:
     bool parse_trk_ext_asx(pugi::xml_node node);
 
     bool parse_trk_ext_asx_segment(pugi::xml_node node);
-    void generate_sorted_segment_lists();
-    void generate_segment_metadata_field_aliases();
+    bool store_segment(const std::string& type, time::time_point_t start_time, time::time_point_t end_time,
+                       std::map<std::string, Value> metadata);
+    void build_segment_index();
+    field_id_t resolve_segment_metadata_alias(std::string_view name) const;
     void generate_segment_virtual_metadata_fields();
+    void generate_segment_point_fields();
+    void build_segment_metadata_index();
+    Value get_segment_point_data(field_id_t field_id, time::microseconds_t timestamp, TrackCursor& cursor) const;
+    void generate_cumulative_fields();
 
     bool parse_trkseg(pugi::xml_node node);
-    bool parse_trkpt(pugi::xml_node node);
+    bool parse_trkpt(pugi::xml_node node, time::time_point_t timestamp, TrackpointChunk& chunk) const;
+    time::time_point_t parse_trkpt_time(pugi::xml_node node) const;
 
     bool store_metadata(const std::string& key, const Value& value);
     bool store_custom_data(const std::string& key, const Value& value);
-    bool store_trackpoint_data(
-        time::microseconds_t timestamp,
-        const std::string& key, const Value& value);
+    bool load_custom_series(const std::string& path);
+    size_t get_trackpoint_handle(std::string_view element_name, TrackpointStore::ColumnType type);
+    bool store_trackpoint_value(time::microseconds_t timestamp, size_t column, double value, std::string_view key);
+    void merge_trackpoint_chunk(const TrackpointChunk& chunk);
     void create_virtual_fields();
-
-    std::vector<field_id_t> get_active_segments_ordered(field_id_t segment_type, time::microseconds_t timestamp) const;
-    std::vector<field_id_t> get_prev_segments_ordered(field_id_t segment_type, time::microseconds_t timestamp) const;
-    std::vector<field_id_t> get_next_segments_ordered(field_id_t segment_type, time::microseconds_t timestamp) const;
+    void build_trackpoint_store(time::microseconds_t timestamp_shift = 0);
+    void index_trackpoints();
+    void apply_live_batch(const LiveFeed::batch_t& batch);
+    void append_trackpoints(const TrackpointChunk& chunk, time::microseconds_t timestamp_shift);
+    void extend_indexes();
+
+    size_t get_trackpoint_column(field_id_t field_id) const;
+    const TrackpointStore* get_trackpoint_store(field_id_t field_id, size_t& column) const;
+    Value evaluate(const FieldHandle& field, time::microseconds_t timestamp, TrackCursor& cursor,
+                   time::microseconds_t& valid_until) const;
+    bool get_baked_value(const FieldHandle& field, time::microseconds_t timestamp, Value& value) const;
+    time::microseconds_t get_next_trackpoint_time(const TrackpointStore& store, time::microseconds_t timestamp, TrackCursor& cursor) const;
+    time::microseconds_t get_segment_valid_until(field_id_t field_id, time::microseconds_t timestamp) const;
+    Value get_trackpoint_value(const TrackpointStore& store, size_t column, time::microseconds_t timestamp, TrackCursor& cursor) const;
+    Value get_lerp_trackpoint_value(const TrackpointStore& store, size_t column, time::microseconds_t timestamp, TrackCursor& cursor) const;
+    Value get_pchip_trackpoint_value(const TrackpointStore& store, size_t column, time::microseconds_t timestamp, TrackCursor& cursor) const;
+    Value make_trackpoint_value(const TrackpointStore& store, size_t column, size_t index) const;
+    const std::vector<double>* get_cumulative_series(field_id_t field_id) const;
+    Value get_cumulative_value(const std::vector<double>& series, time::microseconds_t timestamp, TrackCursor& cursor) const;
+
+    const SegmentIndex* get_segment_index(field_id_t segment_type) const;
 
     field_id_t register_metadata_field(const std::string& key);
     field_id_t register_custom_data_field(const std::string& key);
+    field_id_t register_custom_series_field(const std::string& key);
     field_id_t register_trackpoint_field(const std::string& key);
-    field_id_t register_virtual_field(const std::string& key);
 
     field_id_t register_field(const std::string& key, field_id_t mask);
 
     time::microseconds_t to_relative_time_domain(time::time_point_t timestamp) const;
 
-    std::map<std::string, field_id_t> field_ids_;
+    FieldDictionary field_ids_;
     field_id_t next_field_id_ = 0;
 
     fields_map_t metadata_;
-    trackpoint_data_map_t trackpoints_;
-    std::map<field_id_t, std::function<Value(time::microseconds_t)>> virtual_data_mapping_;
+    TrackpointStore trackpoints_;
+    std::map<field_id_t, size_t> trackpoint_columns_;
+    // trackpoint element name (as in document, with namespace prefix) -> column, filled while parsing
+    std::vector<std::pair<std::string, size_t>> trackpoint_handles_;
+
+    // time series from custom data, own timestamps each - see load_custom_series
+    std::vector<std::unique_ptr<TrackpointStore>> custom_series_;
+    std::map<field_id_t, std::pair<const TrackpointStore*, size_t>> custom_series_columns_; // field -> store, column
 
     std::map<std::string, field_id_t> segment_types_;
     segments_lut_t segments_lut_;
-    std::map<field_id_t, std::vector<field_id_t>> segments_ordered_by_start_time_;
-    std::map<field_id_t, std::vector<field_id_t>> segments_ordered_by_end_time_;
+    std::map<field_id_t, SegmentIndex> segment_index_;
 
     std::map<std::string, field_id_t> segment_metadata_partial_field_ids_;
     field_id_t next_segment_metadata_field_id_ = 0;
 
+    // segment point fields, see generate_segment_point_fields
+    std::vector<size_t> segment_point_columns_;                    // field within segment -> trackpoint column
+    std::map<field_id_t, std::vector<size_t>> segment_start_indexes_; // [segment type][instance] = trackpoint at start
+    // [segment type][instance * segment metadata field count + field], see build_segment_metadata_index
+    std::vector<std::vector<Value>> segment_metadata_index_;
+
     time::microseconds_t min_timestamp_ = time::INVALID_TIME;
     time::microseconds_t max_timestamp_ = 0;
 
     time::time_point_t start_time_ = time::INVALID_TIME_POINT;
     time::microseconds_t start_offset_ = 0;
+
+    // interpolated fields at frame timestamps, null unless frame rate is set
+    std::unique_ptr<BakedTimeline> baked_;
+
+    // by store and column, see get_window_index
+    mutable std::map<std::pair<const TrackpointStore*, size_t>, std::unique_ptr<WindowIndex>> window_indexes_;
+    mutable std::mutex window_indexes_mutex_;
+
+    // by store and column, see get_min_max_pyramid
+    mutable std::map<std::pair<const TrackpointStore*, size_t>, std::unique_ptr<MinMaxPyramid>> min_max_pyramids_;
+    mutable std::mutex min_max_pyramids_mutex_;
+
+    // by trackpoint column, built on first bind/query of any of its cumulative fields
+    mutable std::map<size_t, std::unique_ptr<CumulativeStats>> cumulative_stats_;
+    mutable std::mutex cumulative_stats_mutex_;
+
+    // handle queries of the current frame
+    mutable QueryCache query_cache_;
+
+    // riders of a track set by rider number - prefix of their merged trackpoint fields, see build_race_index
+    struct rider_t {
+        std::string prefix;
+        std::string name;
+    };
+    std::vector<rider_t> riders_;
+    std::unique_ptr<RaceIndex> race_; // null unless track set has riders, updated by rider field queries
+    mutable std::mutex race_mutex_;
+
+    // mapped snapshot backing trackpoints_, segment_index_ and dictionary/metadata lookups when loaded from it
+    std::unique_ptr<TrackSnapshot> snapshot_;
+
+    // null unless track is followed live, see load_live; last member - feed thread is stopped first
+    std::unique_ptr<LiveFeed> live_;
 };
 
 } // namespace track
@@ -0,0 +1,34 @@
+#ifndef TRACK_CURSOR_H
+#define TRACK_CURSOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace telemetry {
+namespace track {
+
+/* Lookup hint for sequential trackpoint queries.
+ *
+ * Remembers last bracketing trackpoint index, so queries with monotonically
+ * increasing timestamps (video frames) move forward in amortized O(1).
+ * Backward seeks fall back to binary search.
+ * Not thread safe - meant to be owned by a single parameter/expression. */
+class TrackCursor {
+public:
+    TrackCursor() = default;
+    ~TrackCursor() = default;
+
+    void reset() {
+        index_ = SIZE_MAX;
+    }
+
+private:
+    friend class TrackpointStore;
+
+    size_t index_ = SIZE_MAX; // SIZE_MAX - before first trackpoint / not positioned
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // TRACK_CURSOR_H
@@ -0,0 +1,276 @@
+#include "track_snapshot.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace telemetry {
+namespace track {
+namespace consts {
+    constexpr char magic[8] = {'G', 'S', 'T', 'T', 'S', 'N', 'A', 'P'};
+    constexpr size_t alignment = 8;
+    constexpr uint32_t byte_order_mark = 0x01020304;
+
+    const std::string cache_dir = "gst-telemetry";
+    const std::string extension = ".snapshot";
+}
+
+namespace {
+    struct header_t {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order_mark;
+        uint32_t section_count;
+        uint32_t reserved;
+        snapshot::source_t source;
+        uint64_t file_size;
+    };
+
+    struct section_entry_t {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    size_t align_up(size_t value) {
+        return (value + consts::alignment - 1) / consts::alignment * consts::alignment;
+    }
+
+    uint64_t fnv1a(std::string_view str) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (unsigned char c : str) {
+            hash ^= c;
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+}
+
+namespace snapshot {
+
+bool get_source(const std::string& path, time::microseconds_t time_offset, source_t& source) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return false;
+    }
+
+    source.size = static_cast<uint64_t>(size);
+    source.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    source.time_offset = time_offset;
+    return true;
+}
+
+std::string cache_path(const std::string& source_path) {
+    std::filesystem::path dir;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        dir = xdg;
+    } else if (const char* home = std::getenv("HOME"); home && *home) {
+        dir = std::filesystem::path(home) / ".cache";
+    } else {
+        return {};
+    }
+
+    std::error_code ec;
+    auto absolute = std::filesystem::absolute(source_path, ec);
+    if (ec) {
+        return {};
+    }
+
+    std::string name = std::format("{:016x}", fnv1a(absolute.string())) + consts::extension;
+    return (dir / consts::cache_dir / name).string();
+}
+
+} // namespace snapshot
+
+snapshot::string_ref_t TrackSnapshotWriter::add_string(std::string_view str) {
+    snapshot::string_ref_t ref{static_cast<uint32_t>(strings_.size()), static_cast<uint32_t>(str.size())};
+    strings_.append(str);
+    return ref;
+}
+
+snapshot::array_ref_t TrackSnapshotWriter::add_array_bytes(const void* data, size_t count, size_t element_size) {
+    size_t offset = align_up(arrays_.size());
+    arrays_.resize(offset + count * element_size);
+    if (count > 0) {
+        std::memcpy(arrays_.data() + offset, data, count * element_size);
+    }
+    return {offset, count};
+}
+
+void TrackSnapshotWriter::set_section_bytes(snapshot::Section section, const void* data, size_t size) {
+    auto& bytes = sections_[static_cast<size_t>(section)];
+    bytes.resize(size);
+    if (size > 0) {
+        std::memcpy(bytes.data(), data, size);
+    }
+}
+
+bool TrackSnapshotWriter::write(const std::string& path, const snapshot::source_t& source) {
+    set_section_bytes(snapshot::Section::Strings, strings_.data(), strings_.size());
+    set_section_bytes(snapshot::Section::Arrays, arrays_.data(), arrays_.size());
+
+    size_t section_count = sections_.size();
+    std::vector<section_entry_t> table(section_count);
+
+    size_t offset = align_up(sizeof(header_t) + section_count * sizeof(section_entry_t));
+    for (size_t i = 0; i < section_count; ++i) {
+        table[i] = {offset, sections_[i].size()};
+        offset = align_up(offset + sections_[i].size());
+    }
+
+    header_t header{};
+    std::memcpy(header.magic, consts::magic, sizeof(header.magic));
+    header.version = snapshot::version;
+    header.byte_order_mark = consts::byte_order_mark;
+    header.section_count = static_cast<uint32_t>(section_count);
+    header.source = source;
+    header.file_size = offset;
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+    if (ec) {
+        log.warning("Failed to create snapshot directory for {}: {}", path, ec.message());
+        return false;
+    }
+
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            log.warning("Failed to open snapshot file for writing: {}", tmp_path);
+            return false;
+        }
+
+        const char zeros[consts::alignment] = {};
+        size_t written = 0;
+        auto put = [&out, &written, &zeros](const void* data, size_t size, size_t target) {
+            if (target > written) {
+                out.write(zeros, static_cast<std::streamsize>(target - written));
+                written = target;
+            }
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            written += size;
+        };
+
+        put(&header, sizeof(header), 0);
+        put(table.data(), table.size() * sizeof(section_entry_t), sizeof(header));
+        for (size_t i = 0; i < section_count; ++i) {
+            put(sections_[i].data(), sections_[i].size(), table[i].offset);
+        }
+        put(nullptr, 0, offset);
+
+        if (!out) {
+            log.warning("Failed to write snapshot file: {}", tmp_path);
+            std::filesystem::remove(tmp_path, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        log.warning("Failed to move snapshot file to {}: {}", path, ec.message());
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+
+    log.info("Written track snapshot: {} ({} bytes)", path, offset);
+    return true;
+}
+
+TrackSnapshot::~TrackSnapshot() {
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+}
+
+bool TrackSnapshot::open(const std::string& path, const snapshot::source_t& source) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        log.debug("No track snapshot found at {}", path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(header_t)) {
+        log.warning("Invalid track snapshot file: {}", path);
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        log.warning("Failed to map track snapshot: {}", path);
+        return false;
+    }
+
+    const header_t* header = static_cast<const header_t*>(data);
+    const char* reason = nullptr;
+    if (std::memcmp(header->magic, consts::magic, sizeof(header->magic)) != 0) {
+        reason = "not a track snapshot";
+    } else if (header->version != snapshot::version || header->byte_order_mark != consts::byte_order_mark) {
+        reason = "incompatible version";
+    } else if (header->file_size != size ||
+               header->section_count != static_cast<uint32_t>(snapshot::Section::Count) ||
+               sizeof(header_t) + header->section_count * sizeof(section_entry_t) > size) {
+        reason = "truncated file";
+    } else if (header->source.size != source.size || header->source.mtime != source.mtime) {
+        reason = "source file changed";
+    } else if (header->source.time_offset != source.time_offset) {
+        reason = "different track offset";
+    }
+
+    if (!reason) {
+        auto table = reinterpret_cast<const section_entry_t*>(static_cast<const uint8_t*>(data) + sizeof(header_t));
+        for (uint32_t i = 0; i < header->section_count; ++i) {
+            if (table[i].offset % consts::alignment != 0 ||
+                table[i].offset > size || table[i].size > size - table[i].offset) {
+                reason = "broken section table";
+                break;
+            }
+        }
+    }
+
+    if (reason) {
+        log.info("Ignoring track snapshot {}: {}", path, reason);
+        munmap(data, size);
+        return false;
+    }
+
+    data_ = static_cast<const uint8_t*>(data);
+    size_ = size;
+
+    log.info("Mapped track snapshot: {} ({} bytes)", path, size);
+    return true;
+}
+
+std::string_view TrackSnapshot::string(snapshot::string_ref_t ref) const {
+    auto strings = section_bytes(snapshot::Section::Strings);
+    if (ref.offset > strings.size() || ref.length > strings.size() - ref.offset) {
+        return {};
+    }
+    return {reinterpret_cast<const char*>(strings.data()) + ref.offset, ref.length};
+}
+
+std::span<const uint8_t> TrackSnapshot::section_bytes(snapshot::Section section) const {
+    if (!data_) {
+        return {};
+    }
+    auto table = reinterpret_cast<const section_entry_t*>(data_ + sizeof(header_t));
+    const auto& entry = table[static_cast<size_t>(section)];
+    return {data_ + entry.offset, entry.size};
+}
+
+} // namespace track
+} // namespace telemetry
@@ -0,0 +1,199 @@
+#ifndef TRACK_SNAPSHOT_H
+#define TRACK_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "backend/utils/logging/logger.h"
+#include "backend/utils/time.h"
+
+namespace telemetry {
+namespace track {
+
+/* Versioned binary snapshot of a parsed track.
+ *
+ * File layout: header, section table and 8 byte aligned sections of plain
+ * records (see snapshot namespace below). Snapshot is a local cache so all
+ * values are stored in native byte order. It is only used when the source
+ * file size and mtime and the track time offset match the ones stored in
+ * the header. Reader memory maps the file and hands out spans pointing
+ * straight into the mapping. */
+namespace snapshot {
+    constexpr uint32_t version = 2; // 2 - 64 bit field ids
+
+    enum class Section : uint32_t {
+        Info,               // info_t (single record)
+        Strings,            // char blob referenced by string_ref_t
+        Arrays,             // raw 8 byte aligned arrays referenced by array_ref_t
+        Dictionary,         // dictionary_record_t sorted by name
+        Metadata,           // metadata_record_t sorted by field id
+        Columns,            // column_record_t in trackpoint store column order
+        SegmentTypes,       // named_id_record_t
+        SegmentFields,      // named_id_record_t (segment metadata partial field ids)
+        Segments,           // segment_record_t
+        SegmentIndexes,     // segment_index_record_t
+        Count
+    };
+
+    struct string_ref_t {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct array_ref_t {
+        uint64_t offset; // bytes from start of Arrays section
+        uint64_t count;  // elements
+    };
+
+    struct info_t {
+        int64_t start_time;     // system clock ticks since epoch
+        int64_t min_timestamp;
+        int64_t max_timestamp;
+        uint64_t next_field_id;
+        uint64_t next_segment_metadata_field_id;
+        array_ref_t timestamps;
+    };
+
+    struct dictionary_record_t {
+        string_ref_t name;
+        uint64_t field_id;
+    };
+
+    enum class ValueType : uint32_t {
+        Invalid,
+        Double,
+        Bool,
+        String,    // payload = string offset << 32 | length
+        TimePoint, // payload = system clock ticks since epoch
+    };
+
+    struct metadata_record_t {
+        uint64_t field_id;
+        ValueType type;
+        uint32_t reserved;
+        uint64_t payload;
+    };
+
+    struct column_record_t {
+        uint64_t field_id;
+        uint32_t type; // TrackpointStore::ColumnType
+        uint32_t reserved;
+        array_ref_t values;
+        array_ref_t validity;
+        array_ref_t slopes;
+    };
+
+    struct named_id_record_t {
+        string_ref_t name;
+        uint64_t id;
+    };
+
+    struct segment_record_t {
+        uint64_t type_id;
+        uint64_t instance;
+        int64_t start_time; // system clock ticks since epoch
+        int64_t end_time;
+    };
+
+    struct segment_index_record_t {
+        uint64_t type_id;
+        array_ref_t starts;
+        array_ref_t by_start;
+        array_ref_t ends;
+        array_ref_t by_end;
+        array_ref_t boundaries;
+        array_ref_t active_offsets;
+        array_ref_t active;
+    };
+
+    /* identifies source the snapshot was created from */
+    struct source_t {
+        uint64_t size;
+        int64_t mtime;
+        int64_t time_offset; // track offset - trackpoint timestamps depend on it
+    };
+
+    bool get_source(const std::string& path, time::microseconds_t time_offset, source_t& source);
+
+    /* snapshot location in user cache directory, empty if there is none */
+    std::string cache_path(const std::string& source_path);
+} // namespace snapshot
+
+class TrackSnapshotWriter {
+public:
+    TrackSnapshotWriter() = default;
+    ~TrackSnapshotWriter() = default;
+
+    snapshot::string_ref_t add_string(std::string_view str);
+
+    template<typename T>
+    snapshot::array_ref_t add_array(std::span<const T> array) {
+        return add_array_bytes(array.data(), array.size(), sizeof(T));
+    }
+
+    template<typename T>
+    void set_section(snapshot::Section section, std::span<const T> records) {
+        set_section_bytes(section, records.data(), records.size_bytes());
+    }
+
+    /* writes to temporary file first and renames it, so readers never see partial snapshot */
+    bool write(const std::string& path, const snapshot::source_t& source);
+
+private:
+    snapshot::array_ref_t add_array_bytes(const void* data, size_t count, size_t element_size);
+    void set_section_bytes(snapshot::Section section, const void* data, size_t size);
+
+    mutable utils::logging::Logger log{"snapshot"};
+
+    std::string strings_;
+    std::vector<uint8_t> arrays_;
+    std::vector<std::vector<uint8_t>> sections_{static_cast<size_t>(snapshot::Section::Count)};
+};
+
+class TrackSnapshot {
+public:
+    TrackSnapshot() = default;
+    ~TrackSnapshot();
+
+    /* maps snapshot, fails if it is missing, broken or created from different source */
+    bool open(const std::string& path, const snapshot::source_t& source);
+
+    template<typename T>
+    std::span<const T> section(snapshot::Section section) const {
+        auto bytes = section_bytes(section);
+        return {reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T)};
+    }
+
+    /* array from Arrays section, empty span if reference is out of bounds */
+    template<typename T>
+    std::span<const T> array(snapshot::array_ref_t ref) const {
+        auto arrays = section_bytes(snapshot::Section::Arrays);
+        if (ref.offset % alignof(T) != 0 || ref.offset > arrays.size() ||
+            ref.count > (arrays.size() - ref.offset) / sizeof(T)) {
+            return {};
+        }
+        return {reinterpret_cast<const T*>(arrays.data() + ref.offset), ref.count};
+    }
+
+    std::string_view string(snapshot::string_ref_t ref) const;
+
+private:
+    std::span<const uint8_t> section_bytes(snapshot::Section section) const;
+
+    mutable utils::logging::Logger log{"snapshot"};
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+
+    TrackSnapshot(const TrackSnapshot&) = delete;
+    TrackSnapshot& operator=(const TrackSnapshot&) = delete;
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // TRACK_SNAPSHOT_H
@@ -0,0 +1,73 @@
+#include "trackpoint_chunk.h"
+
+namespace telemetry {
+namespace track {
+
+uint32_t TrackpointChunk::key_index(std::string_view name, TrackpointStore::ColumnType type) {
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        if (keys_[i].name == name) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    keys_.push_back({std::string(name), type});
+    return static_cast<uint32_t>(keys_.size() - 1);
+}
+
+void TrackpointChunk::add(time::microseconds_t timestamp, uint32_t key, double value) {
+    timestamps_.push_back(timestamp);
+    key_indexes_.push_back(key);
+    values_.push_back(value);
+}
+
+void TrackpointChunk::append(const TrackpointChunk& other) {
+    std::vector<uint32_t> keys;
+    keys.reserve(other.keys_.size());
+    for (const auto& key : other.keys_) {
+        keys.push_back(key_index(key.name, key.type));
+    }
+
+    timestamps_.insert(timestamps_.end(), other.timestamps_.begin(), other.timestamps_.end());
+    values_.insert(values_.end(), other.values_.begin(), other.values_.end());
+    key_indexes_.reserve(key_indexes_.size() + other.key_indexes_.size());
+    for (uint32_t key : other.key_indexes_) {
+        key_indexes_.push_back(keys[key]);
+    }
+
+    if (other.start_time != time::INVALID_TIME_POINT &&
+        (start_time == time::INVALID_TIME_POINT || other.start_time < start_time)) {
+        start_time = other.start_time;
+    }
+    ok = other.ok && ok;
+}
+
+void TrackpointChunk::clear() {
+    keys_.clear();
+    timestamps_.clear();
+    key_indexes_.clear();
+    values_.clear();
+    start_time = time::INVALID_TIME_POINT;
+    ok = true;
+}
+
+size_t TrackpointChunk::size() const {
+    return values_.size();
+}
+
+const std::vector<TrackpointChunk::key_t>& TrackpointChunk::keys() const {
+    return keys_;
+}
+
+std::span<const time::microseconds_t> TrackpointChunk::timestamps() const {
+    return timestamps_;
+}
+
+std::span<const uint32_t> TrackpointChunk::key_indexes() const {
+    return key_indexes_;
+}
+
+std::span<const double> TrackpointChunk::values() const {
+    return values_;
+}
+
+} // namespace track
+} // namespace telemetry
@@ -0,0 +1,58 @@
+#ifndef TRACKPOINT_CHUNK_H
+#define TRACKPOINT_CHUNK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "backend/utils/time.h"
+#include "trackpoint_store.h"
+
+namespace telemetry {
+namespace track {
+
+/* Trackpoint values parsed from a contiguous run of trkpts.
+ *
+ * Filled without touching the track (so chunks can be parsed concurrently)
+ * and merged into the trackpoint store afterwards, in document order. Keys
+ * are element names in order of first appearance within the chunk, which
+ * keeps field id assignment identical to sequential parsing. */
+class TrackpointChunk {
+public:
+    struct key_t {
+        std::string name; // element name as in document (with namespace prefix)
+        TrackpointStore::ColumnType type;
+    };
+
+    TrackpointChunk() = default;
+    ~TrackpointChunk() = default;
+
+    uint32_t key_index(std::string_view name, TrackpointStore::ColumnType type);
+    void add(time::microseconds_t timestamp, uint32_t key, double value);
+    /* values of a chunk parsed after this one, its keys are mapped to keys of this chunk */
+    void append(const TrackpointChunk& other);
+    void clear();
+
+    size_t size() const;
+    const std::vector<key_t>& keys() const;
+    std::span<const time::microseconds_t> timestamps() const;
+    std::span<const uint32_t> key_indexes() const;
+    std::span<const double> values() const;
+
+    time::time_point_t start_time = time::INVALID_TIME_POINT; // earliest trackpoint time
+    bool ok = true;
+
+private:
+    std::vector<key_t> keys_;
+    std::vector<time::microseconds_t> timestamps_;
+    std::vector<uint32_t> key_indexes_;
+    std::vector<double> values_;
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // TRACKPOINT_CHUNK_H
@@ -0,0 +1,349 @@
+#include "trackpoint_store.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace telemetry {
+namespace track {
+namespace consts {
+    // forward steps checked linearly before cursor falls back to binary search
+    constexpr size_t cursor_linear_steps = 4;
+}
+
+namespace {
+    /* Fritsch-Carlson (weighted harmonic mean) derivative at the middle of three
+     * consecutive samples (t - seconds, v - values) */
+    double pchip_tangent(double t0, double t1, double t2, double v0, double v1, double v2) {
+        // intervals
+        double h0 = t1 - t0;
+        double h1 = t2 - t1;
+
+        // secant slopes
+        double d0 = (v1 - v0) / h0;
+        double d1 = (v2 - v1) / h1;
+
+        if (d0 * d1 > 0) {
+            return (h0 + h1) / ((h1 / d0) + (h0 / d1));
+        }
+        return 0.0;
+    }
+}
+
+/* column added to a built store (e.g. field first seen in a live track) has no samples in existing rows */
+size_t TrackpointStore::add_column(ColumnType type) {
+    size_t count = timestamps_storage_.size();
+    Column column{type, {}, {}, {}};
+    column.values.assign(count, std::numeric_limits<double>::quiet_NaN());
+    column.validity.assign((count + 63) / 64, 0);
+    if (type == ColumnType::Double) {
+        column.slopes.assign(count, std::numeric_limits<double>::quiet_NaN());
+    }
+    if (!joined_.empty()) {
+        joined_.emplace_back((count + 63) / 64, 0);
+    }
+    columns_.push_back(std::move(column));
+    views_.push_back(column_view_t{type, {}, {}, {}});
+    if (count > 0) {
+        update_views();
+    }
+    return columns_.size() - 1;
+}
+
+void TrackpointStore::set(time::microseconds_t timestamp, size_t column, double value) {
+    staged_.push_back({timestamp, column, value});
+}
+
+void TrackpointStore::build(time::microseconds_t timestamp_shift) {
+    if (timestamp_shift != 0) {
+        for (auto& sample : staged_) {
+            sample.timestamp += timestamp_shift;
+        }
+    }
+
+    // stable sort keeps insertion order within a timestamp - later value wins like in a map
+    std::stable_sort(staged_.begin(), staged_.end(),
+                     [](const staged_sample_t& a, const staged_sample_t& b) {
+                         return a.timestamp < b.timestamp;
+                     });
+
+    timestamps_storage_.clear();
+    for (const auto& sample : staged_) {
+        if (timestamps_storage_.empty() || timestamps_storage_.back() != sample.timestamp) {
+            timestamps_storage_.push_back(sample.timestamp);
+        }
+    }
+    timestamps_storage_.shrink_to_fit();
+    timestamps_ = timestamps_storage_;
+
+    size_t count = timestamps_.size();
+    size_t words = (count + 63) / 64;
+    for (auto& column : columns_) {
+        column.values.assign(count, std::numeric_limits<double>::quiet_NaN());
+        column.validity.assign(words, 0);
+    }
+
+    size_t idx = 0;
+    for (const auto& sample : staged_) {
+        while (timestamps_[idx] != sample.timestamp) {
+            ++idx;
+        }
+        Column& column = columns_[sample.column];
+        column.values[idx] = sample.value;
+        column.validity[idx / 64] |= (uint64_t{1} << (idx % 64));
+    }
+
+    staged_.clear();
+    staged_.shrink_to_fit();
+    joined_.clear();
+
+    build_views();
+}
+
+void TrackpointStore::build(std::vector<time::microseconds_t> timestamps, std::vector<std::vector<double>> values,
+                            std::vector<std::vector<uint64_t>> joined) {
+    staged_.clear();
+    timestamps_storage_ = std::move(timestamps);
+    timestamps_ = timestamps_storage_;
+
+    size_t count = timestamps_.size();
+    size_t words = (count + 63) / 64;
+    for (size_t c = 0; c < columns_.size(); ++c) {
+        Column& column = columns_[c];
+        column.values = (c < values.size()) ? std::move(values[c]) : std::vector<double>{};
+        column.values.resize(count, std::numeric_limits<double>::quiet_NaN());
+        column.validity.assign(words, 0);
+        for (size_t idx = 0; idx < count; ++idx) {
+            if (!std::isnan(column.values[idx])) {
+                column.validity[idx / 64] |= (uint64_t{1} << (idx % 64));
+            }
+        }
+    }
+    joined_ = std::move(joined);
+
+    build_views();
+}
+
+void TrackpointStore::append(std::span<const time::microseconds_t> timestamps,
+                             const std::vector<std::vector<double>>& values) {
+    if (timestamps.empty()) {
+        return;
+    }
+    size_t first = timestamps_storage_.size();
+    timestamps_storage_.insert(timestamps_storage_.end(), timestamps.begin(), timestamps.end());
+    timestamps_ = timestamps_storage_;
+
+    size_t count = timestamps_storage_.size();
+    size_t words = (count + 63) / 64;
+    for (size_t c = 0; c < columns_.size(); ++c) {
+        Column& column = columns_[c];
+        column.values.resize(count, std::numeric_limits<double>::quiet_NaN());
+        column.validity.resize(words, 0);
+        if (c < values.size()) {
+            for (size_t idx = first; idx < count; ++idx) {
+                double value = values[c][idx - first];
+                if (!std::isnan(value)) {
+                    column.values[idx] = value;
+                    column.validity[idx / 64] |= (uint64_t{1} << (idx % 64));
+                }
+            }
+        }
+    }
+    for (auto& joined : joined_) {
+        joined.resize(words, 0);
+    }
+
+    // tangent of the old last row gets its right neighbour now
+    auto seconds = [this](size_t idx) {
+        return time::us_to_s(timestamps_[idx]);
+    };
+    for (auto& column : columns_) {
+        if (column.type != ColumnType::Double) {
+            continue;
+        }
+        column.slopes.resize(count, std::numeric_limits<double>::quiet_NaN());
+        auto valid = [&column](size_t idx) {
+            return (column.validity[idx / 64] >> (idx % 64)) & 1;
+        };
+        for (size_t i = std::max<size_t>(first, 2) - 1; i + 1 < count; ++i) {
+            if (valid(i - 1) && valid(i) && valid(i + 1)) {
+                column.slopes[i] = pchip_tangent(seconds(i - 1), seconds(i), seconds(i + 1),
+                                                 column.values[i - 1], column.values[i], column.values[i + 1]);
+            }
+        }
+    }
+
+    update_views();
+}
+
+void TrackpointStore::set_growing(bool growing) {
+    growing_ = growing;
+}
+
+bool TrackpointStore::is_growing() const {
+    return growing_;
+}
+
+void TrackpointStore::clear() {
+    staged_.clear();
+    timestamps_storage_.clear();
+    columns_.clear();
+    joined_.clear();
+    timestamps_ = {};
+    views_.clear();
+}
+
+/* slopes and views of built columns */
+void TrackpointStore::build_views() {
+    // shared by slopes of all columns
+    std::vector<double> seconds(timestamps_.size());
+    for (size_t i = 0; i < timestamps_.size(); ++i) {
+        seconds[i] = time::us_to_s(timestamps_[i]);
+    }
+
+    for (auto& column : columns_) {
+        if (column.type == ColumnType::Double) {
+            build_pchip_slopes(column, seconds);
+        } else {
+            column.slopes.clear();
+            column.slopes.shrink_to_fit();
+        }
+    }
+
+    update_views();
+}
+
+void TrackpointStore::update_views() {
+    views_.clear();
+    for (const auto& column : columns_) {
+        views_.push_back(column_view_t{column.type, column.values, column.validity, column.slopes});
+    }
+}
+
+void TrackpointStore::attach(std::span<const time::microseconds_t> timestamps, std::vector<column_view_t> columns) {
+    staged_.clear();
+    timestamps_storage_.clear();
+    columns_.clear();
+    joined_.clear();
+
+    timestamps_ = timestamps;
+    views_ = std::move(columns);
+}
+
+TrackpointStore::column_view_t TrackpointStore::column(size_t column) const {
+    return views_[column];
+}
+
+void TrackpointStore::build_pchip_slopes(Column& column, std::span<const double> seconds) {
+    // Fritsch-Carlson derivative at every trackpoint,
+    // computed from its two neighbours - endpoints and points with a missing
+    // neighbour stay NaN as they can not bound a PCHIP interval
+    size_t count = timestamps_.size();
+    column.slopes.assign(count, std::numeric_limits<double>::quiet_NaN());
+
+    auto valid = [&column](size_t idx) {
+        return (column.validity[idx / 64] >> (idx % 64)) & 1;
+    };
+
+    for (size_t i = 1; i + 1 < count; ++i) {
+        if (!valid(i - 1) || !valid(i) || !valid(i + 1)) {
+            continue;
+        }
+
+        column.slopes[i] = pchip_tangent(seconds[i - 1], seconds[i], seconds[i + 1],
+                                         column.values[i - 1], column.values[i], column.values[i + 1]);
+    }
+}
+
+size_t TrackpointStore::size() const {
+    return timestamps_.size();
+}
+
+size_t TrackpointStore::column_count() const {
+    return views_.size();
+}
+
+std::span<const time::microseconds_t> TrackpointStore::timestamps() const {
+    return timestamps_;
+}
+
+TrackpointStore::ColumnType TrackpointStore::column_type(size_t column) const {
+    return views_[column].type;
+}
+
+std::span<const double> TrackpointStore::column_values(size_t column) const {
+    return views_[column].values;
+}
+
+bool TrackpointStore::is_valid(size_t column, size_t index) const {
+    return (views_[column].validity[index / 64] >> (index % 64)) & 1;
+}
+
+bool TrackpointStore::is_sample(size_t column, size_t index) const {
+    if (!is_valid(column, index)) {
+        return false;
+    }
+    return joined_.empty() || !((joined_[column][index / 64] >> (index % 64)) & 1);
+}
+
+double TrackpointStore::value(size_t column, size_t index) const {
+    return views_[column].values[index];
+}
+
+double TrackpointStore::pchip_slope(size_t column, size_t index) const {
+    return views_[column].slopes[index];
+}
+
+size_t TrackpointStore::floor_index(time::microseconds_t timestamp) const {
+    auto it = std::upper_bound(timestamps_.begin(), timestamps_.end(), timestamp);
+    if (it == timestamps_.begin()) {
+        return npos;
+    }
+    return static_cast<size_t>(std::distance(timestamps_.begin(), it)) - 1;
+}
+
+size_t TrackpointStore::floor_index(time::microseconds_t timestamp, TrackCursor& cursor) const {
+    size_t count = timestamps_.size();
+    size_t hint = cursor.index_;
+    size_t idx = npos;
+
+    if (hint != npos && hint < count && timestamps_[hint] <= timestamp) {
+        // forward seek - typically same or next trackpoint
+        idx = hint;
+        size_t steps = 0;
+        while (idx + 1 < count && timestamps_[idx + 1] <= timestamp && steps < consts::cursor_linear_steps) {
+            ++idx;
+            ++steps;
+        }
+        if (idx + 1 < count && timestamps_[idx + 1] <= timestamp) {
+            // long jump forward - binary search over remaining trackpoints only
+            auto it = std::upper_bound(timestamps_.begin() + idx + 1, timestamps_.end(), timestamp);
+            idx = static_cast<size_t>(std::distance(timestamps_.begin(), it)) - 1;
+        }
+    } else if (hint == npos && (count == 0 || timestamp < timestamps_.front())) {
+        // still before first trackpoint
+        idx = npos;
+    } else {
+        // backward seek (or first positioning)
+        idx = floor_index(timestamp);
+    }
+
+    cursor.index_ = idx;
+    return idx;
+}
+
+size_t TrackpointStore::memory_usage() const {
+    size_t bytes = timestamps_.size_bytes();
+    for (const auto& view : views_) {
+        bytes += view.values.size_bytes();
+        bytes += view.validity.size_bytes();
+        bytes += view.slopes.size_bytes();
+    }
+    for (const auto& joined : joined_) {
+        bytes += joined.size() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+} // namespace track
+} // namespace telemetry
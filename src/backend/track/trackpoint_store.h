@@ -0,0 +1,140 @@
+#ifndef TRACKPOINT_STORE_H
+#define TRACKPOINT_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "backend/utils/time.h"
+#include "track_cursor.h"
+
+namespace telemetry {
+namespace track {
+
+/* Columnar (struct-of-arrays) storage of trackpoint data.
+ *
+ * Samples are staged with set() while the track is parsed, build() then
+ * turns them into a sorted timestamp array and one dense double column
+ * (with validity bitmap) per field. Already columnar, sorted data (e.g. CSV
+ * time series) skips staging and is moved in as is. Double columns also get PCHIP tangents
+ * precomputed at build time. Lookups only work on a built store.
+ *
+ * Rows of a column can be marked as joined - valid, but filled in from the
+ * column's own samples around them (merged timeline of several sources), so
+ * statistics can skip them, see is_sample().
+ *
+ * Instead of building, a store can be attached to externally owned arrays
+ * (e.g. a memory mapped track snapshot) which are then used as is.
+ *
+ * A built store can grow - rows appended after the last one (live track)
+ * extend the columns in place, only PCHIP tangents next to the old last row
+ * are recomputed. Views are refreshed, so spans taken before an append are
+ * invalid after it.
+ *
+ * Indexes over its columns (WindowIndex, CumulativeStats, MinMaxPyramid,
+ * RaceIndex) keep a reference to the store they are built from - the store
+ * has to outlive them. */
+class TrackpointStore {
+public:
+    static constexpr size_t npos = SIZE_MAX;
+
+    enum class ColumnType : uint8_t {
+        Double,
+        TimePoint, // stored as microseconds since epoch
+    };
+
+    struct column_view_t {
+        ColumnType type;
+        std::span<const double> values;
+        std::span<const uint64_t> validity;
+        std::span<const double> slopes; // empty for non Double columns
+    };
+
+    TrackpointStore() = default;
+    ~TrackpointStore() = default;
+
+    size_t add_column(ColumnType type);
+    void set(time::microseconds_t timestamp, size_t column, double value);
+    /* timestamp_shift is added to all staged timestamps */
+    void build(time::microseconds_t timestamp_shift = 0);
+    /* builds from whole columns instead of staged samples - timestamps have to be strictly
+     * increasing, one value per timestamp in each added column (NaN where missing) */
+    void build(std::vector<time::microseconds_t> timestamps, std::vector<std::vector<double>> values,
+               std::vector<std::vector<uint64_t>> joined = {});
+    /* rows after the last one of a built store - same rules as for building from whole columns;
+     * columns added since build (with no samples in existing rows) are included */
+    void append(std::span<const time::microseconds_t> timestamps, const std::vector<std::vector<double>>& values);
+    /* drops all columns and samples (owned or attached) */
+    void clear();
+
+    /* rows may still be appended - a lookup past the last row can not assume it stays last */
+    void set_growing(bool growing);
+    bool is_growing() const;
+
+    /* use external arrays - they must outlive the store */
+    void attach(std::span<const time::microseconds_t> timestamps, std::vector<column_view_t> columns);
+    column_view_t column(size_t column) const;
+
+    size_t size() const;
+    size_t column_count() const;
+    std::span<const time::microseconds_t> timestamps() const;
+
+    ColumnType column_type(size_t column) const;
+    std::span<const double> column_values(size_t column) const;
+    bool is_valid(size_t column, size_t index) const;
+    /* valid and not joined - a sample the column really has at this trackpoint */
+    bool is_sample(size_t column, size_t index) const;
+    double value(size_t column, size_t index) const;
+    /* PCHIP derivative (per second) at trackpoint, NaN if neighbours are missing */
+    double pchip_slope(size_t column, size_t index) const;
+
+    /* index of last trackpoint with timestamp <= given timestamp, npos if none */
+    size_t floor_index(time::microseconds_t timestamp) const;
+    size_t floor_index(time::microseconds_t timestamp, TrackCursor& cursor) const;
+
+    size_t memory_usage() const;
+
+private:
+    struct staged_sample_t {
+        time::microseconds_t timestamp;
+        size_t column;
+        double value;
+    };
+
+    struct Column {
+        ColumnType type;
+        std::vector<double> values;     // NaN where not valid
+        std::vector<uint64_t> validity; // bit per trackpoint
+        std::vector<double> slopes;     // PCHIP tangents, Double columns only
+    };
+
+    /* seconds - timestamps in seconds */
+    void build_pchip_slopes(Column& column, std::span<const double> seconds);
+    void build_views();
+    void update_views();
+
+    std::vector<staged_sample_t> staged_;
+
+    // owned storage, empty when attached to external arrays
+    std::vector<time::microseconds_t> timestamps_storage_;
+    std::vector<Column> columns_;
+
+    // views used for all lookups
+    std::span<const time::microseconds_t> timestamps_;
+    std::vector<column_view_t> views_;
+
+    // bit per trackpoint of each column, empty if store has no joined rows
+    std::vector<std::vector<uint64_t>> joined_;
+
+    bool growing_ = false;
+
+    // views may point into own storage - copies would dangle
+    TrackpointStore(const TrackpointStore&) = delete;
+    TrackpointStore& operator=(const TrackpointStore&) = delete;
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // TRACKPOINT_STORE_H
@@ -1,27 +1,67 @@
 #include "value.h"
+
+#include <deque>
 #include <format>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 
 namespace telemetry {
 namespace track {
 
+namespace {
+    /* append only, stored strings never move */
+    class InternTable {
+    public:
+        const std::string* intern(std::string_view str) {
+            {
+                std::shared_lock lock(mutex_);
+                auto it = index_.find(str);
+                if (it != index_.end()) {
+                    return it->second;
+                }
+            }
+
+            std::unique_lock lock(mutex_);
+            auto it = index_.find(str);
+            if (it != index_.end()) {
+                return it->second;
+            }
+            const std::string& stored = strings_.emplace_back(str);
+            index_.emplace(stored, &stored);
+            return &stored;
+        }
+
+    private:
+        std::shared_mutex mutex_;
+        std::deque<std::string> strings_;
+        std::unordered_map<std::string_view, const std::string*> index_; // keys point into strings_
+    };
+
+    InternTable& intern_table() {
+        static InternTable table;
+        return table;
+    }
+}
+
 bool Value::is_string() const {
-    return data && std::holds_alternative<std::string>(*data);
+    return type_ == Type::String;
 }
 
 bool Value::is_double() const {
-    return data && std::holds_alternative<double>(*data);
+    return type_ == Type::Double;
 }
 
 bool Value::is_bool() const {
-    return data && std::holds_alternative<bool>(*data);
+    return type_ == Type::Bool;
 }
 
 bool Value::is_time_point() const {
-    return data && std::holds_alternative<time::time_point_t>(*data);
+    return type_ == Type::TimePoint;
 }
 
 bool Value::is_valid() const {
-    return data.has_value();
+    return type_ != Type::Invalid;
 }
 
 Value::operator bool() const {
@@ -30,57 +70,61 @@ Value::operator bool() const {
 
 std::string Value::as_string(const std::string& format) const {
     if (is_string()) {
-        return std::vformat(format, std::make_format_args(std::get<std::string>(*data)));
+        return std::vformat(format, std::make_format_args(*string_));
     }
     if (is_double()) {
-        return std::vformat(format, std::make_format_args(std::get<double>(*data)));
+        return std::vformat(format, std::make_format_args(double_));
     }
     if (is_bool()) {
-        return std::vformat(format, std::make_format_args(std::get<bool>(*data)));
+        return std::vformat(format, std::make_format_args(bool_));
     }
     if (is_time_point()) {
-        return std::vformat(format, std::make_format_args(std::get<time::time_point_t>(*data)));
+        auto tp = as_time_point();
+        return std::vformat(format, std::make_format_args(tp));
     }
     return "";
 }
 
 double Value::as_double() const {
     if (is_double()) {
-        return std::get<double>(*data);
+        return double_;
     }
     if (is_bool()) {
-        return std::get<bool>(*data) ? 1.0 : 0.0;
+        return bool_ ? 1.0 : 0.0;
     }
     return 0.0;
 }
 
 bool Value::as_bool() const {
     if (is_bool()) {
-        return std::get<bool>(*data);
+        return bool_;
     }
     return false;
 }
 
 time::time_point_t Value::as_time_point() const {
     if (is_time_point()) {
-        return std::get<time::time_point_t>(*data);
+        return time::time_point_t(time::time_point_t::duration(time_point_));
     }
     return time::INVALID_TIME_POINT;
 }
 
-Value::Value() : data(std::nullopt) {
+Value::Value() : type_(Type::Invalid), double_(0.0) {
+}
+
+Value::Value(const std::string& str) : Value(std::string_view(str)) {
 }
 
-Value::Value(const std::string& str) : data(str) {
+Value::Value(std::string_view str) : type_(Type::String), string_(intern_table().intern(str)) {
 }
 
-Value::Value(double d) : data(d) {
+Value::Value(double d) : type_(Type::Double), double_(d) {
 }
 
-Value::Value(bool b) : data(b) {
+Value::Value(bool b) : type_(Type::Bool), bool_(b) {
 }
 
-Value::Value(time::time_point_t tp) : data(tp) {
+Value::Value(time::time_point_t tp) : type_(Type::TimePoint), time_point_(tp.time_since_epoch().count()) {
 }
 
 } // namespace track
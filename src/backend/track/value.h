@@ -1,19 +1,23 @@
 #ifndef VALUE_H
 #define VALUE_H
 
-#include <optional>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <format>
-#include <variant>
 
 #include "backend/utils/time.h"
 
 namespace telemetry {
 namespace track {
 
+/* Compact tagged value (16 bytes, trivially copyable).
+ *
+ * Doubles, bools and time points are stored inline. Strings are interned in
+ * process wide append only table and referenced by pointer, so copying or
+ * returning a value never allocates. Interned strings live until exit, they
+ * are meant for track metadata, not for per frame generated text. */
 struct Value {
-    std::optional<std::variant<std::string, double, bool, time::time_point_t>> data;
-
     bool is_string() const;
     bool is_double() const;
     bool is_bool() const;
@@ -29,11 +33,31 @@ struct Value {
 
     Value();
     Value(const std::string& str);
+    Value(std::string_view str);
     Value(double d);
     Value(bool b);
     Value(time::time_point_t tp);
+
+private:
+    enum class Type : uint8_t {
+        Invalid,
+        String,
+        Double,
+        Bool,
+        TimePoint,
+    };
+
+    Type type_;
+    union {
+        const std::string* string_;
+        double double_;
+        bool bool_;
+        time::time_point_t::rep time_point_;
+    };
 };
 
+static_assert(sizeof(Value) == 16);
+
 } // namespace track
 } // namespace telemetry
 
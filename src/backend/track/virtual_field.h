@@ -0,0 +1,44 @@
+#ifndef VIRTUAL_FIELD_H
+#define VIRTUAL_FIELD_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace telemetry {
+namespace track {
+
+/* Virtual fields derived only from the queried timestamp and track bounds.
+ *
+ * The enumerator is also the field id (without flags) - virtual fields are
+ * registered first, in this order, when a track is created. To add a field
+ * append an enumerator before Count, its name to virtual_field_names and
+ * a case to Track::get_virtual_value and Track::get_virtual_valid_until (the
+ * switches have no default so a missing case is a compiler warning). Bump snapshot::version as cached field ids
+ * change. */
+enum class VirtualField : uint8_t {
+    Timestamp,
+    VideoTime,
+    TimeElapsed,
+    TimeRemaining,
+    Active,
+    Countdown,
+    Overtime,
+    Count,
+};
+
+inline constexpr std::array<std::string_view, static_cast<size_t>(VirtualField::Count)> virtual_field_names = {
+    "timestamp",
+    "video_time",
+    "time_elapsed",
+    "time_remaining",
+    "active",
+    "countdown",
+    "overtime",
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // VIRTUAL_FIELD_H
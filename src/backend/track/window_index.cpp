@@ -0,0 +1,121 @@
+#include "window_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace telemetry {
+namespace track {
+
+WindowIndex::WindowIndex(const TrackpointStore& store, size_t column) : store_(store), column_(column) {
+    prefix_sums_.push_back(0.0);
+    prefix_counts_.push_back(0);
+    min_levels_.emplace_back();
+    max_levels_.emplace_back();
+    extend();
+}
+
+void WindowIndex::extend() {
+    size_t first = prefix_counts_.size() - 1;
+    size_t count = store_.size();
+    constexpr double inf = std::numeric_limits<double>::infinity();
+
+    prefix_sums_.resize(count + 1, 0.0);
+    prefix_counts_.resize(count + 1, 0);
+    min_levels_[0].resize(count, inf);
+    max_levels_[0].resize(count, -inf);
+    for (size_t i = first; i < count; ++i) {
+        bool valid = store_.is_sample(column_, i);
+        double value = valid ? store_.value(column_, i) : 0.0;
+        prefix_sums_[i + 1] = prefix_sums_[i] + value;
+        prefix_counts_[i + 1] = prefix_counts_[i] + (valid ? 1 : 0);
+        if (valid) {
+            min_levels_[0][i] = value;
+            max_levels_[0][i] = value;
+        }
+    }
+
+    size_t level = 1;
+    for (size_t width = 2; width <= count; width *= 2, ++level) {
+        if (level == min_levels_.size()) {
+            min_levels_.emplace_back();
+            max_levels_.emplace_back();
+        }
+        const auto& prev_min = min_levels_[level - 1];
+        const auto& prev_max = max_levels_[level - 1];
+        auto& level_min = min_levels_[level];
+        auto& level_max = max_levels_[level];
+        if (level_min.empty()) {
+            level_min.reserve(count - width + 1);
+            level_max.reserve(count - width + 1);
+        }
+        for (size_t i = level_min.size(); i + width <= count; ++i) {
+            level_min.push_back(std::min(prev_min[i], prev_min[i + width / 2]));
+            level_max.push_back(std::max(prev_max[i], prev_max[i + width / 2]));
+        }
+    }
+}
+
+double WindowIndex::get(Aggregate aggregate, time::microseconds_t timestamp, time::microseconds_t window,
+                        cursors_t& cursors, time::microseconds_t& valid_until) const {
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+    auto timestamps = store_.timestamps();
+    valid_until = VALID_FOREVER;
+    if (window <= 0 || timestamps.empty()) {
+        return nan;
+    }
+
+    // samples (before_first, last] are in window
+    size_t last = store_.floor_index(timestamp, cursors.last);
+    size_t before_first = store_.floor_index(timestamp - window, cursors.first);
+    size_t end = (last == TrackpointStore::npos) ? 0 : last + 1;
+    size_t begin = (before_first == TrackpointStore::npos) ? 0 : before_first + 1;
+
+    if (end < timestamps.size()) {
+        valid_until = timestamps[end]; // next sample enters
+    } else if (store_.is_growing()) {
+        valid_until = timestamp + 1; // next sample may be appended any time
+    }
+    if (begin < end) {
+        valid_until = std::min(valid_until, timestamps[begin] + window); // first sample leaves
+    }
+
+    if (prefix_counts_[end] - prefix_counts_[begin] == 0) {
+        return nan;
+    }
+
+    switch (aggregate) {
+        case Aggregate::Sum:
+            return prefix_sums_[end] - prefix_sums_[begin];
+        case Aggregate::Avg:
+            return (prefix_sums_[end] - prefix_sums_[begin]) / (prefix_counts_[end] - prefix_counts_[begin]);
+        case Aggregate::Min:
+            return range_min(begin, end - 1);
+        case Aggregate::Max:
+            return range_max(begin, end - 1);
+    }
+    return nan;
+}
+
+size_t WindowIndex::memory_usage() const {
+    size_t bytes = prefix_sums_.size() * sizeof(double) + prefix_counts_.size() * sizeof(uint32_t);
+    for (size_t k = 0; k < min_levels_.size(); ++k) {
+        bytes += (min_levels_[k].size() + max_levels_[k].size()) * sizeof(double);
+    }
+    return bytes;
+}
+
+/* two overlapping power of two runs cover [first, last] */
+double WindowIndex::range_min(size_t first, size_t last) const {
+    size_t level = std::bit_width(last - first + 1) - 1;
+    return std::min(min_levels_[level][first], min_levels_[level][last + 1 - (size_t{1} << level)]);
+}
+
+double WindowIndex::range_max(size_t first, size_t last) const {
+    size_t level = std::bit_width(last - first + 1) - 1;
+    return std::max(max_levels_[level][first], max_levels_[level][last + 1 - (size_t{1} << level)]);
+}
+
+} // namespace track
+} // namespace telemetry
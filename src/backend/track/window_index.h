@@ -0,0 +1,71 @@
+#ifndef WINDOW_INDEX_H
+#define WINDOW_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "backend/utils/time.h"
+#include "field_handle.h"
+#include "track_cursor.h"
+#include "trackpoint_store.h"
+
+namespace telemetry {
+namespace track {
+
+/* Sliding window aggregates over samples of one trackpoint column.
+ *
+ * Built once per column: prefix sums and counts of valid samples answer
+ * sum/avg, sparse tables (min/max of every power of two long run) answer
+ * min/max - all in O(1) once window ends are located. Ends are located with
+ * cursors, so sequential (frame by frame) queries also locate them in
+ * amortized O(1). A window only counts the column's own samples, not rows
+ * where it is missing or joined. Rows appended to the store later (live
+ * track) extend the arrays, the sparse tables only get runs ending in new
+ * rows. */
+class WindowIndex {
+public:
+    enum class Aggregate : uint8_t {
+        Avg,
+        Min,
+        Max,
+        Sum,
+    };
+
+    /* ends of window, both cursors move forward for sequential timestamps */
+    struct cursors_t {
+        TrackCursor first;
+        TrackCursor last;
+    };
+
+    WindowIndex(const TrackpointStore& store, size_t column);
+    ~WindowIndex() = default;
+
+    /* aggregate of valid samples with timestamp in (timestamp - window, timestamp], NaN if there are none
+     * valid_until - when a sample next enters or leaves the window */
+    double get(Aggregate aggregate, time::microseconds_t timestamp, time::microseconds_t window,
+               cursors_t& cursors, time::microseconds_t& valid_until) const;
+
+    /* adds trackpoints appended to the store since construction or previous call */
+    void extend();
+
+    size_t memory_usage() const;
+
+private:
+    double range_min(size_t first, size_t last) const;
+    double range_max(size_t first, size_t last) const;
+
+    const TrackpointStore& store_;
+    size_t column_;
+
+    std::vector<double> prefix_sums_;     // sum of valid samples before index
+    std::vector<uint32_t> prefix_counts_; // number of valid samples before index
+    // level k holds min/max of samples [i, i + 2^k), missing samples as +inf/-inf
+    std::vector<std::vector<double>> min_levels_;
+    std::vector<std::vector<double>> max_levels_;
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // WINDOW_INDEX_H
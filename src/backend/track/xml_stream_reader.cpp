@@ -0,0 +1,256 @@
+#include "xml_stream_reader.h"
+
+#include <vector>
+
+namespace telemetry {
+namespace track {
+namespace consts {
+    // longest markup prefix that has to be checked at once ("<![CDATA[")
+    constexpr size_t max_prefix_length = 9;
+}
+
+namespace {
+    bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+}
+
+XmlStreamReader::XmlStreamReader(size_t chunk_size) : chunk_size_(chunk_size) {
+}
+
+bool XmlStreamReader::read(const std::string& path, Handler& handler) {
+    FileTail input(path);
+    if (!input.open()) {
+        return false;
+    }
+    return read(input, handler);
+}
+
+bool XmlStreamReader::read(FileTail& input, Handler& handler) {
+    const std::string& path = input.path();
+    buffer_.clear();
+    pos_ = 0;
+    eof_ = false;
+
+    std::vector<std::string> stack;
+    size_t roots = 0;
+
+    bool capturing = false;
+    size_t capture_start = 0;
+    size_t capture_level = 0;  // depth of captured element
+    size_t capture_nesting = 0; // open elements within capture
+    std::string capture_name;
+
+    // false if end of input was already reached, so nothing can be added
+    auto fill = [&]() -> bool {
+        if (eof_) {
+            return false;
+        }
+        // drop consumed data, but keep fragment being captured
+        size_t keep = capturing ? capture_start : pos_;
+        buffer_.erase(0, keep);
+        pos_ -= keep;
+        capture_start -= capturing ? keep : 0;
+
+        size_t old_size = buffer_.size();
+        buffer_.resize(old_size + chunk_size_);
+        size_t read = input.read(buffer_.data() + old_size, chunk_size_);
+        buffer_.resize(old_size + read);
+
+        eof_ = (read == 0);
+        return true;
+    };
+
+    while (true) {
+        if (pos_ >= buffer_.size()) {
+            if (!fill()) {
+                break;
+            }
+            continue;
+        }
+
+        size_t end = 0;
+        std::string_view name;
+        Token token = next_token(end, name);
+
+        if (token == Token::Incomplete) {
+            if (!fill()) {
+                log.error("Unexpected end of file: {}", path);
+                return false;
+            }
+            continue;
+        }
+        if (token == Token::Error) {
+            if (eof_ && input.stopped()) {
+                return false;
+            }
+            log.error("Malformed XML markup at byte {} in file: {}", pos_, path);
+            return false;
+        }
+
+        if (capturing) {
+            if (token == Token::StartTag) {
+                ++capture_nesting;
+            } else if (token == Token::EndTag) {
+                if (capture_nesting == 0) {
+                    std::string_view fragment(buffer_.data() + capture_start, end - capture_start);
+                    handler.on_fragment(capture_name, fragment, capture_level);
+                    capturing = false;
+                } else {
+                    --capture_nesting;
+                }
+            }
+            pos_ = end;
+            continue;
+        }
+
+        switch (token) {
+            case Token::StartTag:
+            case Token::EmptyTag:
+                {
+                    size_t depth = stack.size();
+                    if (depth == 0 && ++roots > 1) {
+                        log.error("More than one root node in file: {}", path);
+                        return false;
+                    }
+
+                    if (handler.on_start(name, depth)) {
+                        if (token == Token::EmptyTag) {
+                            std::string_view fragment(buffer_.data() + pos_, end - pos_);
+                            handler.on_fragment(name, fragment, depth);
+                        } else {
+                            capturing = true;
+                            capture_start = pos_;
+                            capture_level = depth;
+                            capture_nesting = 0;
+                            capture_name = name;
+                        }
+                    } else if (token == Token::EmptyTag) {
+                        handler.on_end(name, depth);
+                    } else {
+                        stack.emplace_back(name);
+                    }
+                }
+                break;
+            case Token::EndTag:
+                if (stack.empty() || stack.back() != name) {
+                    log.error("Mismatched end tag </{}> in file: {}", name, path);
+                    return false;
+                }
+                handler.on_end(name, stack.size() - 1);
+                stack.pop_back();
+                break;
+            default:
+                break;
+        }
+        pos_ = end;
+    }
+
+    if (input.stopped()) {
+        return false;
+    }
+    if (capturing || !stack.empty()) {
+        log.error("Unexpected end of file: {}", path);
+        return false;
+    }
+    if (roots == 0) {
+        log.error("No root node found in file: {}", path);
+        return false;
+    }
+
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    return true;
+}
+
+XmlStreamReader::Token XmlStreamReader::next_token(size_t& end, std::string_view& name) const {
+    std::string_view buf(buffer_);
+    size_t pos = pos_;
+
+    if (buf[pos] != '<') {
+        // character data - content is not needed, may end at buffer boundary
+        size_t lt = buf.find('<', pos);
+        end = (lt == std::string_view::npos) ? buf.size() : lt;
+        return Token::Text;
+    }
+
+    if (buf.size() - pos < consts::max_prefix_length && !eof_) {
+        return Token::Incomplete;
+    }
+
+    auto skip_until = [&](std::string_view terminator) {
+        size_t found = buf.find(terminator, pos);
+        if (found == std::string_view::npos) {
+            return eof_ ? Token::Error : Token::Incomplete;
+        }
+        end = found + terminator.size();
+        return Token::Skip;
+    };
+
+    std::string_view rest = buf.substr(pos);
+    if (rest.starts_with("<?")) {
+        return skip_until("?>");
+    }
+    if (rest.starts_with("<!--")) {
+        return skip_until("-->");
+    }
+    if (rest.starts_with("<![CDATA[")) {
+        return skip_until("]]>");
+    }
+    if (rest.starts_with("<!")) {
+        // DOCTYPE - may contain internal subset in brackets and quoted literals
+        int brackets = 0;
+        char quote = 0;
+        for (size_t i = pos + 2; i < buf.size(); ++i) {
+            char c = buf[i];
+            if (quote) {
+                quote = (c == quote) ? 0 : quote;
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            } else if (c == '[') {
+                ++brackets;
+            } else if (c == ']') {
+                --brackets;
+            } else if (c == '>' && brackets <= 0) {
+                end = i + 1;
+                return Token::Skip;
+            }
+        }
+        return eof_ ? Token::Error : Token::Incomplete;
+    }
+
+    bool closing = rest.starts_with("</");
+    size_t name_start = pos + (closing ? 2 : 1);
+    size_t name_end = name_start;
+    while (name_end < buf.size() && !is_space(buf[name_end]) && buf[name_end] != '>' && buf[name_end] != '/') {
+        ++name_end;
+    }
+    if (name_end >= buf.size()) {
+        return eof_ ? Token::Error : Token::Incomplete;
+    }
+    if (name_end == name_start) {
+        return Token::Error;
+    }
+
+    // find tag end, '>' may appear inside quoted attribute values
+    char quote = 0;
+    for (size_t i = name_end; i < buf.size(); ++i) {
+        char c = buf[i];
+        if (quote) {
+            quote = (c == quote) ? 0 : quote;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '>') {
+            end = i + 1;
+            name = buf.substr(name_start, name_end - name_start);
+            if (closing) {
+                return Token::EndTag;
+            }
+            return (buf[i - 1] == '/') ? Token::EmptyTag : Token::StartTag;
+        }
+    }
+    return eof_ ? Token::Error : Token::Incomplete;
+}
+
+} // namespace track
+} // namespace telemetry
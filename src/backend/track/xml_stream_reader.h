@@ -0,0 +1,71 @@
+#ifndef XML_STREAM_READER_H
+#define XML_STREAM_READER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "backend/utils/logging/logger.h"
+#include "file_tail.h"
+
+namespace telemetry {
+namespace track {
+
+/* Minimal streaming XML reader.
+ *
+ * Reads file in fixed size chunks and reports element starts/ends to a
+ * handler without building a document. Handler can request any element to
+ * be captured - it then receives the raw text of the whole element (start
+ * tag to matching end tag) as one fragment, which is small enough to be
+ * parsed with pugixml on its own (e.g. single trkpt). Memory use is bounded
+ * by chunk size plus largest captured fragment.
+ *
+ * Prolog, comments, processing instructions and DOCTYPE are skipped, only
+ * ASCII compatible encodings (UTF-8) are supported.
+ *
+ * Input may also be a followed file (see FileTail) that is still being
+ * written - elements are then reported as they are completed. */
+class XmlStreamReader {
+public:
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+
+        /* return true to capture whole element as fragment instead of nested events */
+        virtual bool on_start(std::string_view name, size_t depth) = 0;
+        virtual void on_fragment(std::string_view name, std::string_view fragment, size_t depth) = 0;
+        virtual void on_end(std::string_view name, size_t depth) = 0;
+    };
+
+    XmlStreamReader(size_t chunk_size = 1 << 20);
+    ~XmlStreamReader() = default;
+
+    bool read(const std::string& path, Handler& handler);
+    /* input has to be open, false without error if its stop was requested */
+    bool read(FileTail& input, Handler& handler);
+
+private:
+    enum class Token {
+        Incomplete,
+        Error,
+        Text,
+        Skip,       // comment, PI, doctype, cdata
+        StartTag,
+        EmptyTag,
+        EndTag,
+    };
+
+    Token next_token(size_t& end, std::string_view& name) const;
+
+    mutable utils::logging::Logger log{"xml_stream_reader"};
+
+    size_t chunk_size_;
+    std::string buffer_;
+    size_t pos_ = 0;
+    bool eof_ = false;
+};
+
+} // namespace track
+} // namespace telemetry
+
+#endif // XML_STREAM_READER_H
@@ -1,8 +1,96 @@
 #include "time.h"
 
+#include <sstream>
+
 namespace telemetry {
 namespace time {
 
+namespace {
+    bool parse_digits(std::string_view str, size_t pos, size_t count, int& value) {
+        value = 0;
+        for (size_t i = pos; i < pos + count; ++i) {
+            unsigned digit = static_cast<unsigned>(str[i] - '0');
+            if (digit > 9) {
+                return false;
+            }
+            value = value * 10 + static_cast<int>(digit);
+        }
+        return true;
+    }
+
+    /* "YYYY-MM-DDTHH:MM:SS" followed by optional fraction and optional 'Z' or "+hh:mm" / "-hh:mm" offset */
+    bool parse_iso8601_fixed(std::string_view timestamp, time_point_t& tp) {
+        constexpr size_t length = 19;
+        if (timestamp.size() < length ||
+            timestamp[4] != '-' || timestamp[7] != '-' || timestamp[10] != 'T' ||
+            timestamp[13] != ':' || timestamp[16] != ':') {
+            return false;
+        }
+
+        int year, month, day, hour, minute, second;
+        if (!parse_digits(timestamp, 0, 4, year) || !parse_digits(timestamp, 5, 2, month) ||
+            !parse_digits(timestamp, 8, 2, day) || !parse_digits(timestamp, 11, 2, hour) ||
+            !parse_digits(timestamp, 14, 2, minute) || !parse_digits(timestamp, 17, 2, second)) {
+            return false;
+        }
+        if (hour > 23 || minute > 59 || second > 59) {
+            return false;
+        }
+
+        std::chrono::year_month_day date{std::chrono::year(year),
+                                         std::chrono::month(static_cast<unsigned>(month)),
+                                         std::chrono::day(static_cast<unsigned>(day))};
+        if (!date.ok()) {
+            return false;
+        }
+
+        // fraction beyond millisecond precision is truncated
+        size_t pos = length;
+        int ms = 0;
+        if (pos < timestamp.size() && timestamp[pos] == '.') {
+            ++pos;
+            size_t digits = 0;
+            while (pos < timestamp.size() && static_cast<unsigned>(timestamp[pos] - '0') <= 9) {
+                if (digits < 3) {
+                    ms = ms * 10 + (timestamp[pos] - '0');
+                }
+                ++digits;
+                ++pos;
+            }
+            if (digits == 0) {
+                return false;
+            }
+            for (; digits < 3; ++digits) {
+                ms *= 10;
+            }
+        }
+        // UTC unless offset is given
+        std::chrono::minutes offset{0};
+        if (pos < timestamp.size() && timestamp[pos] == 'Z') {
+            ++pos;
+        } else if (pos + 6 == timestamp.size() && (timestamp[pos] == '+' || timestamp[pos] == '-') &&
+                   timestamp[pos + 3] == ':') {
+            int offset_hours, offset_minutes;
+            if (!parse_digits(timestamp, pos + 1, 2, offset_hours) || !parse_digits(timestamp, pos + 4, 2, offset_minutes) ||
+                offset_hours > 23 || offset_minutes > 59) {
+                return false;
+            }
+            offset = std::chrono::hours(offset_hours) + std::chrono::minutes(offset_minutes);
+            if (timestamp[pos] == '-') {
+                offset = -offset;
+            }
+            pos += 6;
+        }
+        if (pos != timestamp.size()) {
+            return false; // trailing data
+        }
+
+        tp = std::chrono::sys_days(date) + std::chrono::hours(hour) + std::chrono::minutes(minute) +
+             std::chrono::seconds(second) + std::chrono::milliseconds(ms) - offset;
+        return true;
+    }
+}
+
 seconds_t us_to_s(microseconds_t us) {
     return static_cast<seconds_t>(us / 1'000'000.0);
 }
@@ -11,8 +99,13 @@ microseconds_t s_to_us(seconds_t s) {
     return static_cast<microseconds_t>(s * 1'000'000.0);
 }
 
-time_point_t parse_iso8601(const std::string& timestamp) {
-    std::istringstream ss(timestamp);
+time_point_t parse_iso8601(std::string_view timestamp) {
+    time_point_t fixed;
+    if (parse_iso8601_fixed(timestamp, fixed)) {
+        return fixed;
+    }
+
+    std::istringstream ss{std::string(timestamp)};
     std::chrono::sys_time<std::chrono::milliseconds> tp;
     
     // Parse format: "2025-12-09T15:17:04.000Z"
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <string>
+#include <string_view>
 #include <chrono>
 
 namespace telemetry {
@@ -19,7 +20,11 @@ static constexpr time_point_t INVALID_TIME_POINT = time_point_t::max();
 double us_to_s(microseconds_t us);
 microseconds_t s_to_us(seconds_t s);
 
-time_point_t parse_iso8601(const std::string& timestamp);
+/* Parses "YYYY-MM-DDTHH:MM:SS[.fff][Z|+hh:mm|-hh:mm]" to UTC with millisecond
+ * precision (longer fractions are truncated, no zone means UTC). Fixed format
+ * timestamps (as written by GPS devices) take a fast path, anything else goes
+ * through std::chrono::from_stream. */
+time_point_t parse_iso8601(std::string_view timestamp);
 
 } // namespace time
 } // namespace telemetry
@@ -106,7 +106,8 @@ gst_telemetry_class_init (GstTelemetryClass * klass)
 
   g_object_class_install_property (gobject_class, PROP_TRACK,
       g_param_spec_string ("track", "Track",
-        "Path to GPS track file (GPX format)",
+        "Path to GPS track file (GPX or FIT format), several files recorded at the same time as "
+        "'PATH[,offset=SECONDS][,prefix=PREFIX][,rider[=NAME]][,live];...' merged into timeline of the first one",
         NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (gobject_class, PROP_CUSTOM_DATA,
@@ -427,6 +428,17 @@ gst_telemetry_set_info (GstVideoFilter * filter, GstCaps * incaps,
     GST_INFO_OBJECT (telemetry, "GL pipeline not detected, operating in CPU mode");
   }
 
+  // Fixed frame rate lets the backend bake interpolated fields onto the frame grid
+  GST_INFO_OBJECT (telemetry, "Frame rate: %d/%d",
+      GST_VIDEO_INFO_FPS_N (in_info), GST_VIDEO_INFO_FPS_D (in_info));
+  GST_OBJECT_LOCK (telemetry);
+  int ret = manager_set_frame_rate (telemetry->manager,
+      GST_VIDEO_INFO_FPS_N (in_info), GST_VIDEO_INFO_FPS_D (in_info));
+  GST_OBJECT_UNLOCK (telemetry);
+  if (ret != 0) {
+    GST_WARNING_OBJECT (telemetry, "Failed to set frame rate, interpolated fields will not be baked");
+  }
+
   return TRUE;
 }
 
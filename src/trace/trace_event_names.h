@@ -15,7 +15,10 @@ TRACE_EVENT_NAME(EV_MANAGER_CLEAR_SURFACE, "manager::draw clear surface")
 TRACE_EVENT_NAME(EV_MANAGER_DRAW_CACHE, "manager::draw draw cache")
 
 TRACE_EVENT_NAME(EV_TRACK_LOAD, "track::load")
+TRACE_EVENT_NAME(EV_TRACK_LOAD_SNAPSHOT, "track::load map snapshot")
+TRACE_EVENT_NAME(EV_TRACK_SAVE_SNAPSHOT, "track::load save snapshot")
 TRACE_EVENT_NAME(EV_TRACK_LOAD_CUSTOM_DATA, "track::load_custom_data")
+TRACE_EVENT_NAME(EV_TRACK_MERGE_SOURCES, "track::load merge sources")
 
 TRACE_EVENT_NAME(EV_LAYOUT_LOAD, "layout::load")
 TRACE_EVENT_NAME(EV_LAYOUT_DRAW, "layout::draw")
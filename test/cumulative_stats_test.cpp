@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "backend/track/cumulative_stats.h"
+
+// Checks cumulative statistics at every trackpoint against a brute force
+// recomputation from the first trackpoint, on a column with time gaps,
+// missing samples and joined rows (which must not count as samples).
+// usage: cumulative_stats_test
+
+using namespace telemetry;
+using namespace telemetry::track;
+
+namespace {
+    constexpr size_t row_count = 400;
+    constexpr time::microseconds_t step = 1'000'000;
+    constexpr time::microseconds_t gap = 45'000'000; // longer than Np window, after every gap_every rows
+    constexpr size_t gap_every = 97;
+    constexpr size_t leading_missing = 4;            // statistics are NaN until the first sample
+    constexpr size_t missing_every = 7;
+    constexpr size_t joined_every = 5;
+    constexpr double tolerance = 1e-9;
+
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+    void build_store(TrackpointStore& store) {
+        std::vector<time::microseconds_t> timestamps;
+        std::vector<double> values;
+        std::vector<uint64_t> joined((row_count + 63) / 64, 0);
+        time::microseconds_t timestamp = 0;
+        for (size_t i = 0; i < row_count; ++i) {
+            timestamps.push_back(timestamp);
+            timestamp += (i % gap_every == gap_every - 1) ? gap : step;
+            bool missing = i < leading_missing || i % missing_every == 3;
+            values.push_back(missing ? nan : 200.0 + 80.0 * std::sin(0.21 * static_cast<double>(i)));
+            // joined rows are valid, with values far off so counting them shows
+            if (!missing && i % joined_every == 1) {
+                values.back() = 1000.0;
+                joined[i / 64] |= uint64_t{1} << (i % 64);
+            }
+        }
+        store.add_column(TrackpointStore::ColumnType::Double);
+        store.build(std::move(timestamps), {std::move(values)}, {std::move(joined)});
+    }
+
+    /* statistics of samples in rows [0, row] */
+    std::vector<double> brute_force(const TrackpointStore& store, size_t row) {
+        auto timestamps = store.timestamps();
+        std::vector<size_t> samples;
+        for (size_t i = 0; i <= row; ++i) {
+            if (store.is_sample(0, i)) {
+                samples.push_back(i);
+            }
+        }
+        std::vector<double> stats(static_cast<size_t>(CumulativeStat::Count), nan);
+        if (samples.empty()) {
+            return stats;
+        }
+
+        double max = -std::numeric_limits<double>::infinity();
+        double min = std::numeric_limits<double>::infinity();
+        double sum = 0.0;
+        double gain = 0.0;
+        for (size_t k = 0; k < samples.size(); ++k) {
+            double value = store.value(0, samples[k]);
+            max = std::max(max, value);
+            min = std::min(min, value);
+            sum += value;
+            if (k > 0) {
+                gain += std::max(value - store.value(0, samples[k - 1]), 0.0);
+            }
+        }
+        stats[static_cast<size_t>(CumulativeStat::Max)] = max;
+        stats[static_cast<size_t>(CumulativeStat::Min)] = min;
+        stats[static_cast<size_t>(CumulativeStat::Avg)] = sum / static_cast<double>(samples.size());
+        stats[static_cast<size_t>(CumulativeStat::Gain)] = gain;
+
+        // 30s rolling averages of samples, once a full window elapsed since the first sample
+        double rolling_sum = 0.0;
+        size_t rolling_count = 0;
+        time::microseconds_t first_time = timestamps[samples.front()];
+        for (size_t k = 0; k < samples.size(); ++k) {
+            time::microseconds_t end = timestamps[samples[k]];
+            if (end - CumulativeStats::np_window < first_time) {
+                continue;
+            }
+            double window_sum = 0.0;
+            size_t window_count = 0;
+            for (size_t j = 0; j <= k; ++j) {
+                if (timestamps[samples[j]] > end - CumulativeStats::np_window) {
+                    window_sum += store.value(0, samples[j]);
+                    ++window_count;
+                }
+            }
+            rolling_sum += std::pow(window_sum / static_cast<double>(window_count), 4);
+            ++rolling_count;
+        }
+        if (rolling_count > 0) {
+            stats[static_cast<size_t>(CumulativeStat::Np)] = std::pow(rolling_sum / static_cast<double>(rolling_count), 0.25);
+        }
+        return stats;
+    }
+
+    bool same(double a, double b) {
+        if (std::isnan(a) || std::isnan(b)) {
+            return std::isnan(a) && std::isnan(b);
+        }
+        return std::abs(a - b) <= tolerance * std::max(1.0, std::abs(b));
+    }
+}
+
+int main() {
+    TrackpointStore store;
+    build_store(store);
+    CumulativeStats stats(store, 0);
+
+    int checked = 0;
+    int errors = 0;
+    for (size_t row = 0; row < store.size(); ++row) {
+        std::vector<double> expected = brute_force(store, row);
+        for (size_t s = 0; s < static_cast<size_t>(CumulativeStat::Count); ++s) {
+            ++checked;
+            double value = (*stats.series(static_cast<CumulativeStat>(s)))[row];
+            if (!same(value, expected[s])) {
+                std::cout << std::format("Error - {} at row {}: {}, expected {}", cumulative_stat_names[s], row, value,
+                                         expected[s])
+                          << std::endl;
+                ++errors;
+            }
+        }
+    }
+
+    std::cout << "checked: " << checked << " errors: " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}
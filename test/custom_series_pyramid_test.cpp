@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include "backend/track/track.h"
+
+// Checks that min/max pyramids of custom CSV series cover the series' own
+// rows - also when the series has more or fewer rows than the track has
+// trackpoints - and that their indexes map to the series' timestamps.
+// usage: custom_series_pyramid_test TRACK.gpx LONG.csv SHORT.csv
+// (LONG.csv / SHORT.csv as in test/data: series_long.csv, series_short.csv)
+
+using namespace telemetry;
+
+namespace {
+    constexpr size_t envelope_buckets = 50;
+
+    struct expected_t {
+        std::string field;
+        size_t rows;
+        time::microseconds_t row_interval;
+        double min_value;
+        time::microseconds_t min_timestamp;
+        double max_value;
+        time::microseconds_t max_timestamp;
+    };
+
+    bool check(const track::Track& track, const expected_t& expected) {
+        int errors = 0;
+        auto error = [&](const std::string& what) {
+            std::cout << "Error - " << expected.field << ": " << what << std::endl;
+            ++errors;
+        };
+
+        auto field = track.bind(expected.field);
+        const track::MinMaxPyramid* pyramid = track.get_min_max_pyramid(field);
+        if (!pyramid) {
+            error("no min/max pyramid");
+            return false;
+        }
+        if (pyramid->size() != expected.rows) {
+            error("pyramid size " + std::to_string(pyramid->size()) + ", rows " + std::to_string(expected.rows));
+            return false;
+        }
+        for (size_t i = 0; i < pyramid->size(); ++i) {
+            if (pyramid->timestamp(i) != static_cast<time::microseconds_t>(i) * expected.row_interval) {
+                error("timestamp of row " + std::to_string(i) + ": " + std::to_string(pyramid->timestamp(i)));
+                break;
+            }
+        }
+
+        auto extremes = pyramid->get(size_t{0}, pyramid->size() - 1);
+        if (extremes.min_index == track::MinMaxPyramid::npos ||
+            pyramid->value(extremes.min_index) != expected.min_value ||
+            pyramid->timestamp(extremes.min_index) != expected.min_timestamp) {
+            error("wrong minimum");
+        }
+        if (extremes.max_index == track::MinMaxPyramid::npos ||
+            pyramid->value(extremes.max_index) != expected.max_value ||
+            pyramid->timestamp(extremes.max_index) != expected.max_timestamp) {
+            error("wrong maximum");
+        }
+
+        // envelope samples are rows of the series, extremes included
+        auto envelope = pyramid->envelope(0, pyramid->size() - 1, envelope_buckets);
+        if (std::any_of(envelope.begin(), envelope.end(), [&](size_t idx) { return idx >= pyramid->size(); })) {
+            error("envelope index out of range");
+        }
+        if (std::find(envelope.begin(), envelope.end(), extremes.min_index) == envelope.end() ||
+            std::find(envelope.begin(), envelope.end(), extremes.max_index) == envelope.end()) {
+            error("envelope misses extremes");
+        }
+
+        // values at the mapped timestamps are the series values
+        for (size_t idx : envelope) {
+            track::Value value = track.get(expected.field, pyramid->timestamp(idx));
+            if (!value.is_double() || value.as_double() != pyramid->value(idx)) {
+                error("value at envelope timestamp " + std::to_string(pyramid->timestamp(idx)));
+                break;
+            }
+        }
+
+        std::cout << expected.field << ": " << pyramid->size() << " rows, " << envelope.size()
+                  << " envelope samples, errors: " << errors << std::endl;
+        return errors == 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        std::cout << "usage: " << argv[0] << " TRACK.gpx LONG.csv SHORT.csv" << std::endl;
+        return 2;
+    }
+
+    // test/data/track.gpx has broken trackpoints on purpose - load reports them, the rest is loaded;
+    // parsed directly, bypassing snapshot cache
+    track::Track track;
+    track.load_gpx(argv[1], track::Track::Parser::Stream);
+    size_t trackpoints = track.get_trackpoint_timestamps().size();
+    if (trackpoints == 0 || !track.load_custom_data(argv[2]) || !track.load_custom_data(argv[3])) {
+        std::cout << "Error - failed to load test data" << std::endl;
+        return 1;
+    }
+
+    // series_long.csv: 600 rows at 1 s, extremes after the end of the track
+    // series_short.csv: 30 rows at 2 s, ends before the track
+    expected_t long_series{"custom_long_temp", 600, 1'000'000, -5, 500'000'000, 99.5, 400'000'000};
+    expected_t short_series{"custom_short_temp", 30, 2'000'000, 1, 6'000'000, 42, 14'000'000};
+    if (long_series.rows <= trackpoints || short_series.rows >= trackpoints) {
+        std::cout << "Error - test series have to be longer / shorter than track (" << trackpoints << " trackpoints)"
+                  << std::endl;
+        return 1;
+    }
+
+    bool ok = check(track, long_series);
+    ok = check(track, short_series) && ok;
+    return ok ? 0 : 1;
+}
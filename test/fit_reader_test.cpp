@@ -0,0 +1,273 @@
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "backend/track/fit_reader.h"
+
+// Checks FitReader on a generated file: timestamps of compressed timestamp
+// headers rolling over the 5 bit offset (also after a timestamp of a message
+// the handler does not accept), and messages with developer fields - with
+// and without a timestamp field - decoded without any developer data leaking
+// into fields. The file is read with several chunk sizes.
+// usage: fit_reader_test
+
+using namespace telemetry::track;
+
+namespace {
+    constexpr uint16_t record_message = 20;
+    constexpr uint16_t event_message = 21; // not accepted by the handler
+    constexpr uint8_t heartrate_field = 3;
+    constexpr uint8_t speed_field = 6;
+    constexpr uint8_t uint8_type = 0x02;
+    constexpr uint8_t uint16_type = 0x84;
+    constexpr uint8_t uint32_type = 0x86;
+    constexpr uint32_t first_timestamp = 1'000'000'029; // low 5 bits 29 - next offset rolls over
+    constexpr size_t chunk_sizes[] = {1 << 20, 7, 1};
+
+    struct record_t {
+        uint32_t timestamp;
+        uint8_t heartrate;
+        uint16_t speed;
+
+        bool operator==(const record_t&) const = default;
+    };
+
+    uint16_t crc(const std::vector<uint8_t>& bytes) {
+        constexpr uint16_t table[16] = {
+            0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+            0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400,
+        };
+        uint16_t crc = 0;
+        for (uint8_t byte : bytes) {
+            crc = ((crc >> 4) & 0x0FFF) ^ table[crc & 0xF] ^ table[byte & 0xF];
+            crc = ((crc >> 4) & 0x0FFF) ^ table[crc & 0xF] ^ table[(byte >> 4) & 0xF];
+        }
+        return crc;
+    }
+
+    class Writer {
+    public:
+        void u8(uint8_t value) {
+            records_.push_back(value);
+        }
+        void u16(uint16_t value) {
+            u8(static_cast<uint8_t>(value));
+            u8(static_cast<uint8_t>(value >> 8));
+        }
+        void u32(uint32_t value) {
+            u16(static_cast<uint16_t>(value));
+            u16(static_cast<uint16_t>(value >> 16));
+        }
+
+        /* fields - number, size, base type; developer fields - number, size, developer data index */
+        void definition(uint8_t local, uint16_t message, const std::vector<std::array<uint8_t, 3>>& fields,
+                        const std::vector<std::array<uint8_t, 3>>& developer_fields = {}) {
+            u8(static_cast<uint8_t>(0x40 | (developer_fields.empty() ? 0 : 0x20) | local));
+            u8(0); // reserved
+            u8(0); // little endian
+            u16(message);
+            u8(static_cast<uint8_t>(fields.size()));
+            for (const auto& field : fields) {
+                u8(field[0]);
+                u8(field[1]);
+                u8(field[2]);
+            }
+            if (!developer_fields.empty()) {
+                u8(static_cast<uint8_t>(developer_fields.size()));
+                for (const auto& field : developer_fields) {
+                    u8(field[0]);
+                    u8(field[1]);
+                    u8(field[2]);
+                }
+            }
+        }
+
+        void normal_header(uint8_t local) {
+            u8(local);
+        }
+        void compressed_header(uint8_t local, uint32_t timestamp) {
+            u8(static_cast<uint8_t>(0x80 | (local << 5) | (timestamp & 0x1F)));
+        }
+
+        std::vector<uint8_t> file() const {
+            std::vector<uint8_t> bytes = {14, 0x20, 0x54, 0x08}; // header size, protocol, profile
+            uint32_t size = static_cast<uint32_t>(records_.size());
+            for (int i = 0; i < 4; ++i) {
+                bytes.push_back(static_cast<uint8_t>(size >> (8 * i)));
+            }
+            bytes.insert(bytes.end(), {'.', 'F', 'I', 'T'});
+            uint16_t header_crc = crc(bytes);
+            bytes.push_back(static_cast<uint8_t>(header_crc));
+            bytes.push_back(static_cast<uint8_t>(header_crc >> 8));
+            bytes.insert(bytes.end(), records_.begin(), records_.end());
+            uint16_t file_crc = crc(bytes);
+            bytes.push_back(static_cast<uint8_t>(file_crc));
+            bytes.push_back(static_cast<uint8_t>(file_crc >> 8));
+            return bytes;
+        }
+
+    private:
+        std::vector<uint8_t> records_;
+    };
+
+    /* file with records in it, expected ones are returned */
+    std::vector<uint8_t> generate(std::vector<record_t>& expected) {
+        enum Local : uint8_t {
+            WithTimestamp,
+            Compressed,
+            DeveloperWithTimestamp,
+            DeveloperCompressed,
+            Event,
+        };
+
+        Writer w;
+        w.definition(WithTimestamp, record_message, {{253, 4, uint32_type}, {heartrate_field, 1, uint8_type}, {speed_field, 2, uint16_type}});
+        w.definition(Compressed, record_message, {{heartrate_field, 1, uint8_type}, {speed_field, 2, uint16_type}});
+        w.definition(DeveloperWithTimestamp, record_message, {{253, 4, uint32_type}, {heartrate_field, 1, uint8_type}, {speed_field, 2, uint16_type}},
+                     {{0, 4, 0}, {1, 2, 0}});
+        w.definition(DeveloperCompressed, record_message, {{heartrate_field, 1, uint8_type}, {speed_field, 2, uint16_type}},
+                     {{2, 3, 0}});
+        w.definition(Event, event_message, {{253, 4, uint32_type}, {0, 1, uint8_type}});
+
+        auto developer_data = [&w](size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                w.u8(0xA5); // would decode as heartrate 165 if read as a field
+            }
+        };
+
+        uint32_t timestamp = first_timestamp;
+        uint8_t heartrate = 90;
+        uint16_t speed = 4000;
+        auto next = [&](uint32_t delta) {
+            timestamp += delta;
+            ++heartrate;
+            speed += 10;
+            expected.push_back({timestamp, heartrate, speed});
+        };
+
+        // full timestamp, then compressed ones rolling over the 5 bit offset
+        next(0);
+        w.normal_header(WithTimestamp);
+        w.u32(timestamp);
+        w.u8(heartrate);
+        w.u16(speed);
+        for (uint32_t delta : {3u, 7u, 20u, 1u, 31u, 5u, 30u}) {
+            next(delta);
+            w.compressed_header(Compressed, timestamp);
+            w.u8(heartrate);
+            w.u16(speed);
+        }
+
+        // timestamp of a message not reported to the handler still moves compressed timestamps
+        timestamp += 100;
+        w.normal_header(Event);
+        w.u32(timestamp);
+        w.u8(0);
+        next(2);
+        w.compressed_header(Compressed, timestamp);
+        w.u8(heartrate);
+        w.u16(speed);
+
+        // developer fields after the ones of the profile, with and without timestamp field
+        next(11);
+        w.normal_header(DeveloperWithTimestamp);
+        w.u32(timestamp);
+        w.u8(heartrate);
+        w.u16(speed);
+        developer_data(6);
+        for (uint32_t delta : {25u, 9u}) {
+            next(delta);
+            w.compressed_header(DeveloperCompressed, timestamp);
+            w.u8(heartrate);
+            w.u16(speed);
+            developer_data(3);
+        }
+        next(4);
+        w.compressed_header(Compressed, timestamp);
+        w.u8(heartrate);
+        w.u16(speed);
+
+        return w.file();
+    }
+
+    class Collector : public FitReader::Handler {
+    public:
+        bool accept(uint16_t message) override {
+            return message == record_message;
+        }
+
+        void on_message(uint16_t message, std::span<const FitReader::field_t> fields) override {
+            std::map<uint8_t, double> values;
+            for (const auto& field : fields) {
+                values[field.number] = field.value;
+            }
+            if (message != record_message || values.size() != 3 || !values.contains(FitReader::timestamp_field) ||
+                !values.contains(heartrate_field) || !values.contains(speed_field)) {
+                ++unexpected;
+                return;
+            }
+            records.push_back({static_cast<uint32_t>(values[FitReader::timestamp_field]),
+                               static_cast<uint8_t>(values[heartrate_field]), static_cast<uint16_t>(values[speed_field])});
+        }
+
+        std::vector<record_t> records;
+        int unexpected = 0;
+    };
+}
+
+int main() {
+    std::vector<record_t> expected;
+    std::vector<uint8_t> bytes = generate(expected);
+
+    std::string path = (std::filesystem::temp_directory_path() / "fit_reader_test.fit").string();
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!out) {
+            std::cout << "Error - failed to write " << path << std::endl;
+            return 1;
+        }
+    }
+
+    int errors = 0;
+    for (size_t chunk_size : chunk_sizes) {
+        FitReader reader(chunk_size);
+        Collector collector;
+        if (!reader.read(path, collector)) {
+            std::cout << "Error - chunk size " << chunk_size << ": failed to read" << std::endl;
+            ++errors;
+            continue;
+        }
+        if (collector.unexpected > 0) {
+            std::cout << "Error - chunk size " << chunk_size << ": " << collector.unexpected << " messages with unexpected fields"
+                      << std::endl;
+            ++errors;
+        }
+        if (collector.records.size() != expected.size()) {
+            std::cout << "Error - chunk size " << chunk_size << ": " << collector.records.size() << " records, expected "
+                      << expected.size() << std::endl;
+            ++errors;
+            continue;
+        }
+        for (size_t i = 0; i < expected.size(); ++i) {
+            const auto& record = collector.records[i];
+            if (record != expected[i]) {
+                std::cout << std::format("Error - chunk size {} record {}: {} {} {}, expected {} {} {}", chunk_size, i,
+                                         record.timestamp, record.heartrate, record.speed, expected[i].timestamp,
+                                         expected[i].heartrate, expected[i].speed)
+                          << std::endl;
+                ++errors;
+            }
+        }
+    }
+    std::filesystem::remove(path);
+
+    std::cout << "records: " << expected.size() << " errors: " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "backend/track/cumulative_stats.h"
+#include "backend/track/min_max_pyramid.h"
+#include "backend/track/window_index.h"
+
+// Checks that column indexes extended after rows are appended to the store
+// (live track) answer exactly like indexes built over the whole store - for
+// appends of a single row, a few rows and runs crossing power of two sizes.
+// usage: index_extend_test
+
+using namespace telemetry;
+using namespace telemetry::track;
+
+namespace {
+    constexpr size_t initial_rows = 50;
+    constexpr size_t appends[] = {1, 1, 3, 9, 64, 1, 130, 2};
+    constexpr time::microseconds_t step = 1'000'000;
+    constexpr size_t missing_every = 6;
+    constexpr size_t envelope_buckets = 16;
+
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+    constexpr WindowIndex::Aggregate aggregates[] = {
+        WindowIndex::Aggregate::Avg,
+        WindowIndex::Aggregate::Min,
+        WindowIndex::Aggregate::Max,
+        WindowIndex::Aggregate::Sum,
+    };
+    constexpr time::microseconds_t windows[] = {2'000'000, 17'000'000, 120'000'000};
+
+    double sample(size_t row) {
+        return (row % missing_every == 2) ? nan : 50.0 * std::sin(0.13 * static_cast<double>(row)) + 0.1 * static_cast<double>(row);
+    }
+
+    bool same(double a, double b) {
+        return (std::isnan(a) && std::isnan(b)) || a == b;
+    }
+
+    int compare(const TrackpointStore& store, const WindowIndex& window_index, const CumulativeStats& stats,
+                const MinMaxPyramid& pyramid) {
+        WindowIndex fresh_window_index(store, 0);
+        CumulativeStats fresh_stats(store, 0);
+        MinMaxPyramid fresh_pyramid(store, 0);
+        size_t rows = store.size();
+        int errors = 0;
+        auto error = [&](const std::string& what) {
+            if (errors++ < 10) {
+                std::cout << "Error - " << rows << " rows: " << what << std::endl;
+            }
+        };
+
+        for (size_t s = 0; s < static_cast<size_t>(CumulativeStat::Count); ++s) {
+            const auto& extended = *stats.series(static_cast<CumulativeStat>(s));
+            const auto& built = *fresh_stats.series(static_cast<CumulativeStat>(s));
+            if (extended.size() != rows) {
+                error(std::format("{} series size {}", cumulative_stat_names[s], extended.size()));
+                continue;
+            }
+            for (size_t row = 0; row < rows; ++row) {
+                if (!same(extended[row], built[row])) {
+                    error(std::format("{} at row {}: {}, built {}", cumulative_stat_names[s], row, extended[row], built[row]));
+                }
+            }
+        }
+
+        auto timestamps = store.timestamps();
+        for (auto aggregate : aggregates) {
+            for (auto window : windows) {
+                WindowIndex::cursors_t cursors;
+                WindowIndex::cursors_t fresh_cursors;
+                for (time::microseconds_t t = timestamps.front(); t <= timestamps.back() + window; t += step / 2) {
+                    time::microseconds_t valid_until, fresh_valid_until;
+                    double value = window_index.get(aggregate, t, window, cursors, valid_until);
+                    double built = fresh_window_index.get(aggregate, t, window, fresh_cursors, fresh_valid_until);
+                    if (!same(value, built) || valid_until != fresh_valid_until) {
+                        error(std::format("aggregate {} window {} at {}: {}, built {}", static_cast<int>(aggregate), window,
+                                          t, value, built));
+                    }
+                }
+            }
+        }
+
+        // ranges ending in appended rows and spanning old and new ones
+        for (size_t first = 0; first < rows; first += 7) {
+            for (size_t last = first; last < rows; last += 5) {
+                auto extended = pyramid.get(first, last);
+                auto built = fresh_pyramid.get(first, last);
+                if (extended.min_index != built.min_index || extended.max_index != built.max_index) {
+                    error(std::format("extremes of [{}, {}]", first, last));
+                }
+            }
+        }
+        if (pyramid.envelope(0, rows - 1, envelope_buckets) != fresh_pyramid.envelope(0, rows - 1, envelope_buckets)) {
+            error("envelope");
+        }
+        return errors;
+    }
+}
+
+int main() {
+    TrackpointStore store;
+    std::vector<time::microseconds_t> timestamps;
+    std::vector<double> values;
+    for (size_t row = 0; row < initial_rows; ++row) {
+        timestamps.push_back(static_cast<time::microseconds_t>(row) * step);
+        values.push_back(sample(row));
+    }
+    store.add_column(TrackpointStore::ColumnType::Double);
+    store.build(std::move(timestamps), {std::move(values)});
+    store.set_growing(true);
+
+    WindowIndex window_index(store, 0);
+    CumulativeStats stats(store, 0);
+    MinMaxPyramid pyramid(store, 0);
+
+    int errors = compare(store, window_index, stats, pyramid);
+    for (size_t count : appends) {
+        std::vector<time::microseconds_t> appended_timestamps;
+        std::vector<double> appended_values;
+        for (size_t row = store.size(); row < store.size() + count; ++row) {
+            appended_timestamps.push_back(static_cast<time::microseconds_t>(row) * step);
+            appended_values.push_back(sample(row));
+        }
+        store.append(appended_timestamps, {appended_values});
+
+        window_index.extend();
+        stats.extend();
+        pyramid.extend();
+        errors += compare(store, window_index, stats, pyramid);
+    }
+
+    std::cout << "rows: " << store.size() << " errors: " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}
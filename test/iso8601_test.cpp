@@ -0,0 +1,78 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "backend/utils/time.h"
+
+// Checks that fixed-format ISO-8601 timestamps taking the hand written fast
+// path give the same date and time as std::chrono::from_stream, with
+// fractions truncated to milliseconds and zone offsets applied.
+// usage: iso8601_test
+
+using namespace telemetry;
+using namespace std::chrono;
+
+namespace {
+    struct case_t {
+        std::string input;
+        time::time_point_t expected;
+        minutes offset; // of the input, from_stream only reads the local date and time
+    };
+
+    constexpr sys_days test_day = 2025y / December / 9;
+    constexpr auto base = test_day + 15h + 17min + 4s;
+
+    // date and time without fraction and zone as read by std::chrono::from_stream
+    time::time_point_t reference(const std::string& input) {
+        std::istringstream ss{input};
+        sys_seconds tp;
+        from_stream(ss, "%Y-%m-%dT%H:%M:%S", tp);
+        return ss.fail() ? time::INVALID_TIME_POINT : time::time_point_t(tp);
+    }
+}
+
+int main() {
+    const std::vector<case_t> cases = {
+        {"2025-12-09T15:17:04Z", base, 0min},
+        // missing 'Z' is UTC as well
+        {"2025-12-09T15:17:04", base, 0min},
+        {"2025-12-09T15:17:04.123Z", base + 123ms, 0min},
+        {"2025-12-09T15:17:04.5", base + 500ms, 0min},
+        {"2025-12-09T15:17:04.07Z", base + 70ms, 0min},
+        // fraction beyond milliseconds is truncated, not rounded
+        {"2025-12-09T15:17:04.9999Z", base + 999ms, 0min},
+        {"2025-12-09T15:17:04.123456789Z", base + 123ms, 0min},
+        {"2025-12-09T15:17:04.123456789", base + 123ms, 0min},
+        // offsets
+        {"2025-12-09T15:17:04+00:00", base, 0min},
+        {"2025-12-09T15:17:04+02:00", base - 2h, 120min},
+        {"2025-12-09T15:17:04.250-01:30", base + 250ms + 1h + 30min, -90min},
+        {"2025-12-09T15:17:04.1234+05:45", base + 123ms - 5h - 45min, 345min},
+        // offset moving to another day / year
+        {"2025-12-09T01:00:00+03:00", test_day - 2h, 180min},
+        {"2025-12-31T23:30:00-01:00", sys_days(2026y / January / 1) + 30min, -60min},
+        {"2024-02-29T23:59:59.999Z", sys_days(2024y / February / 29) + 23h + 59min + 59s + 999ms, 0min},
+    };
+
+    int errors = 0;
+    for (const auto& c : cases) {
+        time::time_point_t parsed = time::parse_iso8601(c.input);
+        if (parsed != c.expected) {
+            std::cout << "Error - " << c.input << ": parsed " << parsed.time_since_epoch().count() << ", expected "
+                      << c.expected.time_since_epoch().count() << std::endl;
+            ++errors;
+            continue;
+        }
+
+        time::time_point_t local = reference(c.input);
+        if (local == time::INVALID_TIME_POINT || floor<seconds>(parsed) + c.offset != local) {
+            std::cout << "Error - " << c.input << ": differs from std::chrono::from_stream" << std::endl;
+            ++errors;
+        }
+    }
+
+    std::cout << "cases: " << cases.size() << " errors: " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "backend/track/track.h"
+
+// Checks merging of several track sources into one timeline: merged
+// timestamps (equal ones collapsed), own and joined (interpolated) values,
+// values outside of a source's time span, joined rows skipped by
+// statistics, offset= shift and rejection of colliding field names.
+// usage: merge_sources_test A.gpx B.gpx
+// (as in test/data: merge_a.gpx - hr at 0, 2, 4, 6, 8 s, merge_b.gpx - hr at 3, 4, 5, 7 s)
+
+using namespace telemetry;
+
+namespace {
+    constexpr time::microseconds_t second = 1'000'000;
+    constexpr time::microseconds_t half_second = 500'000;
+    constexpr time::microseconds_t whole_track = 100 * second;
+
+    int errors = 0;
+
+    void error(const std::string& what) {
+        std::cout << "Error - " << what << std::endl;
+        ++errors;
+    }
+
+    std::vector<track::Track::source_t> make_sources(const std::string& a, const std::string& b,
+                                                     const std::string& prefix, time::microseconds_t offset) {
+        std::vector<track::Track::source_t> sources(2);
+        sources[0].path = a;
+        sources[1].path = b;
+        sources[1].prefix = prefix;
+        sources[1].offset = offset;
+        return sources;
+    }
+
+    void expect_timestamps(const track::Track& track, const std::vector<time::microseconds_t>& expected) {
+        auto timestamps = track.get_trackpoint_timestamps();
+        if (!std::equal(timestamps.begin(), timestamps.end(), expected.begin(), expected.end())) {
+            std::string got;
+            for (auto ts : timestamps) {
+                got += " " + std::to_string(ts);
+            }
+            error("merged timestamps:" + got);
+        }
+    }
+
+    /* NaN expects missing value */
+    void expect_value(const track::Track& track, const std::string& field, time::microseconds_t timestamp, double expected) {
+        track::Value value = track.get(field, timestamp);
+        bool ok = std::isnan(expected) ? !value.is_valid() : (value.is_double() && std::fabs(value.as_double() - expected) < 1e-9);
+        if (!ok) {
+            error(field + " at " + std::to_string(timestamp) + ": " +
+                  (value.is_double() ? std::to_string(value.as_double()) : "missing") + ", expected " + std::to_string(expected));
+        }
+    }
+
+    /* joined rows are not samples - sum over whole track only counts source's own values */
+    void expect_sample_sum(const track::Track& track, const std::string& field, double expected) {
+        const track::WindowIndex* index = track.get_window_index(track.bind(field));
+        if (!index) {
+            error("no window index of " + field);
+            return;
+        }
+        track::WindowIndex::cursors_t cursors;
+        time::microseconds_t valid_until = 0;
+        auto timestamps = track.get_trackpoint_timestamps();
+        double sum = index->get(track::WindowIndex::Aggregate::Sum, timestamps.back(), whole_track, cursors, valid_until);
+        if (sum != expected) {
+            error("sum of samples of " + field + ": " + std::to_string(sum) + ", expected " + std::to_string(expected));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cout << "usage: " << argv[0] << " A.gpx B.gpx" << std::endl;
+        return 2;
+    }
+    const std::string a = argv[1];
+    const std::string b = argv[2];
+    const double missing = std::nan("");
+
+    {
+        track::Track track;
+        if (!track.load(make_sources(a, b, "b_", 0))) {
+            error("merge without offset failed");
+        } else {
+            // 4 s is in both sources
+            expect_timestamps(track, {0, 2 * second, 3 * second, 4 * second, 5 * second, 6 * second, 7 * second, 8 * second});
+
+            // first source joined at timestamps of the second one
+            expect_value(track, "point_hr", 2 * second, 110);
+            expect_value(track, "point_hr", 3 * second, 115);
+            expect_value(track, "point_hr", 7 * second, 135);
+
+            // second source - missing outside of its span, own samples, joined inside
+            expect_value(track, "point_b_hr", 0, missing);
+            expect_value(track, "point_b_hr", 2 * second, missing);
+            expect_value(track, "point_b_hr", 3 * second, 60);
+            expect_value(track, "point_b_hr", 4 * second, 70);
+            expect_value(track, "point_b_hr", 6 * second, 85);
+            expect_value(track, "point_b_hr", 7 * second, 90);
+            expect_value(track, "point_b_hr", 8 * second, missing);
+
+            expect_sample_sum(track, "point_hr", 100 + 110 + 120 + 130 + 140);
+            expect_sample_sum(track, "point_b_hr", 60 + 70 + 80 + 90);
+        }
+    }
+
+    {
+        track::Track track;
+        if (!track.load(make_sources(a, b, "b_", half_second))) {
+            error("merge with offset failed");
+        } else {
+            // no timestamp in common any more
+            expect_timestamps(track, {0, 2 * second, 3 * second + half_second, 4 * second, 4 * second + half_second,
+                                      5 * second + half_second, 6 * second, 7 * second + half_second, 8 * second});
+            expect_value(track, "point_b_hr", 3 * second, missing);
+            expect_value(track, "point_b_hr", 4 * second, 65);
+            expect_value(track, "point_b_hr", 4 * second + half_second, 70);
+            expect_value(track, "point_hr", 3 * second + half_second, 117.5);
+            expect_sample_sum(track, "point_b_hr", 60 + 70 + 80 + 90);
+        }
+    }
+
+    {
+        // without prefix point_hr (and point_lat ...) of both sources collide
+        track::Track track;
+        if (track.load(make_sources(a, b, "", 0))) {
+            error("duplicate field names were not rejected");
+        }
+    }
+
+    std::cout << "merge sources: errors: " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "backend/track/race_index.h"
+
+// Checks standings and gaps of riders joining a race late against closed form
+// positions - riders riding at constant speed, recorded at different rates
+// with joined rows in between and one stopping before the end, so the lead
+// changes three times.
+// usage: race_index_test
+
+using namespace telemetry;
+using namespace telemetry::track;
+
+namespace {
+    constexpr time::microseconds_t step = 1'000'000;
+    constexpr size_t row_count = 901;
+    constexpr time::microseconds_t query_step = 700'000;
+    constexpr double gap_tolerance = 1e-3;  // seconds
+    constexpr double tie_tolerance = 1e-6; // meters - ranks of riders this close are not checked
+    constexpr double missing = std::numeric_limits<double>::quiet_NaN();
+
+    struct rider_t {
+        double start;       // seconds, first sample
+        double end;         // seconds, last sample
+        double speed;       // m/s
+        size_t sample_step; // rows between own samples, rows in between are joined
+    };
+
+    // rider 1 overtakes rider 0 at 600 s, rider 2 overtakes both at 850 s and stops at 880 s,
+    // rider 1 passes it again at 887.5 s
+    const std::vector<rider_t> riders = {
+        {0.0, 900.0, 10.0, 1},
+        {100.0, 900.0, 12.0, 2},
+        {250.0, 880.0, 15.0, 3},
+    };
+
+    double expected_distance(const rider_t& rider, double t) {
+        if (t < rider.start) {
+            return missing;
+        }
+        return rider.speed * (std::min(t, rider.end) - rider.start);
+    }
+
+    void build_store(TrackpointStore& store) {
+        std::vector<time::microseconds_t> timestamps(row_count);
+        for (size_t row = 0; row < row_count; ++row) {
+            timestamps[row] = static_cast<time::microseconds_t>(row) * step;
+        }
+        std::vector<std::vector<double>> values;
+        std::vector<std::vector<uint64_t>> joined;
+        for (const auto& rider : riders) {
+            values.emplace_back(row_count, missing);
+            joined.emplace_back((row_count + 63) / 64, 0);
+            size_t first = static_cast<size_t>(rider.start);
+            size_t last = static_cast<size_t>(rider.end);
+            for (size_t row = first; row <= last; ++row) {
+                if ((row - first) % rider.sample_step == 0 || row == last) {
+                    values.back()[row] = expected_distance(rider, static_cast<double>(row));
+                } else {
+                    // far off value, shows if joined rows are taken as the rider's samples
+                    values.back()[row] = 1e6;
+                    joined.back()[row / 64] |= uint64_t{1} << (row % 64);
+                }
+            }
+            store.add_column(TrackpointStore::ColumnType::Double);
+        }
+        store.build(std::move(timestamps), std::move(values), std::move(joined));
+    }
+}
+
+int main() {
+    TrackpointStore store;
+    build_store(store);
+
+    std::vector<RaceIndex::rider_columns_t> columns;
+    for (size_t i = 0; i < riders.size(); ++i) {
+        columns.push_back({i, TrackpointStore::npos, TrackpointStore::npos});
+    }
+    RaceIndex index(store, columns);
+
+    std::vector<time::microseconds_t> queries;
+    for (time::microseconds_t t = -2 * step; t <= static_cast<time::microseconds_t>(row_count + 2) * step; t += query_step) {
+        queries.push_back(t);
+    }
+
+    int checked = 0;
+    int errors = 0;
+    for (bool reversed : {false, true}) {
+        if (reversed) {
+            std::reverse(queries.begin(), queries.end());
+        }
+        for (auto timestamp : queries) {
+            index.update(timestamp);
+            // outside of the track distances stay at the first / last trackpoint
+            double t = std::clamp(time::us_to_s(timestamp), 0.0, static_cast<double>(row_count - 1));
+            bool before_track = timestamp < 0;
+
+            std::vector<double> distances;
+            for (const auto& rider : riders) {
+                distances.push_back(before_track ? missing : expected_distance(rider, t));
+            }
+            std::vector<size_t> order(riders.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                if (std::isnan(distances[a]) != std::isnan(distances[b])) {
+                    return !std::isnan(distances[a]);
+                }
+                return !std::isnan(distances[a]) && distances[a] > distances[b];
+            });
+            size_t leader = order.front();
+
+            for (size_t rank = 0; rank < order.size(); ++rank) {
+                ++checked;
+                size_t rider = order[rank];
+                double distance = index.distance(rider);
+                bool tied = (rank > 0 && std::abs(distances[order[rank - 1]] - distances[rider]) < tie_tolerance) ||
+                            (rank + 1 < order.size() && std::abs(distances[order[rank + 1]] - distances[rider]) < tie_tolerance);
+                double gap = missing;
+                if (rider == leader && !std::isnan(distances[rider])) {
+                    gap = 0.0;
+                } else if (!std::isnan(distances[rider]) && !std::isnan(distances[leader])) {
+                    // time since leader was at rider's distance
+                    double reached = riders[leader].start + distances[rider] / riders[leader].speed;
+                    gap = std::max(0.0, time::us_to_s(timestamp) - reached);
+                }
+
+                bool ok = (std::isnan(distance) ? std::isnan(distances[rider]) : std::abs(distance - distances[rider]) < tie_tolerance) &&
+                          (tied || index.rank(rider) == rank) &&
+                          (std::isnan(gap) ? std::isnan(index.gap(rider)) : std::abs(index.gap(rider) - gap) < gap_tolerance);
+                if (!ok) {
+                    std::cout << std::format("Error - rider {} at {}{}: distance {} rank {} gap {}, expected {} {} {}", rider,
+                                             timestamp, reversed ? " (reversed)" : "", distance, index.rank(rider),
+                                             index.gap(rider), distances[rider], rank, gap)
+                              << std::endl;
+                    ++errors;
+                }
+            }
+        }
+    }
+
+    std::cout << "checked: " << checked << " errors: " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "backend/track/field_id.h"
+
+// Checks that segment field ids pack and unpack losslessly over the whole
+// range of every part, keep ordering by (type, list, segment, field) and
+// never touch the flag bits.
+// usage: segment_field_id_test
+
+using namespace telemetry::track;
+
+namespace {
+    // first, last and a few values in between (bit boundaries included) of part with given mask
+    std::vector<field_id_t> samples(field_id_t mask) {
+        field_id_t max = segment_field_id::unpack(mask, mask);
+        std::vector<field_id_t> values;
+        for (field_id_t value = 1; value - 1 < max; value *= 2) {
+            values.push_back(value - 1);
+            values.push_back(value);
+        }
+        values.push_back(max);
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        return values;
+    }
+
+    std::string describe(field_id_t type, field_id_t list, field_id_t segment, field_id_t field) {
+        return std::format("type: {} list: {} segment: {} field: {}", type, list, segment, field);
+    }
+}
+
+int main() {
+    int checked = 0;
+    int errors = 0;
+
+    field_id_t last_id = INVALID_FIELD;
+    for (field_id_t type : samples(consts::mask::segment::type)) {
+        for (field_id_t list : samples(consts::mask::segment::list)) {
+            for (field_id_t segment : samples(consts::mask::segment::segment)) {
+                for (field_id_t field : samples(consts::mask::segment::field)) {
+                    ++checked;
+                    field_id_t id = static_cast<field_id_t>(segment_field_id(type, list, segment, field));
+                    segment_field_id sfid(id | consts::mask::segment_flag | consts::mask::metadata_flag);
+
+                    if (sfid.type != type || sfid.list != list || sfid.segment != segment || sfid.field != field) {
+                        std::cout << "Error - packed: " << describe(type, list, segment, field) << std::endl;
+                        std::cout << "      unpacked: " << describe(sfid.type, sfid.list, sfid.segment, sfid.field) << std::endl;
+                        ++errors;
+                    } else if (id & consts::mask::flags) {
+                        std::cout << "Error - flags overwritten: " << describe(type, list, segment, field) << std::endl;
+                        ++errors;
+                    } else if (last_id != INVALID_FIELD && last_id >= id) {
+                        std::cout << "Error - not increasing id: " << id << " after " << last_id << std::endl;
+                        ++errors;
+                    }
+                    last_id = id;
+                }
+            }
+        }
+    }
+
+    // parts out of range must not leak into neighbouring parts
+    segment_field_id overflow(0, 0, segment_field_id::unpack(consts::mask::segment::segment, consts::mask::segment::segment) + 1, 0);
+    if (static_cast<field_id_t>(overflow) != 0) {
+        std::cout << "Error - out of range segment leaks into other parts" << std::endl;
+        ++errors;
+    }
+
+    std::cout << "packed-unpacked correctly: " << checked - errors << " / " << checked << std::endl;
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+#include <bit>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "backend/track/track.h"
+
+// Checks that the streaming GPX parser, both single threaded and with
+// parallel trackpoint parsing, produces exactly the same field ids and
+// values as the DOM parser.
+// usage: track_parser_test TRACK.gpx [TRACK.gpx ...]
+
+using namespace telemetry;
+
+namespace {
+    constexpr time::microseconds_t track_offset = 5'000'000;
+    constexpr time::microseconds_t outside_margin = 10'000'000;
+    constexpr size_t parallel_workers = 4;
+
+    std::string describe(const track::Value& value) {
+        if (!value.is_valid()) {
+            return "invalid";
+        }
+        if (value.is_double()) {
+            return std::format("double {:016x}", std::bit_cast<uint64_t>(value.as_double()));
+        }
+        if (value.is_bool()) {
+            return std::format("bool {}", value.as_bool());
+        }
+        if (value.is_time_point()) {
+            return std::format("time {}", value.as_time_point().time_since_epoch().count());
+        }
+        return "string " + value.as_string();
+    }
+
+    bool compare(const std::string& path, size_t worker_count) {
+        track::Track dom(track_offset);
+        track::Track stream(track_offset);
+
+        bool dom_ok = dom.load_gpx(path, track::Track::Parser::Dom);
+        bool stream_ok = stream.load_gpx(path, track::Track::Parser::Stream, worker_count);
+        if (dom_ok != stream_ok) {
+            std::cout << "Error - " << path << ": load result differs, dom: " << dom_ok
+                      << ", stream: " << stream_ok << std::endl;
+            return false;
+        }
+
+        auto names = dom.get_field_names();
+        if (names != stream.get_field_names()) {
+            std::cout << "Error - " << path << ": field names differ" << std::endl;
+            return false;
+        }
+
+        auto dom_ts = dom.get_trackpoint_timestamps();
+        auto stream_ts = stream.get_trackpoint_timestamps();
+        if (!std::equal(dom_ts.begin(), dom_ts.end(), stream_ts.begin(), stream_ts.end())) {
+            std::cout << "Error - " << path << ": trackpoint timestamps differ" << std::endl;
+            return false;
+        }
+
+        // trackpoints, midpoints between them and times outside of track
+        std::vector<time::microseconds_t> timestamps;
+        for (size_t i = 0; i < dom_ts.size(); ++i) {
+            timestamps.push_back(dom_ts[i]);
+            if (i + 1 < dom_ts.size()) {
+                timestamps.push_back(dom_ts[i] + (dom_ts[i + 1] - dom_ts[i]) / 2);
+            }
+        }
+        if (!dom_ts.empty()) {
+            timestamps.push_back(dom_ts.front() - outside_margin);
+            timestamps.push_back(dom_ts.back() + outside_margin);
+        }
+
+        int errors = 0;
+        for (const auto& name : names) {
+            track::field_id_t id = dom.get_field_id(name);
+            if (id != stream.get_field_id(name)) {
+                std::cout << "Error - " << path << ": field id differs for " << name << std::endl;
+                ++errors;
+                continue;
+            }
+
+            for (auto ts : timestamps) {
+                std::string expected = describe(dom.get(id, ts));
+                std::string actual = describe(stream.get(id, ts));
+                if (expected != actual && ++errors <= 20) {
+                    std::cout << "Error - " << path << ": " << name << " at " << ts
+                              << " dom: " << expected << ", stream: " << actual << std::endl;
+                }
+            }
+        }
+
+        std::cout << path << " (" << worker_count << " workers): " << names.size() << " fields, " << dom_ts.size() << " trackpoints, "
+                  << timestamps.size() << " timestamps, errors: " << errors << std::endl;
+        return errors == 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cout << "usage: " << argv[0] << " TRACK.gpx [TRACK.gpx ...]" << std::endl;
+        return 2;
+    }
+
+    int failed = 0;
+    for (int i = 1; i < argc; ++i) {
+        for (size_t workers : {size_t{1}, parallel_workers}) {
+            if (!compare(argv[i], workers)) {
+                ++failed;
+            }
+        }
+    }
+    return failed == 0 ? 0 : 1;
+}
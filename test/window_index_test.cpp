@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "backend/track/window_index.h"
+
+// Checks windowed aggregates against a brute force scan of the column on a
+// track with gaps, missing samples and joined rows - for sequential (cursor
+// moving forward) and reversed query order.
+// usage: window_index_test
+
+using namespace telemetry;
+using namespace telemetry::track;
+
+namespace {
+    constexpr size_t row_count = 300;
+    constexpr time::microseconds_t step = 1'000'000;
+    constexpr time::microseconds_t gap = 10'000'000;  // after every gap_every rows
+    constexpr size_t gap_every = 37;
+    constexpr size_t missing_every = 7;
+    constexpr size_t joined_every = 5;
+    constexpr time::microseconds_t query_step = 250'000;
+    constexpr double tolerance = 1e-9;
+
+    constexpr WindowIndex::Aggregate aggregates[] = {
+        WindowIndex::Aggregate::Avg,
+        WindowIndex::Aggregate::Min,
+        WindowIndex::Aggregate::Max,
+        WindowIndex::Aggregate::Sum,
+    };
+    constexpr time::microseconds_t windows[] = {1'000'000, 3'500'000, 30'000'000, 1'000'000'000};
+
+    void build_store(TrackpointStore& store) {
+        std::vector<time::microseconds_t> timestamps;
+        std::vector<double> values;
+        std::vector<uint64_t> joined((row_count + 63) / 64, 0);
+        time::microseconds_t timestamp = 0;
+        for (size_t i = 0; i < row_count; ++i) {
+            timestamps.push_back(timestamp);
+            timestamp += (i % gap_every == gap_every - 1) ? gap : step;
+            values.push_back((i % missing_every == 3) ? std::numeric_limits<double>::quiet_NaN()
+                                                      : 100.0 * std::sin(0.37 * static_cast<double>(i)));
+            // joined rows are valid, but not samples of the column
+            if (i % joined_every == 1 && !std::isnan(values.back())) {
+                joined[i / 64] |= uint64_t{1} << (i % 64);
+            }
+        }
+        store.add_column(TrackpointStore::ColumnType::Double);
+        store.build(std::move(timestamps), {std::move(values)}, {std::move(joined)});
+    }
+
+    struct expected_t {
+        double value;
+        time::microseconds_t valid_until;
+    };
+
+    expected_t brute_force(const TrackpointStore& store, WindowIndex::Aggregate aggregate,
+                           time::microseconds_t timestamp, time::microseconds_t window) {
+        auto timestamps = store.timestamps();
+        expected_t expected{std::numeric_limits<double>::quiet_NaN(), VALID_FOREVER};
+        double sum = 0.0;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        size_t count = 0;
+        bool first_in_window = true;
+        for (size_t i = 0; i < timestamps.size(); ++i) {
+            if (timestamps[i] > timestamp) {
+                expected.valid_until = std::min(expected.valid_until, timestamps[i]);
+                break;
+            }
+            if (timestamps[i] <= timestamp - window) {
+                continue;
+            }
+            if (first_in_window) {
+                expected.valid_until = timestamps[i] + window;
+                first_in_window = false;
+            }
+            if (!store.is_sample(0, i)) {
+                continue;
+            }
+            double value = store.value(0, i);
+            sum += value;
+            min = std::min(min, value);
+            max = std::max(max, value);
+            ++count;
+        }
+        if (count > 0) {
+            switch (aggregate) {
+                case WindowIndex::Aggregate::Avg: expected.value = sum / static_cast<double>(count); break;
+                case WindowIndex::Aggregate::Min: expected.value = min; break;
+                case WindowIndex::Aggregate::Max: expected.value = max; break;
+                case WindowIndex::Aggregate::Sum: expected.value = sum; break;
+            }
+        }
+        return expected;
+    }
+
+    bool same(double a, double b) {
+        if (std::isnan(a) || std::isnan(b)) {
+            return std::isnan(a) && std::isnan(b);
+        }
+        return std::abs(a - b) <= tolerance * std::max(1.0, std::abs(b));
+    }
+}
+
+int main() {
+    TrackpointStore store;
+    build_store(store);
+    WindowIndex index(store, 0);
+
+    auto timestamps = store.timestamps();
+    std::vector<time::microseconds_t> queries;
+    for (time::microseconds_t t = timestamps.front() - 5'000'000; t <= timestamps.back() + 5'000'000; t += query_step) {
+        queries.push_back(t);
+    }
+    // every sample timestamp exactly - window ends fall on samples
+    queries.insert(queries.end(), timestamps.begin(), timestamps.end());
+    std::sort(queries.begin(), queries.end());
+
+    int checked = 0;
+    int errors = 0;
+    for (bool reversed : {false, true}) {
+        if (reversed) {
+            std::reverse(queries.begin(), queries.end());
+        }
+        for (auto aggregate : aggregates) {
+            for (auto window : windows) {
+                WindowIndex::cursors_t cursors;
+                for (auto timestamp : queries) {
+                    ++checked;
+                    time::microseconds_t valid_until;
+                    double value = index.get(aggregate, timestamp, window, cursors, valid_until);
+                    expected_t expected = brute_force(store, aggregate, timestamp, window);
+                    if (!same(value, expected.value) || valid_until != expected.valid_until) {
+                        std::cout << std::format("Error - aggregate {} window {} at {}{}: {} valid until {}, expected {} valid until {}",
+                                                 static_cast<int>(aggregate), window, timestamp, reversed ? " (reversed)" : "",
+                                                 value, valid_until, expected.value, expected.valid_until)
+                                  << std::endl;
+                        ++errors;
+                    }
+                }
+            }
+        }
+    }
+
+    std::cout << "checked: " << checked << " errors: " << errors << std::endl;
+    return errors == 0 ? 0 : 1;
+}